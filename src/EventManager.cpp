@@ -18,24 +18,45 @@
 #include "defines.h" // IWYU pragma: keep
 #include "EventManager.h"
 #include "GameEvent.h"
+#include "Instrumentation.h"
 #include "SerializedGameData.h"
 #include "helpers/containerUtils.h"
 #include "helpers/mapTraits.h"
 #include "libutil/src/Log.h"
-#include <vector>
+#include <algorithm>
 
-EventManager::EventManager(unsigned startGF) : currentGF(startGF), curActiveEvent(NULL)
+namespace {
+/// Number of GFs covered by the buckets. Larger than the length of almost all events
+const unsigned NUM_EVENT_BUCKETS = 4096;
+
+struct IsEventOf
+{
+    const GameObject* const obj;
+    const unsigned id;
+    const bool anyId;
+    IsEventOf(const GameObject* obj, unsigned id, bool anyId) : obj(obj), id(id), anyId(anyId) {}
+    bool operator()(const GameEvent& ev) const { return ev.obj == obj && (anyId || ev.id == id); }
+};
+} // namespace
+
+EventManager::EventManager(unsigned startGF) : currentGF(startGF), buckets(NUM_EVENT_BUCKETS), curActiveEvent(NULL)
 {
 }
 
 EventManager::~EventManager()
 {
-    for(EventMap::iterator it = events.begin(); it != events.end(); ++it)
+    for(std::vector<EventList>::iterator it = buckets.begin(); it != buckets.end(); ++it)
+    {
+        for(EventList::iterator e_it = it->begin(); e_it != it->end(); ++e_it)
+            delete *e_it;
+    }
+    buckets.clear();
+    for(EventMap::iterator it = farEvents.begin(); it != farEvents.end(); ++it)
     {
         for(EventList::iterator e_it = it->second.begin(); e_it != it->second.end(); ++e_it)
             delete *e_it;
     }
-    events.clear();
+    farEvents.clear();
 
     for(GameObjList::iterator it = killList.begin(); it != killList.end(); ++it)
     {
@@ -52,7 +73,11 @@ GameEvent* EventManager::AddEvent(GameEvent* event)
     RTTR_Assert(event->GetTargetGF() > currentGF);
     // Make sure the linked object is not an event itself
     RTTR_Assert(!dynamic_cast<GameEvent*>(event->obj));
-    events[event->GetTargetGF()].push_back(event);
+    const unsigned targetGF = event->GetTargetGF();
+    if(IsInBuckets(targetGF))
+        GetBucket(targetGF).push_back(event);
+    else
+        farEvents[targetGF].push_back(event);
     return event;
 }
 
@@ -79,32 +104,43 @@ GameEvent* EventManager::AddEvent(GameObject* obj, const unsigned gf_length, con
 
 void EventManager::ExecuteNextGF()
 {
+    Instrumentation::ScopedTimer timer(INSTR_EVENTS);
     currentGF++;
 
-    RTTR_Assert(events.empty() || events.begin()->first >= currentGF);
+    // The last GF of the buckets is now in range (its bucket was used by the previous GF and is empty)
+    // Events for it that were added earlier were put into the far events, so move them over keeping their order
+    const unsigned lastBucketGF = currentGF + NUM_EVENT_BUCKETS - 1;
+    RTTR_Assert(farEvents.empty() || farEvents.begin()->first >= lastBucketGF);
+    EventMap::iterator itFarEvents = farEvents.find(lastBucketGF);
+    if(itFarEvents != farEvents.end())
+    {
+        RTTR_Assert(GetBucket(lastBucketGF).empty());
+        GetBucket(lastBucketGF).swap(itFarEvents->second);
+        farEvents.erase(itFarEvents);
+    }
 
-    // Get list of events for current GF
-    EventMap::iterator itCurEvents = events.find(currentGF);
-    if(itCurEvents != events.end())
+    EventList& curEvents = GetBucket(currentGF);
+    // We have to allow 2 cases:
+    // 1) Adding of events to current GF -> Iterate by index as the vector may grow
+    // 2) Removing events of the current GF -> They are set to NULL and skipped
+    for(unsigned i = 0; i < curEvents.size(); i++)
     {
-        EventList& curEvents = itCurEvents->second;
-        // We have to allow 2 cases:
-        // 1) Adding of events to current GF -> std::list allows this without invalidating any iterators
-        // 2) Checking for events -> Remove all deleted events so only valid ones are in the list
-        for(EventList::iterator e_it = curEvents.begin(); e_it != curEvents.end(); e_it = curEvents.erase(e_it))
-        {
-            GameEvent* ev = (*e_it);
-            RTTR_Assert(ev->obj);
-            RTTR_Assert(ev->obj->GetObjId() < GameObject::GetObjIDCounter());
+        GameEvent* ev = curEvents[i];
+        if(!ev)
+            continue;
+        RTTR_Assert(ev->obj);
+        RTTR_Assert(ev->obj->GetObjId() < GameObject::GetObjIDCounter());
 
-            curActiveEvent = ev;
-            ev->obj->HandleEvent(ev->id);
+        curActiveEvent = ev;
+        ev->obj->HandleEvent(ev->id);
+        timer.AddCount();
 
-            delete ev;
-        }
-        curActiveEvent = NULL;
-        events.erase(itCurEvents);
+        curEvents[i] = NULL;
+        delete ev;
     }
+    curActiveEvent = NULL;
+    // Keep the capacity, the bucket gets reused
+    curEvents.clear();
 
     // Remove all objects
     for(GameObjList::iterator it = killList.begin(); it != killList.end(); ++it)
@@ -125,8 +161,18 @@ void EventManager::Serialize(SerializedGameData& sgd) const
     RTTR_Assert(killList.empty());
 
     // Gather all events, that are not yet serialized
+    // in the order of their GF
     std::vector<const GameEvent*> save_events;
-    for(EventMap::const_iterator it = events.begin(); it != events.end(); ++it)
+    for(unsigned gf = currentGF + 1; IsInBuckets(gf); gf++)
+    {
+        const EventList& curEvents = buckets[gf % buckets.size()];
+        for(EventList::const_iterator e_it = curEvents.begin(); e_it != curEvents.end(); ++e_it)
+        {
+            if(*e_it && !sgd.IsObjectSerialized((*e_it)->GetObjId()))
+                save_events.push_back(*e_it);
+        }
+    }
+    for(EventMap::const_iterator it = farEvents.begin(); it != farEvents.end(); ++it)
     {
         for(EventList::const_iterator e_it = it->second.begin(); e_it != it->second.end(); ++e_it)
         {
@@ -146,34 +192,36 @@ void EventManager::Deserialize(SerializedGameData& sgd)
         sgd.PopEvent();
 }
 
-bool EventManager::IsEventActive(const GameObject* const obj, const unsigned id) const
+template<class T_Pred>
+const GameEvent* EventManager::FindEvent(const T_Pred& pred) const
 {
-    for(EventMap::const_iterator it = events.begin(); it != events.end(); ++it)
+    for(std::vector<EventList>::const_iterator it = buckets.begin(); it != buckets.end(); ++it)
+    {
+        for(EventList::const_iterator e_it = it->begin(); e_it != it->end(); ++e_it)
+        {
+            if(*e_it && pred(**e_it))
+                return *e_it;
+        }
+    }
+    for(EventMap::const_iterator it = farEvents.begin(); it != farEvents.end(); ++it)
     {
         for(EventList::const_iterator e_it = it->second.begin(); e_it != it->second.end(); ++e_it)
         {
-            if((*e_it)->id == id && (*e_it)->obj == obj)
-            {
-                return true;
-            }
+            if(pred(**e_it))
+                return *e_it;
         }
     }
+    return NULL;
+}
 
-    return false;
+bool EventManager::IsEventActive(const GameObject* const obj, const unsigned id) const
+{
+    return FindEvent(IsEventOf(obj, id, false)) != NULL;
 }
 
 bool EventManager::ObjectHasEvents(GameObject* obj)
 {
-    for(EventMap::iterator it = events.begin(); it != events.end(); ++it)
-    {
-        EventList& curEvents = it->second;
-        for(std::list<GameEvent*>::iterator e_it = curEvents.begin(); e_it != curEvents.end(); ++e_it)
-        {
-            if((*e_it)->obj == obj)
-                return true;
-        }
-    }
-    return false;
+    return FindEvent(IsEventOf(obj, 0, true)) != NULL;
 }
 
 bool EventManager::ObjectIsInKillList(GameObject* obj)
@@ -194,10 +242,25 @@ void EventManager::RemoveEvent(GameEvent*& ep)
         return;
     }
 
-    EventMap::iterator itEventsAtTime = events.find(ep->GetTargetGF());
-    if(itEventsAtTime != events.end())
+    const unsigned targetGF = ep->GetTargetGF();
+    EventMap::iterator itFarEvents;
+    if(IsInBuckets(targetGF))
     {
-        EventList& eventsAtTime = itEventsAtTime->second;
+        // Only clear the entry as we might be iterating over this list (event of the current GF)
+        EventList& eventsAtTime = GetBucket(targetGF);
+        EventList::iterator e_it = std::find(eventsAtTime.begin(), eventsAtTime.end(), ep);
+        if(e_it != eventsAtTime.end())
+        {
+            *e_it = NULL;
+            RTTR_Assert(!helpers::contains(eventsAtTime, ep)); // Event existed multiple times?
+        } else
+        {
+            RTTR_Assert(false);
+            LOG.write("Bug detected: Event to be removed did not exist");
+        }
+    } else if((itFarEvents = farEvents.find(targetGF)) != farEvents.end())
+    {
+        EventList& eventsAtTime = itFarEvents->second;
         EventList::iterator e_it = std::find(eventsAtTime.begin(), eventsAtTime.end(), ep);
         if(e_it != eventsAtTime.end())
         {
@@ -208,11 +271,8 @@ void EventManager::RemoveEvent(GameEvent*& ep)
             RTTR_Assert(false);
             LOG.write("Bug detected: Event to be removed did not exist");
         }
-
-        // Note: Removing this is possible, as it cannot be the currently processed list
-        //       because there is always the curActiveEvent left, which cannot be removed (check above)
         if(eventsAtTime.empty())
-            events.erase(itEventsAtTime);
+            farEvents.erase(itFarEvents);
     } else
     {
         RTTR_Assert(false);
@@ -21,6 +21,7 @@
 
 #include <list>
 #include <map>
+#include <vector>
 
 class SerializedGameData;
 class GameEvent;
@@ -60,17 +61,29 @@ public:
     bool ObjectIsInKillList(GameObject* obj);
 
 private:
-    // Use list to allow removing of events while iterating (Event A can cause Event B in the same GF to be removed)
-    typedef std::list<GameEvent*> EventList;
+    /// Events of one GF in the order they were added.
+    /// Removed events are set to NULL, so events can be added and removed while iterating over it by index
+    /// (Event A can cause Event B in the same GF to be removed)
+    typedef std::vector<GameEvent*> EventList;
     typedef std::map<unsigned, EventList> EventMap;
     // Use list to allow adding events while iterating (Destroying 1 object may lead to destruction of another)
     typedef std::list<GameObject*> GameObjList;
     unsigned currentGF;
-    EventMap events;      /// Mapping of GF to Events to be executed in this GF
+    /// Ring of event lists for the next GFs (calendar queue): Events for GF x are in buckets[x % buckets.size()]
+    /// if x - currentGF < buckets.size(). Most events (walking, working, growing trees...) are in this range
+    /// so adding and executing them is O(1)
+    std::vector<EventList> buckets;
+    EventMap farEvents;   /// Mapping of GF to Events for all GFs after the range of the buckets
     GameObjList killList; /// Objects that will be killed after current GF
     GameEvent* curActiveEvent;
 
     GameEvent* AddEvent(GameEvent* event);
+    /// Return true if events for the given GF are stored in the buckets (instead of the far events)
+    bool IsInBuckets(unsigned gf) const { return gf - currentGF < buckets.size(); }
+    EventList& GetBucket(unsigned gf) { return buckets[gf % buckets.size()]; }
+    /// Return the first event matching the predicate or NULL
+    template<class T_Pred>
+    const GameEvent* FindEvent(const T_Pred& pred) const;
 };
 
 #endif // !EVENTMANAGER_H_INCLUDED
@@ -0,0 +1,52 @@
+// Copyright (c) 2016 Settlers Freaks (sf-team at siedler25.org)
+//
+// This file is part of Return To The Roots.
+//
+// Return To The Roots is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 2 of the License, or
+// (at your option) any later version.
+//
+// Return To The Roots is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Return To The Roots. If not, see <http://www.gnu.org/licenses/>.
+
+#include "defines.h" // IWYU pragma: keep
+#include "FrameStats.h"
+#include <algorithm>
+
+FrameStats::FrameStats(unsigned numFrames) : maxFrames(numFrames), nextFrame(0)
+{
+    RTTR_Assert(numFrames > 0);
+    frameTimes.reserve(maxFrames);
+}
+
+void FrameStats::Clear()
+{
+    frameTimes.clear();
+    nextFrame = 0;
+}
+
+void FrameStats::AddFrame(unsigned frameTime)
+{
+    if(frameTimes.size() < maxFrames)
+        frameTimes.push_back(frameTime);
+    else
+        frameTimes[nextFrame] = frameTime;
+    nextFrame = (nextFrame + 1) % maxFrames;
+}
+
+unsigned FrameStats::GetPercentile(unsigned percent) const
+{
+    RTTR_Assert(percent <= 100);
+    if(frameTimes.empty())
+        return 0;
+    std::vector<unsigned> sortedTimes(frameTimes);
+    const unsigned idx = (static_cast<unsigned>(sortedTimes.size()) - 1) * percent / 100;
+    std::nth_element(sortedTimes.begin(), sortedTimes.begin() + idx, sortedTimes.end());
+    return sortedTimes[idx];
+}
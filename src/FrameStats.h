@@ -0,0 +1,45 @@
+// Copyright (c) 2016 Settlers Freaks (sf-team at siedler25.org)
+//
+// This file is part of Return To The Roots.
+//
+// Return To The Roots is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 2 of the License, or
+// (at your option) any later version.
+//
+// Return To The Roots is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Return To The Roots. If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef FrameStats_h__
+#define FrameStats_h__
+
+#include <vector>
+
+/// Collects the durations of the last frames to report e.g. the median and the worst frame times
+class FrameStats
+{
+public:
+    /// Keep the durations of the last numFrames frames
+    explicit FrameStats(unsigned numFrames = 256);
+
+    void Clear();
+    /// Add the duration of a frame (in ms)
+    void AddFrame(unsigned frameTime);
+    /// Return the duration (in ms) that percent% of the last frames did not exceed (50 = median)
+    unsigned GetPercentile(unsigned percent) const;
+    unsigned GetNumFrames() const { return static_cast<unsigned>(frameTimes.size()); }
+
+private:
+    unsigned maxFrames;
+    /// Ring buffer of the frame durations
+    std::vector<unsigned> frameTimes;
+    /// Position of the next frame in the ring buffer
+    unsigned nextFrame;
+};
+
+#endif // FrameStats_h__
@@ -30,6 +30,7 @@
 #include "GameServer.h"
 #include "GlobalGameSettings.h"
 #include "GlobalVars.h"
+#include "Instrumentation.h"
 #include "JoinPlayerInfo.h"
 #include "Loader.h"
 #include "Random.h"
@@ -61,6 +62,9 @@
 #include <fstream>
 #include <iostream>
 
+/// Max. number of GFs the client catches up after it was late
+static const unsigned MAX_GF_CATCHUP = 4;
+
 void GameClient::ClientConfig::Clear()
 {
     server.clear();
@@ -357,13 +361,18 @@ void GameClient::RealStart()
     GAMEMANAGER.ResetAverageFPS();
 
     if(gw->HasLua())
+    {
+        gw->GetLua().GetProfiler().SetEnabled(SETTINGS.global.debugMode);
         gw->GetLua().EventStart(!mapinfo.savegame);
+    }
 }
 
 void GameClient::ExitGame()
 {
     RTTR_Assert(state == CS_GAME || state == CS_LOADING);
     GameObject::SetPointers(NULL);
+    if(gw && gw->HasLua() && gw->GetLua().GetProfiler().IsEnabled())
+        LOG.write("%1%") % gw->GetLua().GetProfiler().GetReport();
     // Spielwelt zerstören
     human_ai.reset();
     gw.reset();
@@ -377,6 +386,16 @@ unsigned GameClient::GetGFNumber() const
     return em->GetCurrentGF();
 }
 
+unsigned GameClient::GetGFLag() const
+{
+    if(state != CS_GAME || framesinfo.isPaused)
+        return 0;
+    const unsigned curGF = GetGFNumber();
+    if(skiptogf > curGF)
+        return skiptogf - curGF;
+    return (VIDEODRIVER.GetTickCount() - framesinfo.lastTime) / framesinfo.gf_length;
+}
+
 /**
  *  Ping-Nachricht.
  */
@@ -1306,8 +1325,12 @@ void GameClient::ExecuteGameFrame(const bool skipping)
         }
 
         RTTR_Assert(replay_mode || curGF <= framesinfo.gfNrServer + framesinfo.nwf_length);
-        // Store this timestamp
-        framesinfo.lastTime = currentTime;
+        // Store this timestamp. If we are only a bit late (e.g. after a slow frame) advance by the GF length instead,
+        // so the next GFs are executed earlier and we catch up
+        if(!skipping && skiptogf <= curGF && currentTime - framesinfo.lastTime < MAX_GF_CATCHUP * framesinfo.gf_length)
+            framesinfo.lastTime += framesinfo.gf_length;
+        else
+            framesinfo.lastTime = currentTime;
         // Reset frameTime
         framesinfo.frameTime = 0;
 
@@ -1358,7 +1381,13 @@ void GameClient::NextGF()
     if(GetGFNumber() % 750 == 0)
         StatisticStep();
     //  EventManager Bescheid sagen
+    // Border stones of all territory changes in this GF are recalculated together afterwards
+    // and military buildings check their frontier distance and regulate their troops once at the end
+    gw->BeginTerritoryBatch();
+    gw->BeginMilitaryBatch();
     em->ExecuteNextGF();
+    gw->EndMilitaryBatch();
+    gw->EndTerritoryBatch();
     // Notfallprogramm durchlaufen lassen
     for(unsigned i = 0; i < gw->GetPlayerCount(); ++i)
     {
@@ -1382,7 +1411,12 @@ void GameClient::NextGF()
     }
 
     if(gw->HasLua())
+    {
+        gw->GetLua().SendEventBatches();
         gw->GetLua().EventGameFrame(GetGFNumber());
+    }
+
+    INSTRUMENTATION.EndGF(GetGFNumber());
 }
 
 void GameClient::ExecuteAllGCs(const GameMessage_GameCommand& gcs)
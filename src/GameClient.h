@@ -113,6 +113,8 @@ public:
     unsigned GetGFLength() const { return framesinfo.gf_length; }
     unsigned GetNWFLength() const { return framesinfo.nwf_length; }
     unsigned GetFrameTime() const { return framesinfo.frameTime; }
+    /// Return how many GFs the game is behind its schedule (GFs left to skip when jumping to a GF)
+    unsigned GetGFLag() const;
     unsigned GetGlobalAnimation(const unsigned short max, const unsigned char factor_numerator, const unsigned char factor_denumerator,
                                 const unsigned offset);
     unsigned Interpolate(unsigned max_val, GameEvent* ev);
@@ -19,6 +19,7 @@
 #include "GameManager.h"
 
 #include "GlobalVars.h"
+#include "Instrumentation.h"
 #include "Settings.h"
 
 #include "SoundManager.h"
@@ -48,7 +49,7 @@
 
 GameManager::GameManager()
     : frames(0), frame_count(0), framerate(0), frame_time(0), run_time(0), last_time(0), skipgf_last_time(0), skipgf_last_report_gf(0),
-      cursor_(CURSOR_HAND), cursor_next(CURSOR_HAND)
+      last_draw_time(0), showFrameStats(false), cursor_(CURSOR_HAND), cursor_next(CURSOR_HAND)
 {
 }
 
@@ -136,6 +137,45 @@ void GameManager::Stop()
     VIDEODRIVER.DestroyScreen();
 }
 
+namespace {
+/// Interval (ms) in which frames are drawn while skipping GFs
+const unsigned SKIP_DRAW_INTERVAL = 250;
+
+bool IsSkippingGFs()
+{
+    return GAMECLIENT.skiptogf && GAMECLIENT.skiptogf > GAMECLIENT.GetGFNumber();
+}
+} // namespace
+
+void GameManager::RunGameFrames()
+{
+    // Max. time (ms) to run GFs before the events are handled (and a frame is drawn)
+    static const unsigned MAX_CATCHUP_TIME = 15;
+    static const unsigned MAX_SKIP_TIME = 100;
+
+    const unsigned startTime = VIDEODRIVER.GetTickCount();
+    const bool wasSkipping = IsSkippingGFs();
+    while(true)
+    {
+        const bool wasInGame = GAMECLIENT.GetState() == GameClient::CS_GAME;
+        const unsigned lastGF = wasInGame ? GAMECLIENT.GetGFNumber() : 0;
+
+        GAMECLIENT.Run();
+        GAMESERVER.Run();
+
+        // Stop when the game state changed or the jump is complete
+        if(!wasInGame || GAMECLIENT.GetState() != GameClient::CS_GAME || IsSkippingGFs() != wasSkipping)
+            break;
+        const unsigned elapsed = VIDEODRIVER.GetTickCount() - startTime;
+        if(wasSkipping)
+        {
+            if(elapsed >= MAX_SKIP_TIME)
+                break;
+        } else if(GAMECLIENT.GetGFNumber() == lastGF || GAMECLIENT.GetGFLag() == 0 || elapsed >= MAX_CATCHUP_TIME)
+            break;
+    }
+}
+
 /**
  *  Hauptschleife.
  */
@@ -147,15 +187,26 @@ bool GameManager::Run()
 
     LOBBYCLIENT.Run();
 
-    GAMECLIENT.Run();
-    GAMESERVER.Run();
+    RunGameFrames();
 
     unsigned current_time = VIDEODRIVER.GetTickCount();
 
-    const bool skipping = GAMECLIENT.skiptogf && GAMECLIENT.skiptogf > GAMECLIENT.GetGFNumber();
+    const bool skipping = IsSkippingGFs();
+    // In the menus the last frame can stay on screen while nothing changes
+    const bool isIdle = !skipping && SETTINGS.video.idle_redraw && GAMECLIENT.GetState() != GameClient::CS_GAME
+                        && !WINDOWMANAGER.NeedsRedraw(current_time);
+    // While skipping GFs only draw a frame from time to time to show the progress
+    const bool drawFrame = !isIdle && (!skipping || current_time - last_draw_time >= SKIP_DRAW_INTERVAL);
 
-    // only draw if we dont skip ahead right now
-    if(!skipping)
+    if(isIdle)
+    {
+        // Only poll the events every few ms
+        struct timespec req;
+        req.tv_sec = 0;
+        req.tv_nsec = 10 * 1000 * 1000;
+        while(nanosleep(&req, &req) == -1)
+            continue;
+    } else if(!skipping) // only draw if we dont skip ahead right now
     {
         const unsigned long vsync_wanted =
           ((GAMECLIENT.GetState() != GameClient::CS_GAME) || GAMECLIENT.IsPaused()) ? 60 : SETTINGS.video.vsync;
@@ -195,10 +246,15 @@ bool GameManager::Run()
         WINDOWMANAGER.Draw();
 
         DrawCursor();
-    } else if(GAMECLIENT.GetGFNumber() % 5000 == 0)
+    } else if(drawFrame)
+    {
+        WINDOWMANAGER.Draw();
+        DrawCursor();
+    }
+    if(skipping)
     {
-        // if we skip drawing write a comment every 5k gf
-        if(GAMECLIENT.GetGFNumber() > skipgf_last_report_gf)
+        // write a comment every 5k gf (multiple GFs are run per frame)
+        if(GAMECLIENT.GetGFNumber() / 5000 > skipgf_last_report_gf / 5000)
         {
             if(skipgf_last_time)
                 LOG.write("jumping to gf %i, now at gf %i, time for last 5k gf: %.3f s, avg gf time %.3f ms \n") % GAMECLIENT.skiptogf
@@ -244,18 +300,26 @@ bool GameManager::Run()
     }
 
     // und zeichnen
-    // only draw if we dont skip ahead right now
-    if(!skipping)
+    if(drawFrame)
     {
+        // Only count consecutive frames (not the time while idle or skipping)
+        if(last_draw_time && !skipping)
+            frameStats.AddFrame(current_time - last_draw_time);
+        last_draw_time = current_time;
+        INSTRUMENTATION.EndFrame();
+
         char frame_str[64];
         sprintf(frame_str, "%u fps", framerate);
 
         SmallFont->Draw(DrawPoint(VIDEODRIVER.GetScreenWidth(), 0), frame_str, glArchivItem_Font::DF_RIGHT, COLOR_YELLOW);
+        if(showFrameStats)
+            DrawFrameStats();
 
         // Zeichenpuffer wechseln
         VIDEODRIVER.SwapBuffers();
-    }
-    ++frames;
+        ++frames;
+    } else if(!skipping)
+        last_draw_time = 0;
 
     // Fenstermanager aufräumen
     if(!GLOBALVARS.notdone)
@@ -321,6 +385,21 @@ void GameManager::SetCursor(CursorType cursor, bool once)
     return;
 }
 
+void GameManager::DrawFrameStats()
+{
+    char text[128];
+    DrawPoint pos(VIDEODRIVER.GetScreenWidth(), SmallFont->getHeight());
+    snprintf(text, sizeof(text), "frame time: %u / %u / %u ms (50 / 95 / 99%%)", frameStats.GetPercentile(50), frameStats.GetPercentile(95),
+             frameStats.GetPercentile(99));
+    SmallFont->Draw(pos, text, glArchivItem_Font::DF_RIGHT, COLOR_YELLOW);
+    if(GAMECLIENT.GetState() == GameClient::CS_GAME)
+    {
+        pos.y += SmallFont->getHeight();
+        snprintf(text, sizeof(text), "GF lag: %u GFs (GF length: %u ms)", GAMECLIENT.GetGFLag(), GAMECLIENT.GetGFLength());
+        SmallFont->Draw(pos, text, glArchivItem_Font::DF_RIGHT, COLOR_YELLOW);
+    }
+}
+
 /**
  *  Draw the cursor
  */
@@ -19,6 +19,7 @@
 
 #pragma once
 
+#include "FrameStats.h"
 #include "libutil/src/Singleton.h"
 
 // Die verschiedenen Cursor mit ihren Indizes in resource.idx
@@ -67,10 +68,17 @@ public:
 
     inline unsigned GetFPS() { return framerate; }
 
+    /// Show/Hide the frame times and the GF lag
+    void ToggleFrameStats() { showFrameStats = !showFrameStats; }
+    const FrameStats& GetFrameStats() const { return frameStats; }
+
     void SetCursor(CursorType cursor = CURSOR_HAND, bool once = false);
 
 private:
     void DrawCursor();
+    /// Run the network and the game frames. If the game is behind (or jumping to a GF) this continues for a while
+    void RunGameFrames();
+    void DrawFrameStats();
 
 private:
     unsigned frames;
@@ -81,6 +89,10 @@ private:
     unsigned last_time;
     unsigned skipgf_last_time;
     unsigned skipgf_last_report_gf;
+    /// Time of the last drawn frame
+    unsigned last_draw_time;
+    FrameStats frameStats;
+    bool showFrameStats;
     CursorType cursor_;
     CursorType cursor_next;
 };
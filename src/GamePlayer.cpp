@@ -296,6 +296,8 @@ void GamePlayer::Serialize(SerializedGameData& sgd)
     for(unsigned i = 0; i < STAT_MERCHANDISE_TYPE_COUNT; ++i)
         sgd.PushUnsignedShort(statisticCurrentMerchandiseData[i]);
 
+    statisticHistory.Serialize(sgd);
+
     // Serialize Pacts:
     for(unsigned i = 0; i < MAX_PLAYERS; ++i)
     {
@@ -416,6 +418,8 @@ void GamePlayer::Deserialize(SerializedGameData& sgd)
     for(unsigned i = 0; i < STAT_MERCHANDISE_TYPE_COUNT; ++i)
         statisticCurrentMerchandiseData[i] = sgd.PopUnsignedShort();
 
+    statisticHistory.Deserialize(sgd);
+
     // Deserialize Pacts:
     for(unsigned i = 0; i < MAX_PLAYERS; ++i)
     {
@@ -1338,7 +1342,7 @@ void GamePlayer::RegulateAllTroops()
 void GamePlayer::RecalcMilitaryFlags()
 {
     for(std::list<nobMilitary*>::iterator it = military_buildings.begin(); it != military_buildings.end(); ++it)
-        (*it)->LookForEnemyBuildings(NULL);
+        gwg->RequestFrontierCheck(**it);
 }
 
 /// Sucht für Soldaten ein neues Militärgebäude, als Argument wird Referenz auf die
@@ -1621,6 +1625,8 @@ void GamePlayer::StatisticStep()
 
     statistic[STAT_15M].counter++;
 
+    statisticHistory.AddStep(statisticCurrentData, statisticCurrentMerchandiseData);
+
     // Prüfen ob 4mal 15-min-Statistik weitergeschoben wurde, wenn ja: 1-h-Statistik weiterschieben
     // und aktuellen Wert der 15min-Statistik benutzen
     // gleiches für die 4h und 16h Statistik
@@ -20,6 +20,7 @@
 
 #include "GameMessage_GameCommand.h"
 #include "GamePlayerInfo.h"
+#include "StatisticHistory.h"
 #include "helpers/containerUtils.h"
 #include "helpers/multiArray.h"
 #include "gameTypes/BuildingTypes.h"
@@ -373,6 +374,8 @@ public:
         RTTR_Assert(idx < STAT_TYPE_COUNT);
         return (statisticCurrentData[idx]);
     }
+    /// Statistics of all steps of the game (the ones above only contain the last few steps of each time)
+    const StatisticHistory& GetStatisticHistory() const { return statisticHistory; }
 
     // Testet ob Notfallprogramm aktiviert werden muss und tut dies dann
     void TestForEmergencyProgramm();
@@ -478,6 +481,7 @@ private:
     // Die Statistikwerte die 'aktuell' gemessen werden
     boost::array<int, STAT_TYPE_COUNT> statisticCurrentData;
     boost::array<int, STAT_MERCHANDISE_TYPE_COUNT> statisticCurrentMerchandiseData;
+    StatisticHistory statisticHistory;
 
     // Notfall-Programm aktiviert ja/nein (Es gehen nur noch Res an Holzfäller- und Sägewerk-Baustellen raus)
     bool emergency;
@@ -24,9 +24,10 @@
 #include "gameData/MinimapConsts.h"
 #include "gameData/TerrainData.h"
 #include "libsiedler2/src/ColorARGB.h"
+#include <algorithm>
 
 IngameMinimap::IngameMinimap(const GameWorldViewer& gwv)
-    : Minimap(gwv.GetWorld().GetSize()), gwv(gwv), nodes_updated(GetMapSize().x * GetMapSize().y, false),
+    : Minimap(gwv.GetWorld().GetSize()), gwv(gwv), nodes_updated(GetMapSize().x * GetMapSize().y, false), firstNodeToUpdate(0),
       dos(GetMapSize().x * GetMapSize().y, DO_INVALID), territory(true), houses(true), roads(true)
 {
     CreateMapTexture();
@@ -209,36 +210,29 @@ void IngameMinimap::UpdateNode(const MapPoint pt)
  */
 void IngameMinimap::BeforeDrawing()
 {
-    // Ab welcher Knotenanzahl (Teil der Gesamtknotenanzahl) die Textur komplett neu erstellt werden soll
-    static const unsigned MAX_NODES_UPDATE_DENOMINATOR = 2; // (2 = 1/2, 3 = 1/3 usw.)
+    // Max. number of nodes updated per frame. The rest is done in the next frames so that e.g. a complete update
+    // of a large map does not stall the game
+    static const unsigned MAX_NODES_PER_FRAME = 16384;
 
-    if(!nodesToUpdate.empty())
-    {
-        // Komplette Textur neu erzeugen, weil es zu viele Knoten sind?
-        if(nodesToUpdate.size() >= nodes_updated.size() / MAX_NODES_UPDATE_DENOMINATOR)
-        {
-            // Ja, alles neu erzeugen
-            UpdateAll();
-            std::fill(nodes_updated.begin(), nodes_updated.end(), false);
-        } else
-        {
-            map.beginUpdate();
-            // Entsprechende Pixel updaten
-            for(std::vector<MapPoint>::iterator it = nodesToUpdate.begin(); it != nodesToUpdate.end(); ++it)
-            {
-                for(unsigned t = 0; t < 2; ++t)
-                {
-                    unsigned color = CalcPixelColor(*it, t);
-                    DrawPoint texPos((it->x * 2 + t + (it->y & 1)) % (GetMapSize().x * 2), it->y);
-                    map.updatePixel(texPos, libsiedler2::ColorARGB(color));
-                }
-                nodes_updated[GetMMIdx(*it)] = false;
-            }
-            map.endUpdate();
-        }
+    if(nodesToUpdate.empty())
+        return;
 
-        this->nodesToUpdate.clear();
+    const unsigned endNode = std::min<unsigned>(firstNodeToUpdate + MAX_NODES_PER_FRAME, nodesToUpdate.size());
+    // Only the changed rows of the texture are uploaded
+    map.beginUpdate();
+    for(unsigned i = firstNodeToUpdate; i < endNode; i++)
+    {
+        UpdatePixels(nodesToUpdate[i]);
+        nodes_updated[GetMMIdx(nodesToUpdate[i])] = false;
     }
+    map.endUpdate();
+
+    if(endNode == nodesToUpdate.size())
+    {
+        nodesToUpdate.clear();
+        firstNodeToUpdate = 0;
+    } else
+        firstNodeToUpdate = endNode;
 }
 
 /**
@@ -246,8 +240,13 @@ void IngameMinimap::BeforeDrawing()
  */
 void IngameMinimap::UpdateAll()
 {
-    map.DeleteTexture();
-    CreateMapTexture();
+    // Update all nodes row by row instead of recreating the texture
+    nodesToUpdate.clear();
+    firstNodeToUpdate = 0;
+    nodesToUpdate.reserve(nodes_updated.size());
+    RTTR_FOREACH_PT(MapPoint, GetMapSize())
+        nodesToUpdate.push_back(pt);
+    std::fill(nodes_updated.begin(), nodes_updated.end(), true);
 }
 
 /**
@@ -259,22 +258,26 @@ void IngameMinimap::UpdateAll(const DrawnObject drawn_object)
     // Gesamte Karte neu berechnen
     RTTR_FOREACH_PT(MapPoint, GetMapSize())
     {
-        for(unsigned t = 0; t < 2; ++t)
-        {
-            if(dos[GetMMIdx(pt)] == drawn_object
-               || (drawn_object == DO_PLAYER
-                   && // for DO_PLAYER check for not drawn buildings or roads as there is only the player territory visible
-                   ((dos[GetMMIdx(pt)] == DO_BUILDING && !houses) || (dos[GetMMIdx(pt)] == DO_ROAD && !roads))))
-            {
-                unsigned color = CalcPixelColor(pt, t);
-                DrawPoint texPos((pt.x * 2 + t + (pt.y & 1)) % (GetMapSize().x * 2), pt.y);
-                map.updatePixel(texPos, libsiedler2::ColorARGB(color));
-            }
-        }
+        const DrawnObject curDrawnObject = dos[GetMMIdx(pt)];
+        if(curDrawnObject == drawn_object
+           || (drawn_object == DO_PLAYER
+               && // for DO_PLAYER check for not drawn buildings or roads as there is only the player territory visible
+               ((curDrawnObject == DO_BUILDING && !houses) || (curDrawnObject == DO_ROAD && !roads))))
+            UpdatePixels(pt);
     }
     map.endUpdate();
 }
 
+void IngameMinimap::UpdatePixels(const MapPoint pt)
+{
+    for(unsigned t = 0; t < 2; ++t)
+    {
+        unsigned color = CalcPixelColor(pt, t);
+        DrawPoint texPos((pt.x * 2 + t + (pt.y & 1)) % (GetMapSize().x * 2), pt.y);
+        map.updatePixel(texPos, libsiedler2::ColorARGB(color));
+    }
+}
+
 void IngameMinimap::ToggleTerritory()
 {
     territory = !territory;
@@ -33,6 +33,8 @@ class IngameMinimap : public Minimap
     std::vector<bool> nodes_updated;
     /// Liste mit allen Punkten, die geändert werden müssen
     std::vector<MapPoint> nodesToUpdate;
+    /// Index of the first entry in nodesToUpdate that was not yet updated
+    unsigned firstNodeToUpdate;
 
     /// Für jeden einzelnen Knoten speichern, welches Objekt hier dominiert, also wessen Pixel angezeigt wird
     enum DrawnObject
@@ -58,7 +60,7 @@ public:
     /// Merkt, vor dass ein bestimmter Punkt aktualisiert werden soll
     void UpdateNode(const MapPoint pt);
 
-    /// Updatet die gesamte Minimap
+    /// Updatet die gesamte Minimap (spread over the next frames)
     void UpdateAll();
 
     /// Die einzelnen Dinge umschalten
@@ -80,6 +82,8 @@ protected:
     void BeforeDrawing() override;
     /// Alle Punkte Updaten, bei denen das DrawnObject gleich dem übergebenen drawn_object ist
     void UpdateAll(const DrawnObject drawn_object);
+    /// Recalculate the color of both pixels of the node. Only valid between map.beginUpdate and map.endUpdate
+    void UpdatePixels(const MapPoint pt);
 };
 
 #endif // IngameMinimap_h__
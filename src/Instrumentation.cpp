@@ -0,0 +1,212 @@
+// Copyright (c) 2016 Settlers Freaks (sf-team at siedler25.org)
+//
+// This file is part of Return To The Roots.
+//
+// Return To The Roots is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 2 of the License, or
+// (at your option) any later version.
+//
+// Return To The Roots is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Return To The Roots. If not, see <http://www.gnu.org/licenses/>.
+
+#include "defines.h" // IWYU pragma: keep
+#include "Instrumentation.h"
+#include <algorithm>
+#include <sstream>
+
+BOOST_CONSTEXPR_OR_CONST unsigned Instrumentation::NUM_GFS;
+BOOST_CONSTEXPR_OR_CONST unsigned Instrumentation::NUM_FRAMES;
+
+namespace {
+const char* const SUBSYSTEM_NAMES[INSTR_COUNT] = {"Events", "Pathfinding", "Territory", "AI", "Terrain", "Serialization"};
+
+boost::posix_time::ptime GetTime()
+{
+    return boost::posix_time::microsec_clock::universal_time();
+}
+} // namespace
+
+void Instrumentation::History::Add(const GFStats& stats, unsigned maxSize)
+{
+    if(entries.size() < maxSize)
+        entries.push_back(stats);
+    else
+        entries[next] = stats;
+    next = (next + 1) % maxSize;
+}
+
+void Instrumentation::History::Clear()
+{
+    entries.clear();
+    next = 0;
+}
+
+Instrumentation::Instrumentation() : isEnabled(false), isFirstTraceEvent(true)
+{
+    scopeDepth.assign(0);
+    gfStats.entries.reserve(NUM_GFS);
+    frameStats.entries.reserve(NUM_FRAMES);
+}
+
+Instrumentation::~Instrumentation()
+{
+    StopTrace();
+}
+
+const char* Instrumentation::GetName(InstrumentedSubsystem subsystem)
+{
+    RTTR_Assert(subsystem < INSTR_COUNT);
+    return SUBSYSTEM_NAMES[subsystem];
+}
+
+void Instrumentation::SetEnabled(bool enabled)
+{
+    isEnabled = enabled;
+    if(!isEnabled)
+        StopTrace();
+}
+
+void Instrumentation::Clear()
+{
+    curGF = curFrame = GFStats();
+    gfStats.Clear();
+    frameStats.Clear();
+}
+
+bool Instrumentation::StartTrace(const std::string& filePath)
+{
+    StopTrace();
+    traceFile.open(filePath);
+    if(!traceFile)
+        return false;
+    traceStart = GetTime();
+    isFirstTraceEvent = true;
+    // JSON array format, each event on its own line
+    traceFile << "[";
+    isEnabled = true;
+    return true;
+}
+
+void Instrumentation::StopTrace()
+{
+    if(!traceFile.is_open())
+        return;
+    traceFile << "\n]\n";
+    traceFile.close();
+}
+
+void Instrumentation::WriteTraceEvent(const char* name, const char* phase, const boost::posix_time::ptime& time, const std::string& fields)
+{
+    if(!isFirstTraceEvent)
+        traceFile << ",";
+    isFirstTraceEvent = false;
+    traceFile << "\n{\"name\":\"" << name << "\",\"ph\":\"" << phase << "\",\"pid\":1,\"tid\":1,\"ts\":"
+              << (time - traceStart).total_microseconds() << fields << "}";
+}
+
+void Instrumentation::BeginScope(InstrumentedSubsystem subsystem)
+{
+    if(scopeDepth[subsystem]++ == 0)
+        scopeStart[subsystem] = GetTime();
+}
+
+void Instrumentation::EndScope(InstrumentedSubsystem subsystem, unsigned count)
+{
+    RTTR_Assert(scopeDepth[subsystem] > 0);
+    Stats& stats = IsPerFrame(subsystem) ? curFrame[subsystem] : curGF[subsystem];
+    stats.count += count;
+    if(--scopeDepth[subsystem] > 0)
+        return;
+    const boost::posix_time::time_duration duration = GetTime() - scopeStart[subsystem];
+    stats.time += static_cast<unsigned>(duration.total_microseconds());
+    stats.numCalls++;
+    if(IsTracing())
+    {
+        std::stringstream fields;
+        fields << ",\"dur\":" << duration.total_microseconds();
+        if(count)
+            fields << ",\"args\":{\"count\":" << count << "}";
+        WriteTraceEvent(GetName(subsystem), "X", scopeStart[subsystem], fields.str());
+    }
+}
+
+void Instrumentation::WriteTimeCounter(const char* name, const GFStats& stats, bool perFrame)
+{
+    std::stringstream fields;
+    fields << ",\"args\":{";
+    bool isFirst = true;
+    for(unsigned i = 0; i < INSTR_COUNT; i++)
+    {
+        if(IsPerFrame(InstrumentedSubsystem(i)) != perFrame)
+            continue;
+        fields << (isFirst ? "" : ",") << "\"" << SUBSYSTEM_NAMES[i] << "\":" << stats[i].time;
+        isFirst = false;
+    }
+    fields << "}";
+    WriteTraceEvent(name, "C", GetTime(), fields.str());
+}
+
+void Instrumentation::EndGF(unsigned gf)
+{
+    if(!isEnabled)
+        return;
+    if(IsTracing())
+    {
+        std::stringstream name;
+        name << "GF " << gf;
+        WriteTraceEvent(name.str().c_str(), "i", GetTime(), ",\"s\":\"g\"");
+        WriteTimeCounter("Time per GF (us)", curGF, false);
+    }
+    gfStats.Add(curGF, NUM_GFS);
+    curGF = GFStats();
+}
+
+void Instrumentation::EndFrame()
+{
+    if(!isEnabled)
+        return;
+    if(IsTracing())
+        WriteTimeCounter("Time per frame (us)", curFrame, true);
+    frameStats.Add(curFrame, NUM_FRAMES);
+    curFrame = GFStats();
+}
+
+Instrumentation::Stats Instrumentation::GetAverage(InstrumentedSubsystem subsystem) const
+{
+    RTTR_Assert(subsystem < INSTR_COUNT);
+    Stats result;
+    const std::vector<GFStats>& entries = GetHistory(subsystem).entries;
+    if(entries.empty())
+        return result;
+    unsigned long long time = 0, numCalls = 0, count = 0;
+    for(std::vector<GFStats>::const_iterator it = entries.begin(); it != entries.end(); ++it)
+    {
+        time += (*it)[subsystem].time;
+        numCalls += (*it)[subsystem].numCalls;
+        count += (*it)[subsystem].count;
+    }
+    result.time = static_cast<unsigned>(time / entries.size());
+    result.numCalls = static_cast<unsigned>(numCalls / entries.size());
+    result.count = static_cast<unsigned>(count / entries.size());
+    return result;
+}
+
+Instrumentation::Stats Instrumentation::GetMax(InstrumentedSubsystem subsystem) const
+{
+    RTTR_Assert(subsystem < INSTR_COUNT);
+    Stats result;
+    const std::vector<GFStats>& entries = GetHistory(subsystem).entries;
+    for(std::vector<GFStats>::const_iterator it = entries.begin(); it != entries.end(); ++it)
+    {
+        result.time = std::max(result.time, (*it)[subsystem].time);
+        result.numCalls = std::max(result.numCalls, (*it)[subsystem].numCalls);
+        result.count = std::max(result.count, (*it)[subsystem].count);
+    }
+    return result;
+}
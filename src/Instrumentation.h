@@ -0,0 +1,156 @@
+// Copyright (c) 2016 Settlers Freaks (sf-team at siedler25.org)
+//
+// This file is part of Return To The Roots.
+//
+// Return To The Roots is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 2 of the License, or
+// (at your option) any later version.
+//
+// Return To The Roots is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Return To The Roots. If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef Instrumentation_h__
+#define Instrumentation_h__
+
+#include "libutil/src/Singleton.h"
+#include <boost/array.hpp>
+#include <boost/date_time/posix_time/posix_time_types.hpp>
+#include <boost/filesystem/fstream.hpp>
+#include <string>
+#include <vector>
+
+/// Parts of the game measured by the instrumentation. The count of each is given in the comment.
+/// Drawing subsystems (see Instrumentation::IsPerFrame) are measured per drawn frame, the others per GF
+enum InstrumentedSubsystem
+{
+    INSTR_EVENTS,        // Game events (executed events)
+    INSTR_PATHFINDING,   // Free and road path finding (visited nodes)
+    INSTR_TERRITORY,     // Territory recalculation (nodes of the recalculated regions)
+    INSTR_AI,            // AI players
+    INSTR_TERRAIN,       // Drawing the terrain (drawn terrain triangles)
+    INSTR_SERIALIZATION, // Saving and loading the game (bytes)
+    INSTR_COUNT
+};
+
+/// Timers and counters for the hot paths of the game.
+/// Disabled by default, in which case a ScopedTimer only checks a flag. When enabled the time, calls and counts
+/// of each subsystem are summed per GF (or per frame for drawing subsystems, as the frames per GF vary and GFs stop while paused).
+/// The last NUM_GFS GFs and NUM_FRAMES frames are kept for the averages (e.g. for an overlay)
+/// and each measured scope can be written to a trace file (Chrome trace event format, see chrome://tracing)
+class Instrumentation : public Singleton<Instrumentation>
+{
+public:
+    /// Number of GFs and frames used for the averages
+    BOOST_STATIC_CONSTEXPR unsigned NUM_GFS = 250;
+    BOOST_STATIC_CONSTEXPR unsigned NUM_FRAMES = 250;
+
+    struct Stats
+    {
+        /// Time in us. Nested scopes of the same subsystem are counted once,
+        /// other subsystems used by this one are included (e.g. the path finding of the AI)
+        unsigned time;
+        unsigned numCalls;
+        unsigned count;
+        Stats() : time(0), numCalls(0), count(0) {}
+    };
+    /// Stats of all subsystems for one GF or frame. Only the entries of the matching subsystems are used
+    typedef boost::array<Stats, INSTR_COUNT> GFStats;
+
+    Instrumentation();
+    ~Instrumentation();
+
+    /// Enable collecting the stats. Disabling also stops the trace
+    void SetEnabled(bool enabled);
+    bool IsEnabled() const { return isEnabled; }
+
+    /// Start writing all measured scopes to the file (also enables the instrumentation). Returns false if it can't be opened
+    bool StartTrace(const std::string& filePath);
+    void StopTrace();
+    bool IsTracing() const { return traceFile.is_open(); }
+
+    /// Called at the end of each GF: Stores the stats of the GF
+    void EndGF(unsigned gf);
+    /// Called after drawing each frame: Stores the stats of the drawing subsystems for the frame
+    void EndFrame();
+    /// Remove all collected stats
+    void Clear();
+
+    /// Number of GFs and frames the averages are calculated of
+    unsigned GetNumGFs() const { return static_cast<unsigned>(gfStats.entries.size()); }
+    unsigned GetNumFrames() const { return static_cast<unsigned>(frameStats.entries.size()); }
+    /// Average and maximum stats of the subsystem per GF or per frame (if IsPerFrame)
+    Stats GetAverage(InstrumentedSubsystem subsystem) const;
+    Stats GetMax(InstrumentedSubsystem subsystem) const;
+    /// Stats collected in the current (not yet ended) GF
+    const GFStats& GetCurrentGF() const { return curGF; }
+    /// Stats collected in the current (not yet ended) frame
+    const GFStats& GetCurrentFrame() const { return curFrame; }
+
+    static const char* GetName(InstrumentedSubsystem subsystem);
+    /// True for the drawing subsystems, which are measured per frame instead of per GF
+    static bool IsPerFrame(InstrumentedSubsystem subsystem) { return subsystem == INSTR_TERRAIN; }
+
+    /// Use ScopedTimer instead
+    void BeginScope(InstrumentedSubsystem subsystem);
+    void EndScope(InstrumentedSubsystem subsystem, unsigned count);
+
+    /// Measures its lifetime for the subsystem, if the instrumentation is enabled
+    class ScopedTimer
+    {
+        InstrumentedSubsystem subsystem;
+        bool isActive;
+        unsigned count;
+
+    public:
+        explicit ScopedTimer(InstrumentedSubsystem subsystem) : subsystem(subsystem), isActive(inst().IsEnabled()), count(0)
+        {
+            if(isActive)
+                inst().BeginScope(subsystem);
+        }
+        ~ScopedTimer()
+        {
+            if(isActive)
+                inst().EndScope(subsystem, count);
+        }
+        /// Add to the count of the subsystem (cheap, only used when the timer ends)
+        void AddCount(unsigned amount = 1) { count += amount; }
+    };
+
+private:
+    /// Ring buffer of the stats of the last GFs or frames
+    struct History
+    {
+        std::vector<GFStats> entries;
+        /// Position of the next entry
+        unsigned next;
+        History() : next(0) {}
+        void Add(const GFStats& stats, unsigned maxSize);
+        void Clear();
+    };
+
+    bool isEnabled;
+    GFStats curGF, curFrame;
+    History gfStats, frameStats;
+    /// Number of open scopes and start time of the outermost one per subsystem
+    boost::array<unsigned, INSTR_COUNT> scopeDepth;
+    boost::array<boost::posix_time::ptime, INSTR_COUNT> scopeStart;
+    bfs::ofstream traceFile;
+    boost::posix_time::ptime traceStart;
+    bool isFirstTraceEvent;
+
+    /// Write a trace event (JSON object) with the common fields and the given additional ones
+    void WriteTraceEvent(const char* name, const char* phase, const boost::posix_time::ptime& time, const std::string& fields);
+    /// Write a counter event with the times of the subsystems measured per frame (perFrame=true) or per GF
+    void WriteTimeCounter(const char* name, const GFStats& stats, bool perFrame);
+    const History& GetHistory(InstrumentedSubsystem subsystem) const { return IsPerFrame(subsystem) ? frameStats : gfStats; }
+};
+
+#define INSTRUMENTATION Instrumentation::inst()
+
+#endif // Instrumentation_h__
@@ -26,6 +26,7 @@
 #include "drivers/VideoDriverWrapper.h"
 #include "files.h"
 #include "helpers/Deleter.h"
+#include "helpers/ParallelFor.h"
 #include "ogl/SoundEffectItem.h"
 #include "ogl/glArchivItem_Bitmap_Player.h"
 #include "ogl/glArchivItem_Bitmap_RLE.h"
@@ -77,10 +78,16 @@ bool Loader::LoadFilesAtStart()
     using namespace boost::assign; // Adds the vector += operator
     std::vector<unsigned> files;
 
+    // The palettes are required to decode the other files and the splash screen should be shown as early as possible
     files += 5, 6, 7, 8, 9, 10, 17, // Paletten:     pal5.bbm, pal6.bbm, pal7.bbm, paletti0.bbm, paletti1.bbm, paletti8.bbm, colors.act
-      FILE_SPLASH_ID,               // Splashscreen: splash.bmp
-      11, 12,                       // Menüdateien:  resource.dat, io.dat
-      102, 103,                     // Hintergründe: setup013.lbm, setup015.lbm
+      FILE_SPLASH_ID;               // Splashscreen: splash.bmp
+
+    if(!LoadFilesFromArray(files.size(), &files.front(), true))
+        return false;
+
+    files.clear();
+    files += 11, 12, // Menüdateien:  resource.dat, io.dat
+      102, 103,      // Hintergründe: setup013.lbm, setup015.lbm
       64, 65, 66, 67, 68, 69, 70, 71, 72, 73, 74, 75, 76, 77, 78, 79, 80, 81, 82, 83, 84; // Die ganzen Spielladescreens.
 
     if(!LoadFilesFromArray(files.size(), &files.front(), true))
@@ -119,14 +126,7 @@ bool Loader::LoadFileOrDir(const std::string& file, const unsigned file_id, bool
 
         LOG.write(_("Loading LST,BOB,IDX,BMP,TXT,GER,ENG,INI files from \"%s\"\n")) % GetFilePath(file);
 
-        std::vector<std::string> lst = ListDir(file, "lst", true);
-        lst = ListDir(file, "bob", true, &lst);
-        lst = ListDir(file, "idx", true, &lst);
-        lst = ListDir(file, "bmp", true, &lst);
-        lst = ListDir(file, "txt", true, &lst);
-        lst = ListDir(file, "ger", true, &lst);
-        lst = ListDir(file, "eng", true, &lst);
-        lst = ListDir(file, "ini", true, &lst);
+        std::vector<std::string> lst = ListArchivFiles(file);
 
         libsiedler2::ArchivItem_Palette* pal5 = GetPaletteN("pal5");
         for(std::vector<std::string>::iterator i = lst.begin(); i != lst.end(); ++i)
@@ -153,6 +153,133 @@ bool Loader::LoadFileOrDir(const std::string& file, const unsigned file_id, bool
     return true;
 }
 
+std::vector<std::string> Loader::ListArchivFiles(const std::string& dir)
+{
+    std::vector<std::string> lst = ListDir(dir, "lst", true);
+    lst = ListDir(dir, "bob", true, &lst);
+    lst = ListDir(dir, "idx", true, &lst);
+    lst = ListDir(dir, "bmp", true, &lst);
+    lst = ListDir(dir, "txt", true, &lst);
+    lst = ListDir(dir, "ger", true, &lst);
+    lst = ListDir(dir, "eng", true, &lst);
+    lst = ListDir(dir, "ini", true, &lst);
+    return lst;
+}
+
+namespace {
+template<class T_Items>
+struct DecodeItems
+{
+    T_Items& items;
+    DecodeItems(T_Items& items) : items(items) {}
+    void operator()(unsigned idx) { items[idx].Decode(); }
+};
+
+/// Name of the FileEntry a file is loaded into
+std::string GetFileEntryName(const std::string& filePath)
+{
+    std::string lowerPath = filePath;
+    std::transform(lowerPath.begin(), lowerPath.end(), lowerPath.begin(), tolower);
+    return bfs::path(lowerPath).filename().stem().string();
+}
+
+/// A file in a directory that is loaded as an archiv
+struct DirEntry : private boost::noncopyable
+{
+    std::string filePath, fileName, extension;
+    const libsiedler2::ArchivItem_Palette* palette;
+    /// Index in the archiv or -1 to append it
+    int nr;
+    libsiedler2::BobType bobtype;
+    short nx, ny;
+    unsigned char dx, dy;
+    /// Item created by Decode (for bitmaps and palettes)
+    libsiedler2::ArchivItem* item;
+    /// Error code returned by libsiedler2 and time taken by Decode in ms
+    int ec;
+    unsigned loadTime;
+
+    DirEntry(const std::string& filePath, const libsiedler2::ArchivItem_Palette* palette)
+        : filePath(filePath), palette(palette), nr(-1), bobtype(libsiedler2::BOBTYPE_BITMAP_RAW), nx(0), ny(0), dx(0), dy(0),
+          item(NULL), ec(0), loadTime(0)
+    {}
+    ~DirEntry() { delete item; }
+
+    bool IsDecoded() const { return extension == "bmp" || extension == "bbm" || extension == "act"; }
+    /// Load the file and convert it. Runs in a worker thread so it must not log or access the loader
+    void Decode();
+};
+
+void DirEntry::Decode()
+{
+    if(!IsDecoded())
+        return;
+    const unsigned startTime = VIDEODRIVER.GetTickCount();
+    libsiedler2::Archiv temp;
+    ec = libsiedler2::Load(GetFilePath(filePath), temp, palette);
+    if(!ec)
+    {
+        if(extension == "bmp")
+        {
+            // Nun Daten abhängig der Typen erstellen, nur erstes Element wird bei Bitmaps konvertiert
+            glArchivItem_Bitmap* in = dynamic_cast<glArchivItem_Bitmap*>(temp.get(0));
+            glArchivItem_BitmapBase* out = dynamic_cast<glArchivItem_BitmapBase*>(libsiedler2::getAllocator().create(bobtype));
+            // Unknown type: item stays NULL
+            if(out)
+            {
+                out->setName(fileName);
+                out->setNx(nx);
+                out->setNy(ny);
+
+                const unsigned width = in->getWidth(), height = in->getHeight();
+                std::vector<unsigned char> buffer(width * height * 4);
+                in->print(&buffer.front(), width, height, libsiedler2::FORMAT_BGRA, palette);
+
+                if(bobtype == libsiedler2::BOBTYPE_BITMAP_PLAYER)
+                    dynamic_cast<glArchivItem_Bitmap_Player*>(out)->create(width, height, &buffer.front(), width, height,
+                                                                           libsiedler2::FORMAT_BGRA, palette, 128);
+                else
+                    dynamic_cast<glArchivItem_Bitmap*>(out)->create(width, height, &buffer.front(), width, height,
+                                                                    libsiedler2::FORMAT_BGRA, palette);
+                item = out;
+            }
+        } else // Palettes
+            item = temp[0]->clone();
+    }
+    loadTime = VIDEODRIVER.GetTickCount() - startTime;
+}
+} // namespace
+
+void Loader::DecodedArchiv::Decode()
+{
+    // Note: Must not log or access the loader as this runs in a worker thread
+    const unsigned startTime = VIDEODRIVER.GetTickCount();
+    ec = libsiedler2::Load(filePath, archiv, palette);
+    loadTime = VIDEODRIVER.GetTickCount() - startTime;
+}
+
+void Loader::DecodeFiles(const std::vector<std::string>& filePaths, const libsiedler2::ArchivItem_Palette* palette, bool isOriginal)
+{
+    decodedArchives_.clear();
+    BOOST_FOREACH(const std::string& filePath, filePaths)
+    {
+        // Directories are loaded item by item (in parallel too)
+        if(!bfs::is_regular_file(filePath))
+            continue;
+        // Skip files that LoadFile won't load again
+        std::map<std::string, FileEntry>::const_iterator itEntry = files_.find(GetFileEntryName(filePath));
+        if(isOriginal && itEntry != files_.end() && !itEntry->second.archiv.empty() && !itEntry->second.hasOverrides)
+            continue;
+        decodedArchives_.push_back(new DecodedArchiv(GetFilePath(filePath), palette));
+    }
+    if(decodedArchives_.empty())
+        return;
+    const unsigned startTime = VIDEODRIVER.GetTickCount();
+    DecodeItems<boost::ptr_vector<DecodedArchiv> > decoder(decodedArchives_);
+    helpers::parallelFor(decodedArchives_.size(), decoder);
+    LOG.write(_("Decoded %u files in %ums\n")) % decodedArchives_.size() % (VIDEODRIVER.GetTickCount() - startTime);
+}
+
 /**
  *  Lädt Dateien aus FILE_PATHS bzw aus dem Verzeichnis.
  *
@@ -163,6 +290,23 @@ bool Loader::LoadFileOrDir(const std::string& file, const unsigned file_id, bool
  */
 bool Loader::LoadFilesFromArray(const unsigned files_count, const unsigned* files, bool isOriginal)
 {
+    // Decode all files in parallel first. They are still loaded (and overridden) in order below
+    // which takes over the decoded archives so the result is the same as loading them one after another
+    std::vector<std::string> filePaths;
+    for(unsigned i = 0; i < files_count; ++i)
+    {
+        if(files[i] == 0xFFFFFFFF)
+            continue;
+        std::string filePath = GetFilePath(FILE_PATHS[files[i]]);
+        if(bfs::is_directory(filePath))
+        {
+            std::vector<std::string> dirFiles = ListArchivFiles(filePath);
+            filePaths.insert(filePaths.end(), dirFiles.begin(), dirFiles.end());
+        } else
+            filePaths.push_back(filePath);
+    }
+    DecodeFiles(filePaths, GetPaletteN("pal5"), isOriginal);
+
     // load the files or directorys
     for(unsigned i = 0; i < files_count; ++i)
     {
@@ -173,9 +317,11 @@ bool Loader::LoadFilesFromArray(const unsigned files_count, const unsigned* file
         if(!LoadFileOrDir(filePath, files[i], isOriginal))
         {
             LOG.write(_("Failed to load %s\n")) % filePath;
+            decodedArchives_.clear();
             return false;
         }
     }
+    decodedArchives_.clear();
 
     return true;
 }
@@ -473,7 +619,14 @@ bool Loader::LoadFilesAtGame(unsigned char gfxset, bool* nations)
 
 void Loader::fillCaches()
 {
-    delete stp;
+    if(stp)
+    {
+        // The shared textures are deleted with the packer so the images need to create their own ones again
+        std::vector<ITexturePackable*> staticImages = GetStaticImages();
+        BOOST_FOREACH(ITexturePackable* image, staticImages)
+            image->SetSharedTexture(0, Extent(0, 0), Extent(0, 0));
+        delete stp;
+    }
     stp = new glTexturePacker();
 
     // Animals
@@ -847,12 +1000,93 @@ void Loader::fillCaches()
 
     if(SETTINGS.video.shared_textures)
     {
+        // Pack the images from the files (GUI, nation buildings, fonts, ...) together with the caches
+        std::vector<ITexturePackable*> staticImages = GetStaticImages();
+        BOOST_FOREACH(ITexturePackable* image, staticImages)
+            stp->add(*image);
+        // Reuse the textures packed in a previous run if the files did not change
+        stp->setCacheFile(GetFilePath(FILE_PATHS[100]) + "textures.cache", CalcFilesKey());
         // generate mega texture
         stp->pack();
     } else
         deletePtr(stp);
 }
 
+std::vector<ITexturePackable*> Loader::GetStaticImages()
+{
+    // Bigger images (backgrounds, loading screens) are only drawn once in a while and would only bloat the shared textures
+    BOOST_CONSTEXPR_OR_CONST unsigned maxSize = 256;
+
+    std::vector<ITexturePackable*> images;
+    for(std::map<std::string, FileEntry>::iterator it = files_.begin(); it != files_.end(); ++it)
+    {
+        libsiedler2::Archiv& archiv = it->second.archiv;
+        // The terrain file is only used to extract the terrain textures
+        if(&archiv == tex_gfx)
+            continue;
+        for(unsigned i = 0; i < archiv.size(); i++)
+        {
+            libsiedler2::ArchivItem* item = archiv[i];
+            if(glArchivItem_BitmapBase* bmp = dynamic_cast<glArchivItem_BitmapBase*>(item))
+            {
+                const Extent size = bmp->GetPackedSize();
+                if(size.x <= maxSize && size.y <= maxSize)
+                    images.push_back(bmp);
+            } else if(glArchivItem_Font* font = dynamic_cast<glArchivItem_Font*>(item))
+                font->GetBitmaps(images);
+        }
+    }
+    return images;
+}
+
+namespace {
+/// 64 bit FNV-1a hash (size_t based hashes would only have 32 bits on some platforms)
+class FilesKeyHash
+{
+    uint64_t value;
+
+public:
+    FilesKeyHash() : value((static_cast<uint64_t>(0xCBF29CE4) << 32) | 0x84222325) {}
+    void Add(const void* data, size_t size)
+    {
+        const uint64_t prime = (static_cast<uint64_t>(1) << 40) | 0x1B3;
+        const unsigned char* bytes = static_cast<const unsigned char*>(data);
+        for(size_t i = 0; i < size; i++)
+        {
+            value ^= bytes[i];
+            value *= prime;
+        }
+    }
+    void Add(uint64_t data) { Add(&data, sizeof(data)); }
+    /// Adds the length too, so the boundaries of successive strings are part of the hash
+    void Add(const std::string& data)
+    {
+        Add(static_cast<uint64_t>(data.size()));
+        Add(data.data(), data.size());
+    }
+    uint64_t GetValue() const { return value; }
+};
+} // namespace
+
+uint64_t Loader::CalcFilesKey() const
+{
+    // Checksumming the content would take about as long as packing, so use the file attributes instead
+    FilesKeyHash key;
+    key.Add(static_cast<uint64_t>(lastgfx));
+    for(std::map<std::string, FileEntry>::const_iterator it = files_.begin(); it != files_.end(); ++it)
+    {
+        key.Add(it->first);
+        BOOST_FOREACH(const std::string& source, it->second.sources)
+        {
+            boost::system::error_code ec;
+            key.Add(source);
+            key.Add(static_cast<uint64_t>(bfs::file_size(source, ec)));
+            key.Add(static_cast<uint64_t>(bfs::last_write_time(source, ec)));
+        }
+    }
+    return key.GetValue();
+}
+
 /**
  *  Lädt Dateien von Addons.
  *
@@ -1133,7 +1367,23 @@ bool Loader::LoadArchiv(const std::string& pfad, const libsiedler2::ArchivItem_P
     LOG.write(_("Loading \"%s\": ")) % file;
     fflush(stdout);
 
-    if(int ec = libsiedler2::Load(file, archiv, palette))
+    int ec;
+    boost::ptr_vector<DecodedArchiv>::iterator itDecoded = decodedArchives_.begin();
+    while(itDecoded != decodedArchives_.end() && (itDecoded->filePath != file || itDecoded->palette != palette))
+        ++itDecoded;
+    if(itDecoded != decodedArchives_.end())
+    {
+        // Already decoded -> Take over the items
+        ec = itDecoded->ec;
+        archiv.alloc(itDecoded->archiv.size());
+        for(unsigned i = 0; i < itDecoded->archiv.size(); i++)
+            archiv.set(i, itDecoded->archiv.release(i));
+        ladezeit -= itDecoded->loadTime;
+        decodedArchives_.erase(itDecoded);
+    } else
+        ec = libsiedler2::Load(file, archiv, palette);
+
+    if(ec)
     {
         LOG.write(_("failed: %1%\n")) % libsiedler2::getErrorString(ec);
         return false;
@@ -1179,110 +1429,80 @@ bool Loader::LoadFile(const std::string& filePath, const libsiedler2::ArchivItem
 
     std::sort(lst.begin(), lst.end(), SortFilesHelper);
 
-    std::vector<unsigned char> buffer(1000 * 1000 * 4);
+    // Decode the bitmaps and palettes in parallel and add all items in order afterwards
+    boost::ptr_vector<DirEntry> entries;
     for(std::vector<std::string>::iterator itFile = lst.begin(); itFile != lst.end(); ++itFile)
     {
+        DirEntry* entry = new DirEntry(*itFile, palette);
+        entries.push_back(entry);
+
         // read file number, to set the index correctly
-        const std::string filename = bfs::path(*itFile).filename().string();
+        entry->fileName = bfs::path(*itFile).filename().string();
         std::stringstream nrs;
-        int nr = -1;
-        nrs << filename;
-        if(!(nrs >> nr))
-            nr = -1;
+        nrs << entry->fileName;
+        if(!(nrs >> entry->nr))
+            entry->nr = -1;
 
         // Dateiname zerlegen
         std::vector<std::string> wf = ExplodeString(*itFile, '.');
-
-        libsiedler2::BobType bobtype = libsiedler2::BOBTYPE_BITMAP_RAW;
-        short nx = 0;
-        short ny = 0;
-        unsigned char dx = 0;
-        unsigned char dy = 0;
-        libsiedler2::ArchivItem* item = NULL;
+        entry->extension = wf.back();
 
         // Common
         for(std::vector<std::string>::iterator it = wf.begin(); it != wf.end(); ++it)
         {
             if(*it == "rle")
-                bobtype = libsiedler2::BOBTYPE_BITMAP_RLE;
+                entry->bobtype = libsiedler2::BOBTYPE_BITMAP_RLE;
             else if(*it == "player")
-                bobtype = libsiedler2::BOBTYPE_BITMAP_PLAYER;
+                entry->bobtype = libsiedler2::BOBTYPE_BITMAP_PLAYER;
             else if(*it == "shadow")
-                bobtype = libsiedler2::BOBTYPE_BITMAP_SHADOW;
+                entry->bobtype = libsiedler2::BOBTYPE_BITMAP_SHADOW;
 
             else if(it->substr(0, 2) == "nx")
-                nx = atoi(it->substr(2).c_str());
+                entry->nx = atoi(it->substr(2).c_str());
             else if(it->substr(0, 2) == "ny")
-                ny = atoi(it->substr(2).c_str());
+                entry->ny = atoi(it->substr(2).c_str());
             else if(it->substr(0, 2) == "dx")
-                dx = atoi(it->substr(2).c_str());
+                entry->dx = atoi(it->substr(2).c_str());
             else if(it->substr(0, 2) == "dy")
-                dy = atoi(it->substr(2).c_str());
+                entry->dy = atoi(it->substr(2).c_str());
         }
+    }
+    DecodeItems<boost::ptr_vector<DirEntry> > decoder(entries);
+    helpers::parallelFor(entries.size(), decoder);
 
-        if(wf.back() == "empty") // Placeholder
+    BOOST_FOREACH(DirEntry& entry, entries)
+    {
+        libsiedler2::ArchivItem* item = NULL;
+
+        if(entry.extension == "empty") // Placeholder
         {
-            LOG.write(_("Skipping %s\n")) % *itFile;
+            LOG.write(_("Skipping %s\n")) % entry.filePath;
             to.alloc_inc(1);
             continue;
-        } else if(wf.back() == "bmp") // Bitmap
+        } else if(entry.IsDecoded()) // Bitmap or palette
         {
-            libsiedler2::Archiv temp;
-            if(!LoadArchiv(*itFile, palette, temp))
-                return false;
-
-            // Nun Daten abhängig der Typen erstellen, nur erstes Element wird bei Bitmaps konvertiert
-
-            glArchivItem_Bitmap* in = dynamic_cast<glArchivItem_Bitmap*>(temp.get(0));
-            glArchivItem_BitmapBase* out = dynamic_cast<glArchivItem_BitmapBase*>(libsiedler2::getAllocator().create(bobtype));
-
-            if(!out)
+            LOG.write(_("Loading \"%s\": ")) % entry.filePath;
+            if(entry.ec)
             {
-                LOG.write("unbekannter bobtype: %d\n") % bobtype;
+                LOG.write(_("failed: %1%\n")) % libsiedler2::getErrorString(entry.ec);
                 return false;
             }
-
-            out->setName(filename);
-            out->setNx(nx);
-            out->setNy(ny);
-
-            std::fill(buffer.begin(), buffer.end(), 0);
-            in->print(&buffer.front(), 1000, 1000, libsiedler2::FORMAT_BGRA, palette);
-
-            switch(bobtype)
+            LOG.write(_("done in %ums\n")) % entry.loadTime;
+            if(!entry.item)
             {
-                case libsiedler2::BOBTYPE_BITMAP_RLE:
-                case libsiedler2::BOBTYPE_BITMAP_SHADOW:
-                case libsiedler2::BOBTYPE_BITMAP_RAW:
-                {
-                    dynamic_cast<glArchivItem_Bitmap*>(out)->create(in->getWidth(), in->getHeight(), &buffer.front(), 1000, 1000,
-                                                                    libsiedler2::FORMAT_BGRA, palette);
-                }
-                break;
-                case libsiedler2::BOBTYPE_BITMAP_PLAYER:
-                {
-                    dynamic_cast<glArchivItem_Bitmap_Player*>(out)->create(in->getWidth(), in->getHeight(), &buffer.front(), 1000, 1000,
-                                                                           libsiedler2::FORMAT_BGRA, palette, 128);
-                }
-                break;
-                default: throw std::logic_error("Invalid Bitmap type");
-            }
-
-            item = out;
-        } else if((wf.back() == "bbm") || (wf.back() == "act")) // Palettes
-        {
-            libsiedler2::Archiv temp;
-            if(!LoadArchiv(*itFile, palette, temp))
+                LOG.write("unbekannter bobtype: %d\n") % entry.bobtype;
                 return false;
-            item = temp[0]->clone();
-        } else if(wf.back() == "fon") // Font
+            }
+            item = entry.item;
+            entry.item = NULL;
+        } else if(entry.extension == "fon") // Font
         {
             glArchivItem_Font* font = new glArchivItem_Font();
-            font->setName(filename);
-            font->setDx(dx);
-            font->setDy(dy);
+            font->setName(entry.fileName);
+            font->setDx(entry.dx);
+            font->setDy(entry.dy);
 
-            if(!LoadFile(*itFile, palette, *font))
+            if(!LoadFile(entry.filePath, palette, *font))
                 return false;
             else
                 delete font;
@@ -1290,6 +1510,7 @@ bool Loader::LoadFile(const std::string& filePath, const libsiedler2::ArchivItem
             item = font;
         }
 
+        const int nr = entry.nr;
         if(item)
         {
             // had the filename a number? then set it to the corresponding item.
@@ -1338,6 +1559,7 @@ bool Loader::LoadFile(const std::string& pfad, const libsiedler2::ArchivItem_Pal
     if(!isLoaded)
     {
         entry.hasOverrides = !isOriginal;
+        entry.sources.assign(1, pfad);
         return LoadFile(pfad, palette, entry.archiv);
     }
 
@@ -1380,6 +1602,7 @@ bool Loader::LoadFile(const std::string& pfad, const libsiedler2::ArchivItem_Pal
 
     // Tell the system that we used overrides
     entry.hasOverrides = true;
+    entry.sources.push_back(pfad);
 
     return true;
 }
@@ -30,6 +30,8 @@
 #include "libsiedler2/src/Archiv.h"
 #include "libutil/src/Singleton.h"
 #include <boost/array.hpp>
+#include <boost/noncopyable.hpp>
+#include <boost/ptr_container/ptr_vector.hpp>
 #include <map>
 #include <stdint.h>
 #include <string>
@@ -44,6 +46,7 @@ class glArchivItem_Bob;
 class glArchivItem_Font;
 class SoundEffectItem;
 class glTexturePacker;
+class ITexturePackable;
 namespace libsiedler2 {
 class ArchivItem_Ini;
 class ArchivItem_Palette;
@@ -60,6 +63,8 @@ class Loader : public Singleton<Loader, SingletonPolicies::WithLongevity>
         libsiedler2::Archiv archiv;
         /// True if the archiv was modified by overrides
         bool hasOverrides;
+        /// Files the archiv was loaded from (original file followed by the overrides)
+        std::vector<std::string> sources;
         FileEntry() : hasOverrides(false) {}
     };
 
@@ -105,6 +110,15 @@ private:
     bool LoadFilesFromArray(const unsigned files_count, const unsigned* files, bool isOriginal);
     bool LoadLsts(unsigned dir);
     bool LoadFileOrDir(const std::string& file, const unsigned file_id, bool isOriginal);
+    /// Return the archiv files (and directories) in the directory that are loaded by LoadFileOrDir
+    static std::vector<std::string> ListArchivFiles(const std::string& dir);
+    /// Decode the files that would be loaded by LoadFile in parallel. LoadArchiv then only takes over the result.
+    void DecodeFiles(const std::vector<std::string>& filePaths, const libsiedler2::ArchivItem_Palette* palette, bool isOriginal);
+
+    /// Return the images of the loaded files that can use shared textures
+    std::vector<ITexturePackable*> GetStaticImages();
+    /// Return a key identifying the currently loaded files (path, size and modification time) and graphic set
+    uint64_t CalcFilesKey() const;
 
     static bool SortFilesHelper(const std::string& lhs, const std::string& rhs);
     static std::vector<std::string> ExplodeString(std::string const& line, const char delim, const unsigned max = 0xFFFFFFFF);
@@ -141,6 +155,24 @@ private:
         return res;
     }
     std::map<std::string, FileEntry> files_;
+
+    /// An archiv decoded in advance by a worker thread
+    struct DecodedArchiv : private boost::noncopyable
+    {
+        std::string filePath;
+        const libsiedler2::ArchivItem_Palette* palette;
+        libsiedler2::Archiv archiv;
+        /// Error code returned by libsiedler2
+        int ec;
+        /// Time taken for decoding in ms
+        unsigned loadTime;
+        DecodedArchiv(const std::string& filePath, const libsiedler2::ArchivItem_Palette* palette)
+            : filePath(filePath), palette(palette), ec(0), loadTime(0)
+        {}
+        void Decode();
+    };
+    /// Archives decoded by DecodeFiles that were not yet taken over
+    boost::ptr_vector<DecodedArchiv> decodedArchives_;
     /// Terraintextures (unanimated)
     std::map<TerrainType, glArchivItem_Bitmap*> terrainTextures;
     /// Terraintextures (animated) (currently only water and lava)
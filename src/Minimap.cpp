@@ -21,6 +21,9 @@
 #include "ogl/oglIncludes.h"
 #include "libsiedler2/src/PixelBufferARGB.h"
 
+/// Textures larger than this (in any direction) get mipmaps
+static const unsigned MAX_SIZE_WITHOUT_MIPMAPS = 256;
+
 Minimap::Minimap(const MapExtent& mapSize) : mapSize(mapSize)
 {
 }
@@ -43,7 +46,11 @@ void Minimap::CreateMapTexture()
         }
     }
 
-    map.setFilter(GL_LINEAR);
+    // Large maps are usually drawn downscaled, so use mipmaps to avoid flickering
+    if(buffer.getWidth() > MAX_SIZE_WITHOUT_MIPMAPS || buffer.getHeight() > MAX_SIZE_WITHOUT_MIPMAPS)
+        map.setFilter(GL_LINEAR_MIPMAP_LINEAR);
+    else
+        map.setFilter(GL_LINEAR);
     map.create(buffer.getWidth(), buffer.getHeight(), buffer.getPixelPtr(), buffer.getWidth(), buffer.getHeight(),
                libsiedler2::FORMAT_BGRA);
 }
@@ -27,6 +27,12 @@
 #include "gameTypes/ShipDirection.h"
 #include "gameData/GameConsts.h"
 #include <boost/foreach.hpp>
+#include <queue>
+
+namespace {
+/// Distance in a ship distance field for nodes from which the coastal point cannot be reached (or which are too far away)
+BOOST_CONSTEXPR_OR_CONST unsigned short SHIP_DISTANCE_UNREACHABLE = 0xFFFF;
+} // namespace
 
 /// Param for road-build pathfinding
 struct Param_RoadPath
@@ -79,6 +85,13 @@ unsigned char GameWorldBase::FindHumanPath(const MapPoint start, const MapPoint
         return INVALID_DIR;
 }
 
+std::vector<bool> GameWorldBase::CheckHumanPaths(const MapPoint start, const std::vector<MapPoint>& goals, const unsigned max_route) const
+{
+    std::vector<bool> isReachable;
+    GetFreePathFinder().FindReachableGoals(start, goals, max_route, isReachable, PathConditionHuman(*this));
+    return isReachable;
+}
+
 /// Wegfindung für Menschen im Straßennetz
 unsigned char GameWorldGame::FindHumanPathOnRoads(const noRoadNode& start, const noRoadNode& goal, unsigned* length, MapPoint* firstPt,
                                                   const RoadSegment* const forbidden)
@@ -118,7 +131,90 @@ bool GameWorldBase::FindShipPathToHarbor(const MapPoint start, unsigned harborId
     }
     // Add a few fields reserve
     maxDistance += 6;
-    return FindShipPath(start, GetCoastalPoint(harborId, seaId), maxDistance, route, length);
+    const MapPoint dest = GetCoastalPoint(harborId, seaId);
+    // Distances that large cannot be stored in the field
+    if(maxDistance >= SHIP_DISTANCE_UNREACHABLE)
+        return FindShipPath(start, dest, maxDistance, route, length);
+    RTTR_Assert(start != dest);
+
+    const std::vector<unsigned short>& distances = GetShipDistanceField(dest);
+    const unsigned distance = distances[GetIdx(start)];
+    // Also true for unreachable nodes
+    if(distance > maxDistance)
+        return false;
+    if(length)
+        *length = distance;
+    if(!route)
+        return true;
+
+    // Go to any neighbour that is 1 step closer. Start with a different direction depending on the position and GF (as FindShipPath)
+    // so ships don't always use the same route.
+    // The route is as long as the one of FindShipPath but may be another one of the same length (the A* search order cannot be
+    // reproduced from the distances), so ships take other routes than in games recorded before the distance fields
+    route->resize(distance);
+    const PathConditionShip pathCond(*this);
+    const unsigned startDir = GetIdx(start) * GetEvMgr().GetCurrentGF() % Direction::COUNT;
+    MapPoint curPt = start;
+    for(unsigned i = 0; i < distance; i++)
+    {
+        const unsigned nextDistance = distance - i - 1;
+        bool found = false;
+        for(unsigned z = startDir; z < startDir + Direction::COUNT; ++z)
+        {
+            const Direction dir(z);
+            const MapPoint nextPt = GetNeighbour(curPt, dir);
+            if(distances[GetIdx(nextPt)] != nextDistance || !pathCond.IsEdgeOk(curPt, dir))
+                continue;
+            // All but the goal must be sea points
+            if(nextDistance > 0 && !pathCond.IsNodeOk(nextPt))
+                continue;
+            (*route)[i] = dir;
+            curPt = nextPt;
+            found = true;
+            break;
+        }
+        RTTR_Assert(found);
+    }
+    RTTR_Assert(curPt == dest);
+    return true;
+}
+
+const std::vector<unsigned short>& GameWorldBase::GetShipDistanceField(const MapPoint dest)
+{
+    const unsigned destIdx = GetIdx(dest);
+    const std::vector<unsigned short>* cachedDistances = shipDistanceFields.find(destIdx);
+    if(cachedDistances)
+        return *cachedDistances;
+
+    // Breadth first search from the coastal point with the same conditions as FindShipPath:
+    // All nodes of the route but start and goal must be sea points. Edges can be used in both directions
+    std::vector<unsigned short>& distances = shipDistanceFields.insert(destIdx, std::vector<unsigned short>());
+    distances.resize(GetWidth() * GetHeight(), SHIP_DISTANCE_UNREACHABLE);
+    const PathConditionShip pathCond(*this);
+    std::queue<MapPoint> todo;
+    distances[destIdx] = 0;
+    todo.push(dest);
+    while(!todo.empty())
+    {
+        const MapPoint curPt = todo.front();
+        todo.pop();
+        const unsigned nextDistance = distances[GetIdx(curPt)] + 1u;
+        if(nextDistance >= SHIP_DISTANCE_UNREACHABLE)
+            continue;
+        for(unsigned iDir = 0; iDir < Direction::COUNT; iDir++)
+        {
+            const Direction dir = Direction::fromInt(iDir);
+            const MapPoint nextPt = GetNeighbour(curPt, dir);
+            unsigned short& nextPtDistance = distances[GetIdx(nextPt)];
+            if(nextPtDistance != SHIP_DISTANCE_UNREACHABLE || !pathCond.IsEdgeOk(curPt, dir))
+                continue;
+            nextPtDistance = static_cast<unsigned short>(nextDistance);
+            // Other nodes can only be the start of a route
+            if(pathCond.IsNodeOk(nextPt))
+                todo.push(nextPt);
+        }
+    }
+    return distances;
 }
 
 bool GameWorldBase::FindShipPath(const MapPoint start, const MapPoint dest, unsigned maxDistance, std::vector<Direction>* route,
@@ -28,7 +28,7 @@ std::string Savegame::GetSignature() const
 
 uint16_t Savegame::GetVersion() const
 {
-    return 36; // SaveGameVersion -- Updater signature, do NOT remove
+    return 37; // SaveGameVersion -- Updater signature, do NOT remove
 }
 
 //////////////////////////////////////////////////////////////////////////
@@ -25,6 +25,7 @@
 #include "EventManager.h"
 #include "FOWObjects.h"
 #include "GameEvent.h"
+#include "Instrumentation.h"
 #include "RoadSegment.h"
 #include "Ware.h"
 #include "buildings/BurnedWarehouse.h"
@@ -197,6 +198,7 @@ void SerializedGameData::Prepare(bool reading)
 
 void SerializedGameData::MakeSnapshot(GameWorld& gw)
 {
+    Instrumentation::ScopedTimer timer(INSTR_SERIALIZATION);
     Prepare(false);
 
     // Anzahl Objekte reinschreiben
@@ -216,10 +218,13 @@ void SerializedGameData::MakeSnapshot(GameWorld& gw)
     RTTR_Assert(expectedObjectsCount == objectsCount + 1); // "Nothing" nodeObj does not get serialized
 
     writtenObjIds.clear();
+    timer.AddCount(GetLength());
 }
 
 void SerializedGameData::ReadSnapshot(GameWorld& gw)
 {
+    Instrumentation::ScopedTimer timer(INSTR_SERIALIZATION);
+    timer.AddCount(GetLength());
     Prepare(true);
 
     em = &gw.GetEvMgr();
@@ -82,6 +82,7 @@ bool Settings::LoadDefaults()
     video.vsync = 0;
     video.vbo = false;
     video.shared_textures = true;
+    video.idle_redraw = false;
     // }
 
     // language
@@ -207,6 +208,8 @@ bool Settings::Load()
         video.vsync = iniVideo->getValueI("vsync");
         video.vbo = (iniVideo->getValueI("vbo") != 0);
         video.shared_textures = (iniVideo->getValueI("shared_textures") != 0);
+        // Optional, added later
+        video.idle_redraw = (!iniVideo->getValue("idle_redraw").empty() && iniVideo->getValueI("idle_redraw") != 0);
         // };
 
         if(video.fullscreen_width == 0 || video.fullscreen_height == 0 || video.windowed_width == 0 || video.windowed_height == 0)
@@ -353,6 +356,7 @@ void Settings::Save()
     iniVideo->setValue("vsync", video.vsync);
     iniVideo->setValue("vbo", (video.vbo ? 1 : 0));
     iniVideo->setValue("shared_textures", (video.shared_textures ? 1 : 0));
+    iniVideo->setValue("idle_redraw", (video.idle_redraw ? 1 : 0));
     // };
 
     // language
@@ -59,6 +59,8 @@ public:
         unsigned short vsync;
         bool vbo;
         bool shared_textures;
+        /// Skip redrawing the menus while nothing changes
+        bool idle_redraw;
     } video;
 
     struct
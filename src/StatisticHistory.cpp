@@ -0,0 +1,249 @@
+// Copyright (c) 2016 Settlers Freaks (sf-team at siedler25.org)
+//
+// This file is part of Return To The Roots.
+//
+// Return To The Roots is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 2 of the License, or
+// (at your option) any later version.
+//
+// Return To The Roots is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Return To The Roots. If not, see <http://www.gnu.org/licenses/>.
+
+#include "defines.h" // IWYU pragma: keep
+#include "StatisticHistory.h"
+#include "libutil/src/Serializer.h"
+#include <ostream>
+
+BOOST_CONSTEXPR_OR_CONST unsigned StatisticHistory::NUM_COLUMNS;
+BOOST_CONSTEXPR_OR_CONST unsigned StatisticHistory::NUM_TIERS;
+BOOST_CONSTEXPR_OR_CONST unsigned StatisticHistory::TIER_FACTOR;
+BOOST_CONSTEXPR_OR_CONST unsigned StatisticHistory::TIER_CAPACITY;
+
+namespace {
+void EncodeDelta(std::vector<unsigned char>& data, int value, int lastValue)
+{
+    // Zig-zag: Small positive and negative deltas get small codes (0, -1, 1, -2... -> 0, 1, 2, 3...)
+    const unsigned delta = static_cast<unsigned>(value) - static_cast<unsigned>(lastValue);
+    unsigned code = (delta << 1) ^ (0u - (delta >> 31));
+    // 7 bits per byte, highest bit set if more follow
+    while(code >= 0x80)
+    {
+        data.push_back(static_cast<unsigned char>(code | 0x80));
+        code >>= 7;
+    }
+    data.push_back(static_cast<unsigned char>(code));
+}
+
+const char* const COLUMN_NAMES[StatisticHistory::NUM_COLUMNS] = {
+  // Statistic types
+  "country", "buildings", "inhabitants", "merchandise", "military", "gold", "productivity", "vanquished", "tournament",
+  // Merchandise types (see GamePlayer::IncreaseMerchandiseStatistic)
+  "wood", "boards", "stones", "food", "water", "beer", "coal", "ironore", "goldore", "iron", "coins", "tools", "weapons", "boats"};
+} // namespace
+
+StatisticHistory::StatisticHistory()
+{
+    Clear();
+}
+
+void StatisticHistory::Clear()
+{
+    numSteps = 0;
+    for(unsigned t = 0; t < NUM_TIERS; t++)
+        ClearTier(tiers[t]);
+}
+
+void StatisticHistory::ClearTier(Tier& tier)
+{
+    tier.firstStep = 0;
+    tier.numEntries = 0;
+    for(unsigned c = 0; c < NUM_COLUMNS; c++)
+        tier.columns[c].clear();
+    tier.lastValues.assign(0);
+    tier.pendingValues.assign(0);
+    tier.numPending = 0;
+}
+
+unsigned StatisticHistory::GetStepsPerEntry(unsigned tier)
+{
+    unsigned result = 1;
+    for(unsigned t = 0; t < tier; t++)
+        result *= TIER_FACTOR;
+    return result;
+}
+
+void StatisticHistory::AddStep(const Values& values, const MerchandiseValues& merchandise)
+{
+    for(unsigned t = 0; t < NUM_TIERS; t++)
+    {
+        Tier& tier = tiers[t];
+        for(unsigned c = 0; c < NUM_COLUMNS; c++)
+        {
+            if(IsSumColumn(c))
+                tier.pendingValues[c] += merchandise[c - STAT_TYPE_COUNT];
+            else
+                tier.pendingValues[c] = values[c];
+        }
+        if(++tier.numPending < GetStepsPerEntry(t))
+            continue;
+        AddEntry(tier, tier.pendingValues);
+        tier.pendingValues.assign(0);
+        tier.numPending = 0;
+        // Drop the oldest entries in chunks so the re-encoding is rare
+        if(t + 1 < NUM_TIERS && tier.numEntries >= TIER_CAPACITY * 3 / 2)
+            DropEntries(tier, tier.numEntries - TIER_CAPACITY, GetStepsPerEntry(t));
+    }
+    numSteps++;
+}
+
+void StatisticHistory::AddEntry(Tier& tier, const boost::array<int, NUM_COLUMNS>& values)
+{
+    for(unsigned c = 0; c < NUM_COLUMNS; c++)
+    {
+        EncodeDelta(tier.columns[c], values[c], tier.lastValues[c]);
+        tier.lastValues[c] = values[c];
+    }
+    tier.numEntries++;
+}
+
+void StatisticHistory::DropEntries(Tier& tier, unsigned numEntries, unsigned stepsPerEntry)
+{
+    RTTR_Assert(numEntries <= tier.numEntries);
+    for(unsigned c = 0; c < NUM_COLUMNS; c++)
+    {
+        const std::vector<int> column = Decode(tier.columns[c], tier.numEntries);
+        std::vector<unsigned char>& data = tier.columns[c];
+        data.clear();
+        int lastValue = 0;
+        for(unsigned i = numEntries; i < column.size(); i++)
+        {
+            EncodeDelta(data, column[i], lastValue);
+            lastValue = column[i];
+        }
+    }
+    tier.numEntries -= numEntries;
+    tier.firstStep += numEntries * stepsPerEntry;
+}
+
+std::vector<int> StatisticHistory::Decode(const std::vector<unsigned char>& data, unsigned numEntries)
+{
+    std::vector<int> result;
+    result.reserve(numEntries);
+    unsigned value = 0;
+    for(unsigned i = 0; i < data.size();)
+    {
+        unsigned code = 0;
+        for(unsigned shift = 0; i < data.size(); shift += 7)
+        {
+            const unsigned char curByte = data[i++];
+            code |= static_cast<unsigned>(curByte & 0x7F) << shift;
+            if(!(curByte & 0x80))
+                break;
+        }
+        const unsigned delta = (code >> 1) ^ (0u - (code & 1));
+        value += delta;
+        result.push_back(static_cast<int>(value));
+    }
+    RTTR_Assert(result.size() == numEntries);
+    return result;
+}
+
+unsigned StatisticHistory::GetNumEntries(unsigned tier) const
+{
+    RTTR_Assert(tier < NUM_TIERS);
+    return tiers[tier].numEntries;
+}
+
+unsigned StatisticHistory::GetFirstStep(unsigned tier) const
+{
+    RTTR_Assert(tier < NUM_TIERS);
+    return tiers[tier].firstStep;
+}
+
+std::vector<int> StatisticHistory::GetColumn(unsigned tier, unsigned column) const
+{
+    RTTR_Assert(tier < NUM_TIERS);
+    RTTR_Assert(column < NUM_COLUMNS);
+    return Decode(tiers[tier].columns[column], tiers[tier].numEntries);
+}
+
+const char* StatisticHistory::GetColumnName(unsigned column)
+{
+    RTTR_Assert(column < NUM_COLUMNS);
+    return COLUMN_NAMES[column];
+}
+
+void StatisticHistory::Serialize(Serializer& ser) const
+{
+    ser.PushUnsignedInt(numSteps);
+    for(unsigned t = 0; t < NUM_TIERS; t++)
+    {
+        const Tier& tier = tiers[t];
+        ser.PushUnsignedInt(tier.firstStep);
+        ser.PushUnsignedInt(tier.numEntries);
+        ser.PushUnsignedInt(tier.numPending);
+        for(unsigned c = 0; c < NUM_COLUMNS; c++)
+        {
+            ser.PushSignedInt(tier.lastValues[c]);
+            ser.PushSignedInt(tier.pendingValues[c]);
+            ser.PushUnsignedInt(tier.columns[c].size());
+            if(!tier.columns[c].empty())
+                ser.PushRawData(&tier.columns[c].front(), tier.columns[c].size());
+        }
+    }
+}
+
+void StatisticHistory::Deserialize(Serializer& ser)
+{
+    numSteps = ser.PopUnsignedInt();
+    for(unsigned t = 0; t < NUM_TIERS; t++)
+    {
+        Tier& tier = tiers[t];
+        tier.firstStep = ser.PopUnsignedInt();
+        tier.numEntries = ser.PopUnsignedInt();
+        tier.numPending = ser.PopUnsignedInt();
+        for(unsigned c = 0; c < NUM_COLUMNS; c++)
+        {
+            tier.lastValues[c] = ser.PopSignedInt();
+            tier.pendingValues[c] = ser.PopSignedInt();
+            tier.columns[c].resize(ser.PopUnsignedInt());
+            if(!tier.columns[c].empty())
+                ser.PopRawData(&tier.columns[c].front(), tier.columns[c].size());
+        }
+    }
+}
+
+void StatisticHistory::WriteCSV(std::ostream& out, unsigned tier) const
+{
+    RTTR_Assert(tier < NUM_TIERS);
+    std::vector<std::vector<int> > columns;
+    columns.reserve(NUM_COLUMNS);
+    out << "step";
+    for(unsigned c = 0; c < NUM_COLUMNS; c++)
+    {
+        out << "," << GetColumnName(c);
+        columns.push_back(GetColumn(tier, c));
+    }
+    out << "\n";
+    const unsigned stepsPerEntry = GetStepsPerEntry(tier);
+    for(unsigned i = 0; i < tiers[tier].numEntries; i++)
+    {
+        out << tiers[tier].firstStep + (i + 1) * stepsPerEntry - 1;
+        for(unsigned c = 0; c < NUM_COLUMNS; c++)
+            out << "," << columns[c][i];
+        out << "\n";
+    }
+}
+
+void StatisticHistory::WriteBinary(std::ostream& out) const
+{
+    Serializer ser;
+    Serialize(ser);
+    out.write(reinterpret_cast<const char*>(ser.GetData()), ser.GetLength());
+}
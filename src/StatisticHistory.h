@@ -0,0 +1,98 @@
+// Copyright (c) 2016 Settlers Freaks (sf-team at siedler25.org)
+//
+// This file is part of Return To The Roots.
+//
+// Return To The Roots is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 2 of the License, or
+// (at your option) any later version.
+//
+// Return To The Roots is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Return To The Roots. If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef StatisticHistory_h__
+#define StatisticHistory_h__
+
+#include "gameTypes/StatisticTypes.h"
+#include <boost/array.hpp>
+#include <iosfwd>
+#include <vector>
+
+class Serializer;
+
+/// Statistics of a player over the whole game (one entry per statistic step).
+/// Each column (all statistic types followed by all merchandise types) is stored separately as
+/// zig-zag encoded variable length deltas to the previous entry, so slowly changing values take 1 byte per entry.
+/// Entries are kept in tiers with decreasing resolution: Tier t combines TIER_FACTOR^t steps per entry
+/// (last value of the statistics, sum of the merchandise). All but the last tier keep only the newest
+/// TIER_CAPACITY to TIER_CAPACITY * 3 / 2 entries, so the whole game is available in the last tier.
+class StatisticHistory
+{
+public:
+    BOOST_STATIC_CONSTEXPR unsigned NUM_COLUMNS = STAT_TYPE_COUNT + STAT_MERCHANDISE_TYPE_COUNT;
+    BOOST_STATIC_CONSTEXPR unsigned NUM_TIERS = 3;
+    BOOST_STATIC_CONSTEXPR unsigned TIER_FACTOR = 4;
+    BOOST_STATIC_CONSTEXPR unsigned TIER_CAPACITY = 512;
+
+    typedef boost::array<int, STAT_TYPE_COUNT> Values;
+    typedef boost::array<int, STAT_MERCHANDISE_TYPE_COUNT> MerchandiseValues;
+
+    StatisticHistory();
+
+    void Clear();
+    /// Add the values of the next statistic step (merchandise: produced during that step)
+    void AddStep(const Values& values, const MerchandiseValues& merchandise);
+
+    /// Number of steps added so far
+    unsigned GetNumSteps() const { return numSteps; }
+    /// Number of steps combined in each entry of the tier
+    static unsigned GetStepsPerEntry(unsigned tier);
+    /// Number of (complete) entries in the tier
+    unsigned GetNumEntries(unsigned tier) const;
+    /// Step of the first value of the first entry in the tier
+    unsigned GetFirstStep(unsigned tier) const;
+    /// Return all entries of a column in the tier, oldest first. Column is a StatisticType or STAT_TYPE_COUNT + merchandise index
+    std::vector<int> GetColumn(unsigned tier, unsigned column) const;
+    /// Return a name for the column usable as an identifier
+    static const char* GetColumnName(unsigned column);
+
+    void Serialize(Serializer& ser) const;
+    void Deserialize(Serializer& ser);
+
+    /// Write the tier as CSV: Header line with "step" and the column names, then one line per entry.
+    /// The step is the one of the last value combined in the entry
+    void WriteCSV(std::ostream& out, unsigned tier) const;
+    /// Write all tiers in the serialized (compact) format
+    void WriteBinary(std::ostream& out) const;
+
+private:
+    struct Tier
+    {
+        unsigned firstStep;
+        unsigned numEntries;
+        /// Encoded deltas per column
+        boost::array<std::vector<unsigned char>, NUM_COLUMNS> columns;
+        /// Last value added per column (base for the next delta)
+        boost::array<int, NUM_COLUMNS> lastValues;
+        /// Entry being combined from the steps and the number of steps in it
+        boost::array<int, NUM_COLUMNS> pendingValues;
+        unsigned numPending;
+    };
+
+    unsigned numSteps;
+    boost::array<Tier, NUM_TIERS> tiers;
+
+    static bool IsSumColumn(unsigned column) { return column >= STAT_TYPE_COUNT; }
+    static void ClearTier(Tier& tier);
+    static void AddEntry(Tier& tier, const boost::array<int, NUM_COLUMNS>& values);
+    /// Remove the given number of oldest entries of the tier
+    static void DropEntries(Tier& tier, unsigned numEntries, unsigned stepsPerEntry);
+    static std::vector<int> Decode(const std::vector<unsigned char>& data, unsigned numEntries);
+};
+
+#endif // StatisticHistory_h__
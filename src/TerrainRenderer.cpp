@@ -20,10 +20,12 @@
 #include "ExtensionList.h"
 #include "GameClient.h"
 #include "GlobalVars.h"
+#include "Instrumentation.h"
 #include "Loader.h"
 #include "Settings.h"
 #include "drivers/VideoDriverWrapper.h"
 #include "ogl/glArchivItem_Bitmap.h"
+#include "ogl/glSpriteBatch.h"
 #include "ogl/oglIncludes.h"
 #include "world/GameWorldBase.h"
 #include "world/GameWorldViewer.h"
@@ -32,6 +34,7 @@
 #include "gameData/TerrainData.h"
 #include "libsiedler2/src/Archiv.h"
 #include <boost/smart_ptr/scoped_array.hpp>
+#include <algorithm>
 #include <cstdlib>
 
 /* Terrain rendering works like that:
@@ -48,11 +51,14 @@
  *  - gl_texCoords: Texture coordinates for the triangle
  *  - gl_colors: Color (shade) at each point of the triangle
  *
- * Drawing then binds a texture and draws all adjacent vertices with the same texture in one call by
+ * The map is divided into chunks of CHUNK_SIZE x CHUNK_SIZE points. The triangles of each chunk are consecutive
+ * in the above arrays and sorted by texture (the border triangles follow sorted by border type).
+ * Drawing then binds a texture and draws all triangles with that texture of each visible chunk in one call by
  * providing an index and a count into the above arrays.
+ * Changes are uploaded to the VBOs per chunk once per frame.
  */
 
-TerrainRenderer::TerrainRenderer() : size_(0, 0), vbo_vertices(0), vbo_texcoords(0), vbo_colors(0), vboBuffersUsed(false)
+TerrainRenderer::TerrainRenderer() : size_(0, 0), numChunks_(0, 0), vbo_vertices(0), vbo_texcoords(0), vbo_colors(0), vboBuffersUsed(false)
 {
 }
 
@@ -156,13 +162,25 @@ void TerrainRenderer::UpdateBorderVertex(const MapPoint pt)
 void TerrainRenderer::Init(const MapExtent& size)
 {
     size_ = size;
+    drawBatches.isValid = false;
     // Clear first, so they are default-initialized
     vertices.clear();
     terrain.clear();
     borders.clear();
     vertices.resize(size_.x * size_.y);
     terrain.resize(vertices.size());
+    triangleOffsets.resize(vertices.size());
     borders.resize(size_.x * size_.y);
+    // Until the chunks are generated the triangles of a point are next to each other
+    for(unsigned i = 0; i < triangleOffsets.size(); ++i)
+    {
+        triangleOffsets[i][0] = i * 2;
+        triangleOffsets[i][1] = i * 2 + 1;
+    }
+    numChunks_ = MapExtent(0, 0);
+    chunks.clear();
+    dirtyChunks.clear();
+    chunkDirtyFlags.clear();
 
     gl_vertices.clear();
     gl_texcoords.clear();
@@ -183,8 +201,7 @@ void TerrainRenderer::GenerateOpenGL(const GameWorldViewer& gwv)
 
     GenerateVertices(gwv);
 
-    // Add extra vertices for borders
-    unsigned triangleCount = gl_vertices.size();
+    // Determine the borders
     const LandscapeType lt = world.GetLandscapeType();
     for(MapCoord y = 0; y < size_.y; ++y)
     {
@@ -197,23 +214,19 @@ void TerrainRenderer::GenerateOpenGL(const GameWorldViewer& gwv)
             const TerrainType t3 = TerrainType(terrain[GetVertexIdx(GetNeighbour(pt, Direction::EAST))][0]);
             const TerrainType t4 = TerrainType(terrain[GetVertexIdx(GetNeighbour(pt, Direction::SOUTHWEST))][1]);
 
-            if((borders[pos].left_right[0] = TerrainData::GetEdgeType(lt, t2, t1)))
-                borders[pos].left_right_offset[0] = triangleCount++;
-            if((borders[pos].left_right[1] = TerrainData::GetEdgeType(lt, t1, t2)))
-                borders[pos].left_right_offset[1] = triangleCount++;
-
-            if((borders[pos].right_left[0] = TerrainData::GetEdgeType(lt, t3, t2)))
-                borders[pos].right_left_offset[0] = triangleCount++;
-            if((borders[pos].right_left[1] = TerrainData::GetEdgeType(lt, t2, t3)))
-                borders[pos].right_left_offset[1] = triangleCount++;
-
-            if((borders[pos].top_down[0] = TerrainData::GetEdgeType(lt, t4, t1)))
-                borders[pos].top_down_offset[0] = triangleCount++;
-            if((borders[pos].top_down[1] = TerrainData::GetEdgeType(lt, t1, t4)))
-                borders[pos].top_down_offset[1] = triangleCount++;
+            borders[pos].left_right[0] = TerrainData::GetEdgeType(lt, t2, t1);
+            borders[pos].left_right[1] = TerrainData::GetEdgeType(lt, t1, t2);
+            borders[pos].right_left[0] = TerrainData::GetEdgeType(lt, t3, t2);
+            borders[pos].right_left[1] = TerrainData::GetEdgeType(lt, t2, t3);
+            borders[pos].top_down[0] = TerrainData::GetEdgeType(lt, t4, t1);
+            borders[pos].top_down[1] = TerrainData::GetEdgeType(lt, t1, t4);
         }
     }
 
+    // Sort the triangles into the chunks
+    GenerateChunks();
+    const unsigned triangleCount = chunks.back().borderOffsets.back();
+
     gl_vertices.resize(triangleCount);
     gl_texcoords.resize(triangleCount);
     gl_colors.resize(triangleCount);
@@ -272,31 +285,135 @@ void TerrainRenderer::GenerateOpenGL(const GameWorldViewer& gwv)
     }
 }
 
+void TerrainRenderer::GenerateChunks()
+{
+    numChunks_ = MapExtent((size_.x + CHUNK_SIZE - 1) / CHUNK_SIZE, (size_.y + CHUNK_SIZE - 1) / CHUNK_SIZE);
+    chunks.clear();
+    chunks.resize(numChunks_.x * numChunks_.y);
+    dirtyChunks.clear();
+    chunkDirtyFlags.clear();
+    chunkDirtyFlags.resize(chunks.size(), 0);
+
+    unsigned triangleCount = 0;
+    for(MapCoord cy = 0; cy < numChunks_.y; ++cy)
+    {
+        for(MapCoord cx = 0; cx < numChunks_.x; ++cx)
+        {
+            TerrainChunk& chunk = chunks[cy * numChunks_.x + cx];
+            // Points of the chunk (the last chunks might be smaller)
+            const MapPoint chunkStart(cx * CHUNK_SIZE, cy * CHUNK_SIZE);
+            const MapPoint chunkEnd(std::min<unsigned>(chunkStart.x + CHUNK_SIZE, size_.x),
+                                    std::min<unsigned>(chunkStart.y + CHUNK_SIZE, size_.y));
+
+            // Terrain triangles by texture
+            for(unsigned char t = 0; t < TT_COUNT; ++t)
+            {
+                chunk.textureOffsets[t] = triangleCount;
+                for(MapPoint pt(0, chunkStart.y); pt.y < chunkEnd.y; ++pt.y)
+                {
+                    for(pt.x = chunkStart.x; pt.x < chunkEnd.x; ++pt.x)
+                    {
+                        const unsigned pos = GetVertexIdx(pt);
+                        for(unsigned char triangle = 0; triangle < 2; ++triangle)
+                        {
+                            if(terrain[pos][triangle] == t)
+                                triangleOffsets[pos][triangle] = triangleCount++;
+                        }
+                    }
+                }
+            }
+            chunk.textureOffsets[TT_COUNT] = triangleCount;
+
+            // Border triangles by type (1-based)
+            for(unsigned char borderType = 1; borderType <= NUM_BORDER_TYPES; ++borderType)
+            {
+                chunk.borderOffsets[borderType - 1] = triangleCount;
+                for(MapPoint pt(0, chunkStart.y); pt.y < chunkEnd.y; ++pt.y)
+                {
+                    for(pt.x = chunkStart.x; pt.x < chunkEnd.x; ++pt.x)
+                    {
+                        Borders& curBorders = borders[GetVertexIdx(pt)];
+                        for(unsigned char i = 0; i < 2; ++i)
+                        {
+                            if(curBorders.left_right[i] == borderType)
+                                curBorders.left_right_offset[i] = triangleCount++;
+                            if(curBorders.right_left[i] == borderType)
+                                curBorders.right_left_offset[i] = triangleCount++;
+                            if(curBorders.top_down[i] == borderType)
+                                curBorders.top_down_offset[i] = triangleCount++;
+                        }
+                    }
+                }
+            }
+            chunk.borderOffsets[NUM_BORDER_TYPES] = triangleCount;
+        }
+    }
+}
+
+void TerrainRenderer::MarkChunkDirty(const MapPoint pt, ChunkDirtyFlag flag)
+{
+    if(!vboBuffersUsed)
+        return;
+    const unsigned chunkIdx = GetChunkIdx(pt);
+    if(!chunkDirtyFlags[chunkIdx])
+        dirtyChunks.push_back(chunkIdx);
+    chunkDirtyFlags[chunkIdx] |= flag;
+}
+
+void TerrainRenderer::UploadDirtyChunks() const
+{
+    if(dirtyChunks.empty())
+        return;
+    for(std::vector<unsigned>::const_iterator it = dirtyChunks.begin(); it != dirtyChunks.end(); ++it)
+    {
+        const TerrainChunk& chunk = chunks[*it];
+        const unsigned first = chunk.textureOffsets.front();
+        const unsigned count = chunk.borderOffsets.back() - first;
+        const unsigned char flags = chunkDirtyFlags[*it];
+        chunkDirtyFlags[*it] = 0;
+        if(!count)
+            continue;
+        if(flags & DIRTY_POS)
+        {
+            glBindBufferARB(GL_ARRAY_BUFFER_ARB, vbo_vertices);
+            glBufferSubDataARB(GL_ARRAY_BUFFER_ARB, first * sizeof(Triangle), count * sizeof(Triangle), &gl_vertices[first]);
+        }
+        if(flags & DIRTY_TEXCOORDS)
+        {
+            glBindBufferARB(GL_ARRAY_BUFFER_ARB, vbo_texcoords);
+            glBufferSubDataARB(GL_ARRAY_BUFFER_ARB, first * sizeof(Triangle), count * sizeof(Triangle), &gl_texcoords[first]);
+        }
+        if(flags & DIRTY_COLORS)
+        {
+            glBindBufferARB(GL_ARRAY_BUFFER_ARB, vbo_colors);
+            glBufferSubDataARB(GL_ARRAY_BUFFER_ARB, first * sizeof(ColorTriangle), count * sizeof(ColorTriangle), &gl_colors[first]);
+        }
+    }
+    glBindBufferARB(GL_ARRAY_BUFFER_ARB, 0);
+    dirtyChunks.clear();
+}
+
 void TerrainRenderer::UpdateTrianglePos(const MapPoint pt, bool updateVBO)
 {
-    unsigned pos = GetTriangleIdx(pt);
+    unsigned pos = GetTriangleIdx(pt, 0);
 
     gl_vertices[pos][0] = GetNeighbourPos(pt, 4);
     gl_vertices[pos][1] = GetNodePos(pt);
     gl_vertices[pos][2] = GetNeighbourPos(pt, 5);
 
-    ++pos;
+    pos = GetTriangleIdx(pt, 1);
 
     gl_vertices[pos][0] = GetNodePos(pt);
     gl_vertices[pos][1] = GetNeighbourPos(pt, 4);
     gl_vertices[pos][2] = GetNeighbourPos(pt, 3);
 
-    if(updateVBO && vboBuffersUsed)
-    {
-        glBindBufferARB(GL_ARRAY_BUFFER_ARB, vbo_vertices);
-        glBufferSubDataARB(GL_ARRAY_BUFFER_ARB, (pos - 1) * sizeof(Triangle), 2 * sizeof(Triangle), &gl_vertices[pos - 1]);
-        glBindBufferARB(GL_ARRAY_BUFFER_ARB, 0);
-    }
+    if(updateVBO)
+        MarkChunkDirty(pt, DIRTY_POS);
 }
 
 void TerrainRenderer::UpdateTriangleColor(const MapPoint pt, bool updateVBO)
 {
-    unsigned pos = GetTriangleIdx(pt);
+    unsigned pos = GetTriangleIdx(pt, 0);
 
     Color& clr0 = gl_colors[pos][0];
     Color& clr1 = gl_colors[pos][1];
@@ -305,7 +422,7 @@ void TerrainRenderer::UpdateTriangleColor(const MapPoint pt, bool updateVBO)
     clr1.r = clr1.g = clr1.b = GetColor(pt);
     clr2.r = clr2.g = clr2.b = GetColor(GetNeighbour(pt, Direction::SOUTHWEST));
 
-    ++pos;
+    pos = GetTriangleIdx(pt, 1);
 
     Color& clr3 = gl_colors[pos][0];
     Color& clr4 = gl_colors[pos][1];
@@ -314,12 +431,8 @@ void TerrainRenderer::UpdateTriangleColor(const MapPoint pt, bool updateVBO)
     clr4.r = clr4.g = clr4.b = GetColor(GetNeighbour(pt, Direction::SOUTHEAST));
     clr5.r = clr5.g = clr5.b = GetColor(GetNeighbour(pt, Direction::EAST));
 
-    if(updateVBO && vboBuffersUsed)
-    {
-        glBindBufferARB(GL_ARRAY_BUFFER_ARB, vbo_colors);
-        glBufferSubDataARB(GL_ARRAY_BUFFER_ARB, (pos - 1) * sizeof(ColorTriangle), 2 * sizeof(ColorTriangle), &gl_colors[pos - 1]);
-        glBindBufferARB(GL_ARRAY_BUFFER_ARB, 0);
-    }
+    if(updateVBO)
+        MarkChunkDirty(pt, DIRTY_COLORS);
 }
 
 void TerrainRenderer::UpdateTriangleTerrain(const MapPoint pt, bool updateVBO)
@@ -328,8 +441,7 @@ void TerrainRenderer::UpdateTriangleTerrain(const MapPoint pt, bool updateVBO)
     const TerrainType t1 = TerrainType(terrain[nodeIdx][0]);
     const TerrainType t2 = TerrainType(terrain[nodeIdx][1]);
 
-    const unsigned triangleIdx = GetTriangleIdx(pt);
-    Triangle& texCoord = gl_texcoords[triangleIdx];
+    Triangle& texCoord = gl_texcoords[GetTriangleIdx(pt, 0)];
     if(!TerrainData::IsAnimated(t1))
     {
         texCoord[0].x = 0.45f;
@@ -359,7 +471,7 @@ void TerrainRenderer::UpdateTriangleTerrain(const MapPoint pt, bool updateVBO)
         texCoord[0].y = texCoord[2].y;
     }
 
-    Triangle& texCoord2 = gl_texcoords[triangleIdx + 1];
+    Triangle& texCoord2 = gl_texcoords[GetTriangleIdx(pt, 1)];
     if(!TerrainData::IsAnimated(t2))
     {
         texCoord2[0].x = 0.0f;
@@ -385,12 +497,8 @@ void TerrainRenderer::UpdateTriangleTerrain(const MapPoint pt, bool updateVBO)
         texCoord2[0].y = texCoord2[2].y;
     }
 
-    if(updateVBO && vboBuffersUsed)
-    {
-        glBindBufferARB(GL_ARRAY_BUFFER_ARB, vbo_texcoords);
-        glBufferSubDataARB(GL_ARRAY_BUFFER_ARB, (triangleIdx - 1) * sizeof(Triangle), 2 * sizeof(Triangle), &gl_texcoords[triangleIdx - 1]);
-        glBindBufferARB(GL_ARRAY_BUFFER_ARB, 0);
-    }
+    if(updateVBO)
+        MarkChunkDirty(pt, DIRTY_TEXCOORDS);
 }
 
 /// Erzeugt die Dreiecke für die Ränder
@@ -398,12 +506,6 @@ void TerrainRenderer::UpdateBorderTrianglePos(const MapPoint pt, bool updateVBO)
 {
     unsigned pos = GetVertexIdx(pt);
 
-    // Für VBO-Aktualisierung:
-    // Erzeugte Ränder zählen
-    unsigned count_borders = 0;
-    // Erstes Offset merken
-    unsigned first_offset = 0;
-
     // Rand links - rechts
     for(unsigned char i = 0; i < 2; ++i)
     {
@@ -411,14 +513,9 @@ void TerrainRenderer::UpdateBorderTrianglePos(const MapPoint pt, bool updateVBO)
             continue;
         unsigned offset = borders[pos].left_right_offset[i];
 
-        if(!first_offset)
-            first_offset = offset;
-
         gl_vertices[offset][i ? 0 : 2] = GetNodePos(pt);
         gl_vertices[offset][1] = GetNeighbourPos(pt, 4);
         gl_vertices[offset][i ? 2 : 0] = GetBorderPos(pt, i);
-
-        ++count_borders;
     }
 
     // Rand rechts - links
@@ -428,9 +525,6 @@ void TerrainRenderer::UpdateBorderTrianglePos(const MapPoint pt, bool updateVBO)
             continue;
         unsigned offset = borders[pos].right_left_offset[i];
 
-        if(!first_offset)
-            first_offset = offset;
-
         gl_vertices[offset][i ? 2 : 0] = GetNeighbourPos(pt, 4);
         gl_vertices[offset][1] = GetNeighbourPos(pt, 3);
 
@@ -438,8 +532,6 @@ void TerrainRenderer::UpdateBorderTrianglePos(const MapPoint pt, bool updateVBO)
             gl_vertices[offset][2] = GetBorderPos(pt, 1);
         else
             gl_vertices[offset][0] = GetNeighbourBorderPos(pt, 0, 3);
-
-        ++count_borders;
     }
 
     // Rand oben - unten
@@ -449,9 +541,6 @@ void TerrainRenderer::UpdateBorderTrianglePos(const MapPoint pt, bool updateVBO)
             continue;
         unsigned offset = borders[pos].top_down_offset[i];
 
-        if(!first_offset)
-            first_offset = offset;
-
         gl_vertices[offset][i ? 2 : 0] = GetNeighbourPos(pt, 5);
         gl_vertices[offset][1] = GetNeighbourPos(pt, 4);
 
@@ -459,29 +548,16 @@ void TerrainRenderer::UpdateBorderTrianglePos(const MapPoint pt, bool updateVBO)
             gl_vertices[offset][2] = GetBorderPos(pt, i);
         else
             gl_vertices[offset][0] = GetNeighbourBorderPos(pt, i, 5);
-
-        ++count_borders;
     }
 
-    if(updateVBO && vboBuffersUsed)
-    {
-        glBindBufferARB(GL_ARRAY_BUFFER_ARB, vbo_vertices);
-        glBufferSubDataARB(GL_ARRAY_BUFFER_ARB, first_offset * sizeof(Triangle), count_borders * sizeof(Triangle),
-                           &gl_vertices[first_offset]);
-        glBindBufferARB(GL_ARRAY_BUFFER_ARB, 0);
-    }
+    if(updateVBO)
+        MarkChunkDirty(pt, DIRTY_POS);
 }
 
 void TerrainRenderer::UpdateBorderTriangleColor(const MapPoint pt, bool updateVBO)
 {
     unsigned pos = GetVertexIdx(pt);
 
-    // Für VBO-Aktualisierung:
-    // Erzeugte Ränder zählen
-    unsigned count_borders = 0;
-    // Erstes Offset merken
-    unsigned first_offset = 0;
-
     // Rand links - rechts
     for(unsigned char i = 0; i < 2; ++i)
     {
@@ -489,14 +565,9 @@ void TerrainRenderer::UpdateBorderTriangleColor(const MapPoint pt, bool updateVB
             continue;
         unsigned offset = borders[pos].left_right_offset[i];
 
-        if(!first_offset)
-            first_offset = offset;
-
         gl_colors[offset][i ? 0 : 2].r = gl_colors[offset][i ? 0 : 2].g = gl_colors[offset][i ? 0 : 2].b = GetColor(pt);             //-V807
         gl_colors[offset][1].r = gl_colors[offset][1].g = gl_colors[offset][1].b = GetColor(GetNeighbour(pt, Direction::SOUTHEAST)); //-V807
         gl_colors[offset][i ? 2 : 0].r = gl_colors[offset][i ? 2 : 0].g = gl_colors[offset][i ? 2 : 0].b = GetBorderColor(pt, i);    //-V807
-
-        ++count_borders;
     }
 
     // Rand rechts - links
@@ -506,9 +577,6 @@ void TerrainRenderer::UpdateBorderTriangleColor(const MapPoint pt, bool updateVB
             continue;
         unsigned offset = borders[pos].right_left_offset[i];
 
-        if(!first_offset)
-            first_offset = offset;
-
         gl_colors[offset][i ? 2 : 0].r = gl_colors[offset][i ? 2 : 0].g = gl_colors[offset][i ? 2 : 0].b =
           GetColor(GetNeighbour(pt, Direction::SOUTHEAST));
         gl_colors[offset][1].r = gl_colors[offset][1].g = gl_colors[offset][1].b = GetColor(GetNeighbour(pt, Direction::EAST));
@@ -516,8 +584,6 @@ void TerrainRenderer::UpdateBorderTriangleColor(const MapPoint pt, bool updateVB
         if(pt2.x >= size_.x)
             pt2.x -= size_.x;
         gl_colors[offset][i ? 0 : 2].r = gl_colors[offset][i ? 0 : 2].g = gl_colors[offset][i ? 0 : 2].b = GetBorderColor(pt2, i ? 0 : 1);
-
-        ++count_borders;
     }
 
     // Rand oben - unten
@@ -527,9 +593,6 @@ void TerrainRenderer::UpdateBorderTriangleColor(const MapPoint pt, bool updateVB
             continue;
         unsigned offset = borders[pos].top_down_offset[i];
 
-        if(!first_offset)
-            first_offset = offset;
-
         gl_colors[offset][i ? 2 : 0].r = gl_colors[offset][i ? 2 : 0].g = gl_colors[offset][i ? 2 : 0].b =
           GetColor(GetNeighbour(pt, Direction::SOUTHWEST));
         gl_colors[offset][1].r = gl_colors[offset][1].g = gl_colors[offset][1].b = GetColor(GetNeighbour(pt, Direction::SOUTHEAST));
@@ -539,29 +602,16 @@ void TerrainRenderer::UpdateBorderTriangleColor(const MapPoint pt, bool updateVB
         else
             gl_colors[offset][0].r = gl_colors[offset][0].g = gl_colors[offset][0].b =
               GetBorderColor(GetNeighbour(pt, Direction::SOUTHWEST), i); //-V807
-
-        ++count_borders;
     }
 
-    if(updateVBO && vboBuffersUsed)
-    {
-        glBindBufferARB(GL_ARRAY_BUFFER_ARB, vbo_colors);
-        glBufferSubDataARB(GL_ARRAY_BUFFER_ARB, first_offset * sizeof(ColorTriangle), count_borders * sizeof(ColorTriangle),
-                           &gl_colors[first_offset]);
-        glBindBufferARB(GL_ARRAY_BUFFER_ARB, 0);
-    }
+    if(updateVBO)
+        MarkChunkDirty(pt, DIRTY_COLORS);
 }
 
 void TerrainRenderer::UpdateBorderTriangleTerrain(const MapPoint pt, bool updateVBO)
 {
     unsigned pos = GetVertexIdx(pt);
 
-    // Für VBO-Aktualisierung:
-    // Erzeugte Ränder zählen
-    unsigned count_borders = 0;
-    // Erstes Offset merken
-    unsigned first_offset = 0;
-
     // Rand links - rechts
     for(unsigned char i = 0; i < 2; ++i)
     {
@@ -569,14 +619,9 @@ void TerrainRenderer::UpdateBorderTriangleTerrain(const MapPoint pt, bool update
         {
             unsigned offset = borders[pos].left_right_offset[i];
 
-            if(!first_offset)
-                first_offset = offset;
-
             gl_texcoords[offset][i ? 0 : 2] = PointF(0.0f, 0.0f);
             gl_texcoords[offset][1] = PointF(1.0f, 0.0f);
             gl_texcoords[offset][i ? 2 : 0] = PointF(0.5f, 1.0f);
-
-            ++count_borders;
         }
     }
 
@@ -587,14 +632,9 @@ void TerrainRenderer::UpdateBorderTriangleTerrain(const MapPoint pt, bool update
         {
             unsigned offset = borders[pos].right_left_offset[i];
 
-            if(!first_offset)
-                first_offset = offset;
-
             gl_texcoords[offset][i ? 2 : 0] = PointF(0.0f, 0.0f);
             gl_texcoords[offset][1] = PointF(1.0f, 0.0f);
             gl_texcoords[offset][i ? 0 : 2] = PointF(0.5f, 1.0f);
-
-            ++count_borders;
         }
     }
 
@@ -605,24 +645,14 @@ void TerrainRenderer::UpdateBorderTriangleTerrain(const MapPoint pt, bool update
         {
             unsigned offset = borders[pos].top_down_offset[i];
 
-            if(!first_offset)
-                first_offset = offset;
-
             gl_texcoords[offset][i ? 2 : 0] = PointF(0.0f, 0.0f);
             gl_texcoords[offset][1] = PointF(1.0f, 0.0f);
             gl_texcoords[offset][i ? 0 : 2] = PointF(0.5f, 1.0f);
-
-            ++count_borders;
         }
     }
 
-    if(updateVBO && vboBuffersUsed)
-    {
-        glBindBufferARB(GL_ARRAY_BUFFER_ARB, vbo_texcoords);
-        glBufferSubDataARB(GL_ARRAY_BUFFER_ARB, first_offset * sizeof(Triangle), count_borders * sizeof(Triangle),
-                           &gl_texcoords[first_offset]);
-        glBindBufferARB(GL_ARRAY_BUFFER_ARB, 0);
-    }
+    if(updateVBO)
+        MarkChunkDirty(pt, DIRTY_TEXCOORDS);
 }
 
 /**
@@ -632,106 +662,24 @@ void TerrainRenderer::Draw(const PointI& firstPt, const PointI& lastPt, const Ga
 {
     RTTR_Assert(!gl_vertices.empty());
     RTTR_Assert(!borders.empty());
+    Instrumentation::ScopedTimer timer(INSTR_TERRAIN);
 
-    // nach Texture in Listen sortieren
-    boost::array<std::vector<MapTile>, TT_COUNT> sorted_textures;
-    boost::array<std::vector<BorderTile>, 5> sorted_borders;
-    PreparedRoads sorted_roads;
-
-    Point<int> lastOffset(0, 0);
-
-    // Beim zeichnen immer nur beginnen, wo man auch was sieht
-    for(int y = firstPt.y; y <= lastPt.y; ++y)
-    {
-        unsigned char lastTerrain = 255;
-        unsigned char lastBorder = 255;
-
-        for(int x = firstPt.x; x <= lastPt.x; ++x)
-        {
-            Point<int> posOffset;
-            MapPoint tP = ConvertCoords(Point<int>(x, y), &posOffset);
-
-            unsigned char t = terrain[GetVertexIdx(tP)][0];
-            if(posOffset != lastOffset)
-                lastTerrain = 255;
-
-            if(t == lastTerrain && tP != MapPoint(0, 0))
-                ++sorted_textures[t].back().count;
-            else
-            {
-                MapTile tmp(GetTriangleIdx(tP), posOffset);
-                sorted_textures[t].push_back(tmp);
-                lastTerrain = t;
-            }
-
-            t = terrain[GetVertexIdx(tP)][1];
-
-            if(t == lastTerrain)
-                ++sorted_textures[t].back().count;
-            else
-            {
-                MapTile tmp(GetTriangleIdx(tP) + 1, posOffset);
-                sorted_textures[t].push_back(tmp);
-            }
-
-            lastTerrain = t;
-
-            const Borders& curBorders = borders[GetVertexIdx(tP)];
-            boost::array<unsigned char, 6> tiles = {{curBorders.left_right[0], curBorders.left_right[1], curBorders.right_left[0],
-                                                     curBorders.right_left[1], curBorders.top_down[0], curBorders.top_down[1]}};
-
-            // Offsets into gl_* arrays
-            boost::array<unsigned, 6> offsets = {{curBorders.left_right_offset[0], curBorders.left_right_offset[1],
-                                                  curBorders.right_left_offset[0], curBorders.right_left_offset[1],
-                                                  curBorders.top_down_offset[0], curBorders.top_down_offset[1]}};
-
-            for(unsigned char i = 0; i < 6; ++i)
-            {
-                if(!tiles[i])
-                    continue;
-                if(tiles[i] == lastBorder)
-                {
-                    BorderTile& curTile = sorted_borders[lastBorder - 1].back();
-                    // Check that we did not wrap around the map and the expected offset matches
-                    if(curTile.tileOffset + curTile.count == offsets[i])
-                    {
-                        ++curTile.count;
-                        continue;
-                    }
-                }
-                lastBorder = tiles[i];
-                BorderTile tmp(offsets[i], posOffset);
-                sorted_borders[lastBorder - 1].push_back(tmp);
-            }
-
-            PrepareWaysPoint(sorted_roads, gwv, tP, posOffset);
-
-            lastOffset = posOffset;
-        }
-    }
+    SPRITEBATCH.Flush();
+    PrepareDraw(firstPt, lastPt, gwv);
+    UploadDirtyChunks();
+    const std::vector<VisibleChunk>& visibleChunks = drawBatches.visibleChunks;
 
     if(water)
     {
-        unsigned water_count = 0;
-
-        for(unsigned char t = 0; t < TT_COUNT; ++t)
-        {
-            if(!TerrainData::IsWater(TerrainType(t)))
-                continue;
-            for(std::vector<MapTile>::iterator it = sorted_textures[t].begin(); it != sorted_textures[t].end(); ++it)
-            {
-                water_count += it->count;
-            }
-        }
-
         PointI diff = lastPt - firstPt;
         if(diff.x && diff.y)
-            *water = 50 * water_count / (diff.x * diff.y);
+            *water = 50 * drawBatches.waterCount / (diff.x * diff.y);
         else
             *water = 0;
     }
 
-    lastOffset = PointI(0, 0);
+    PointI lastOffset(0, 0);
+    const std::vector<VisibleChunk>::const_iterator itChunksEnd = visibleChunks.end();
 
     // Arrays aktivieren
     glEnableClientState(GL_COLOR_ARRAY);
@@ -763,7 +711,10 @@ void TerrainRenderer::Draw(const PointI& firstPt, const PointI& lastPt, const Ga
     glPushMatrix();
     for(unsigned char t = 0; t < TT_COUNT; ++t)
     {
-        if(sorted_textures[t].empty())
+        bool isUsed = false;
+        for(std::vector<VisibleChunk>::const_iterator it = visibleChunks.begin(); it != itChunksEnd && !isUsed; ++it)
+            isUsed = chunks[it->chunkIdx].textureOffsets[t + 1] != chunks[it->chunkIdx].textureOffsets[t];
+        if(!isUsed)
             continue;
         unsigned animationFrame;
         TerrainType tt = TerrainType(t);
@@ -776,8 +727,12 @@ void TerrainRenderer::Draw(const PointI& firstPt, const PointI& lastPt, const Ga
 
         VIDEODRIVER.BindTexture(LOADER.GetTerrainTexture(tt, animationFrame).GetTexture());
 
-        for(std::vector<MapTile>::iterator it = sorted_textures[t].begin(); it != sorted_textures[t].end(); ++it)
+        for(std::vector<VisibleChunk>::const_iterator it = visibleChunks.begin(); it != itChunksEnd; ++it)
         {
+            const TerrainChunk& chunk = chunks[it->chunkIdx];
+            const unsigned count = chunk.textureOffsets[t + 1] - chunk.textureOffsets[t];
+            if(!count)
+                continue;
             if(it->posOffset != lastOffset)
             {
                 PointI trans = it->posOffset - lastOffset;
@@ -785,8 +740,9 @@ void TerrainRenderer::Draw(const PointI& firstPt, const PointI& lastPt, const Ga
                 lastOffset = it->posOffset;
             }
 
-            RTTR_Assert(it->tileOffset + it->count <= size_.x * size_.y * 2u);
-            glDrawArrays(GL_TRIANGLES, it->tileOffset * 3, it->count * 3); // Arguments are in Elements. 1 triangle has 3 values
+            RTTR_Assert(chunk.textureOffsets[t] + count <= gl_vertices.size());
+            glDrawArrays(GL_TRIANGLES, chunk.textureOffsets[t] * 3, count * 3); // Arguments are in Elements. 1 triangle has 3 values
+            timer.AddCount(count);
         }
     }
     glPopMatrix();
@@ -795,22 +751,28 @@ void TerrainRenderer::Draw(const PointI& firstPt, const PointI& lastPt, const Ga
 
     lastOffset = PointI(0, 0);
     glPushMatrix();
-    for(unsigned short i = 0; i < 5; ++i)
+    for(unsigned short i = 0; i < NUM_BORDER_TYPES; ++i)
     {
-        if(sorted_borders[i].empty())
-            continue;
-        VIDEODRIVER.BindTexture(dynamic_cast<glArchivItem_Bitmap*>(LOADER.borders.get(i))->GetTexture());
-
-        for(std::vector<BorderTile>::iterator it = sorted_borders[i].begin(); it != sorted_borders[i].end(); ++it)
+        bool isTextureBound = false;
+        for(std::vector<VisibleChunk>::const_iterator it = visibleChunks.begin(); it != itChunksEnd; ++it)
         {
+            const TerrainChunk& chunk = chunks[it->chunkIdx];
+            const unsigned count = chunk.borderOffsets[i + 1] - chunk.borderOffsets[i];
+            if(!count)
+                continue;
+            if(!isTextureBound)
+            {
+                VIDEODRIVER.BindTexture(dynamic_cast<glArchivItem_Bitmap*>(LOADER.borders.get(i))->GetTexture());
+                isTextureBound = true;
+            }
             if(it->posOffset != lastOffset)
             {
                 PointI trans = it->posOffset - lastOffset;
                 glTranslatef(float(trans.x), float(trans.y), 0.0f);
                 lastOffset = it->posOffset;
             }
-            RTTR_Assert(it->tileOffset + it->count <= gl_vertices.size());
-            glDrawArrays(GL_TRIANGLES, it->tileOffset * 3, it->count * 3); // Arguments are in Elements. 1 triangle has 3 values
+            RTTR_Assert(chunk.borderOffsets[i] + count <= gl_vertices.size());
+            glDrawArrays(GL_TRIANGLES, chunk.borderOffsets[i] * 3, count * 3); // Arguments are in Elements. 1 triangle has 3 values
         }
     }
     glPopMatrix();
@@ -819,13 +781,133 @@ void TerrainRenderer::Draw(const PointI& firstPt, const PointI& lastPt, const Ga
     if(vboBuffersUsed)
         glBindBufferARB(GL_ARRAY_BUFFER_ARB, 0);
 
-    DrawWays(sorted_roads);
+    DrawWays(drawBatches.sorted_roads);
 
     glDisableClientState(GL_COLOR_ARRAY);
     // Wieder zurück ins normale modulate
     glTexEnvi(GL_TEXTURE_ENV, GL_TEXTURE_ENV_MODE, GL_MODULATE);
 }
 
+void TerrainRenderer::PrepareDraw(const PointI& firstPt, const PointI& lastPt, const GameWorldViewer& gwv) const
+{
+    if(drawBatches.isValid && drawBatches.firstPt == firstPt && drawBatches.lastPt == lastPt)
+    {
+        // The visible chunks only depend on the area
+        if(!drawBatches.areRoadsValid)
+            PrepareRoads(gwv);
+        return;
+    }
+
+    // Cull the chunks: Use only those intersecting the area.
+    // The area can span multiple copies of the map (wrap around), so check the part of the area in each copy
+    std::vector<VisibleChunk>& visibleChunks = drawBatches.visibleChunks;
+    visibleChunks.clear();
+    PointI firstOffset, lastOffset;
+    const MapPoint firstMapPt = ConvertCoords(firstPt, &firstOffset);
+    const MapPoint lastMapPt = ConvertCoords(lastPt, &lastOffset);
+    const PointI mapSize(size_.x * TR_W, size_.y * TR_H);
+    for(int offsetY = firstOffset.y; offsetY <= lastOffset.y; offsetY += mapSize.y)
+    {
+        const unsigned firstY = (offsetY == firstOffset.y) ? firstMapPt.y : 0;
+        const unsigned lastY = (offsetY == lastOffset.y) ? lastMapPt.y : size_.y - 1;
+        for(int offsetX = firstOffset.x; offsetX <= lastOffset.x; offsetX += mapSize.x)
+        {
+            const unsigned firstX = (offsetX == firstOffset.x) ? firstMapPt.x : 0;
+            const unsigned lastX = (offsetX == lastOffset.x) ? lastMapPt.x : size_.x - 1;
+            for(unsigned cy = firstY / CHUNK_SIZE; cy <= lastY / CHUNK_SIZE; ++cy)
+            {
+                for(unsigned cx = firstX / CHUNK_SIZE; cx <= lastX / CHUNK_SIZE; ++cx)
+                    visibleChunks.push_back(VisibleChunk(cy * numChunks_.x + cx, PointI(offsetX, offsetY)));
+            }
+        }
+    }
+
+    // Water is only counted in the area, not the whole chunks
+    drawBatches.waterCount = 0;
+    for(int y = firstPt.y; y <= lastPt.y; ++y)
+    {
+        for(int x = firstPt.x; x <= lastPt.x; ++x)
+        {
+            const unsigned pos = GetVertexIdx(ConvertCoords(PointI(x, y)));
+            for(unsigned char triangle = 0; triangle < 2; ++triangle)
+            {
+                if(TerrainData::IsWater(TerrainType(terrain[pos][triangle])))
+                    ++drawBatches.waterCount;
+            }
+        }
+    }
+
+    drawBatches.firstPt = firstPt;
+    drawBatches.lastPt = lastPt;
+    drawBatches.isValid = true;
+    PrepareRoads(gwv);
+}
+
+void TerrainRenderer::PrepareRoads(const GameWorldViewer& gwv) const
+{
+    for(PreparedRoads::iterator it = drawBatches.sorted_roads.begin(); it != drawBatches.sorted_roads.end(); ++it)
+        it->clear();
+
+    for(int y = drawBatches.firstPt.y; y <= drawBatches.lastPt.y; ++y)
+    {
+        for(int x = drawBatches.firstPt.x; x <= drawBatches.lastPt.x; ++x)
+        {
+            Point<int> posOffset;
+            MapPoint tP = ConvertCoords(Point<int>(x, y), &posOffset);
+            PrepareWaysPoint(drawBatches.sorted_roads, gwv, tP, posOffset);
+        }
+    }
+    drawBatches.areRoadsValid = true;
+}
+
+unsigned TerrainRenderer::GetNumPreparedBatches() const
+{
+    unsigned numBatches = 0;
+    for(std::vector<VisibleChunk>::const_iterator it = drawBatches.visibleChunks.begin(); it != drawBatches.visibleChunks.end(); ++it)
+    {
+        const TerrainChunk& chunk = chunks[it->chunkIdx];
+        for(unsigned char t = 0; t < TT_COUNT; ++t)
+        {
+            if(chunk.textureOffsets[t + 1] != chunk.textureOffsets[t])
+                ++numBatches;
+        }
+        for(unsigned char i = 0; i < NUM_BORDER_TYPES; ++i)
+        {
+            if(chunk.borderOffsets[i + 1] != chunk.borderOffsets[i])
+                ++numBatches;
+        }
+    }
+    return numBatches;
+}
+
+unsigned TerrainRenderer::GetNumPreparedRoads() const
+{
+    unsigned numRoads = 0;
+    for(PreparedRoads::const_iterator it = drawBatches.sorted_roads.begin(); it != drawBatches.sorted_roads.end(); ++it)
+        numRoads += it->size();
+    return numRoads;
+}
+
+bool TerrainRenderer::IsInPreparedArea(const MapPoint pt) const
+{
+    if(!drawBatches.isValid)
+        return false;
+    // Changes of a node also affect the roads and colors of its neighbours, so add a small margin
+    const PointI margin(2, 2);
+    const PointI first = drawBatches.firstPt - margin;
+    const PointI areaSize = drawBatches.lastPt + margin - first;
+    // Distance to the first point in positive direction (the map wraps around)
+    const int dx = ((static_cast<int>(pt.x) - first.x) % size_.x + size_.x) % size_.x;
+    const int dy = ((static_cast<int>(pt.y) - first.y) % size_.y + size_.y) % size_.y;
+    return dx <= areaSize.x && dy <= areaSize.y;
+}
+
+void TerrainRenderer::RoadChanged(const MapPoint pt)
+{
+    if(IsInPreparedArea(pt))
+        drawBatches.areRoadsValid = false;
+}
+
 MapPoint TerrainRenderer::ConvertCoords(const PointI pt, PointI* offset) const
 {
     if(offset)
@@ -1002,6 +1084,9 @@ void TerrainRenderer::DrawWays(const PreparedRoads& sorted_roads) const
 
 void TerrainRenderer::AltitudeChanged(const MapPoint pt, const GameWorldViewer& gwv)
 {
+    // Positions and colors of the roads change
+    RoadChanged(pt);
+
     // den selbst sowieso die Punkte darum updaten, da sich bei letzteren die Schattierung geändert haben könnte
     UpdateVertexPos(pt, gwv);
     UpdateVertexColor(pt, gwv);
@@ -1050,6 +1135,9 @@ void TerrainRenderer::VisibilityChanged(const MapPoint pt, const GameWorldViewer
     if(vertices.empty())
         return;
 
+    // Visible roads and their colors change
+    RoadChanged(pt);
+
     UpdateVertexColor(pt, gwv);
     for(unsigned i = 0; i < 6; ++i)
         UpdateVertexColor(gwv.GetNeighbour(pt, Direction::fromInt(i)), gwv);
@@ -1072,6 +1160,8 @@ void TerrainRenderer::VisibilityChanged(const MapPoint pt, const GameWorldViewer
 
 void TerrainRenderer::UpdateAllColors(const GameWorldViewer& gwv)
 {
+    drawBatches.areRoadsValid = false;
+
     for(MapCoord y = 0; y < size_.y; ++y)
         for(MapCoord x = 0; x < size_.x; ++x)
             UpdateVertexColor(MapPoint(x, y), gwv);
@@ -19,7 +19,9 @@
 
 #include "Point.h"
 #include "gameTypes/MapCoordinates.h"
+#include "gameTypes/MapTypes.h"
 #include <boost/array.hpp>
+#include <boost/config.hpp>
 #include <boost/noncopyable.hpp>
 #include <vector>
 
@@ -43,6 +45,13 @@ public:
 
     /// Draws the map between the given points. Optionally returns percentage of water drawn
     void Draw(const PointI& firstPt, const PointI& lastPt, const GameWorldViewer& gwv, unsigned* water) const;
+    /// Prepares the batches (textures, borders, roads) for drawing the map between the given points.
+    /// The batches of the last call are reused if the area did not change and nothing in it was invalidated
+    void PrepareDraw(const PointI& firstPt, const PointI& lastPt, const GameWorldViewer& gwv) const;
+    /// Return the number of draw calls for the terrain and borders of the prepared area
+    unsigned GetNumPreparedBatches() const;
+    /// Return the number of road segments in the prepared area
+    unsigned GetNumPreparedRoads() const;
 
     /// Converts given point into a MapPoint (0 <= x < width and 0 <= y < height)
     /// Optionally returns offset of returned point to original point in pixels (for drawing)
@@ -56,25 +65,43 @@ public:
     void AltitudeChanged(const MapPoint pt, const GameWorldViewer& gwv);
     /// Callback function for visibility changes
     void VisibilityChanged(const MapPoint pt, const GameWorldViewer& gwv);
+    /// Callback function for (visible) road changes
+    void RoadChanged(const MapPoint pt);
 
     /// Recalculates all colors on the map
     void UpdateAllColors(const GameWorldViewer& gwv);
 
+    /// Size (width and height in nodes) of the chunks the terrain is drawn in
+    BOOST_STATIC_CONSTEXPR unsigned short CHUNK_SIZE = 32;
+
 private:
-    struct MapTile
+    /// Number of different border textures
+    BOOST_STATIC_CONSTEXPR unsigned char NUM_BORDER_TYPES = 5;
+
+    /// Part of the map with CHUNK_SIZE x CHUNK_SIZE nodes. All its triangles are consecutive in the gl_* arrays
+    /// and sorted by texture, so each texture (and border type) can be drawn with one call per chunk
+    struct TerrainChunk
     {
-        unsigned tileOffset;
-        unsigned count;
-        PointI posOffset;
-        MapTile(unsigned tileOffset, PointI posOffset) : tileOffset(tileOffset), count(1), posOffset(posOffset) {}
+        /// Index of the first triangle of each texture and of the first border triangle (at TT_COUNT)
+        boost::array<unsigned, TT_COUNT + 1> textureOffsets;
+        /// Index of the first triangle of each border type and of the first triangle after the chunk
+        boost::array<unsigned, NUM_BORDER_TYPES + 1> borderOffsets;
+    };
+
+    /// Flags for the parts of a chunk that need to be uploaded to the VBOs
+    enum ChunkDirtyFlag
+    {
+        DIRTY_POS = 1,
+        DIRTY_TEXCOORDS = 2,
+        DIRTY_COLORS = 4
     };
 
-    struct BorderTile
+    struct VisibleChunk
     {
-        unsigned tileOffset;
-        unsigned count;
+        unsigned chunkIdx;
+        /// Offset for drawing (the map may be drawn multiple times when the view wraps around)
         PointI posOffset;
-        BorderTile(unsigned tileOffset, PointI posOffset) : tileOffset(tileOffset), count(1), posOffset(posOffset) {}
+        VisibleChunk(unsigned chunkIdx, PointI posOffset) : chunkIdx(chunkIdx), posOffset(posOffset) {}
     };
 
     struct PreparedRoad
@@ -126,6 +153,15 @@ private:
     std::vector<Vertex> vertices;
     /// Map sized array with terrain indices/textures (bottom, bottom right of node)
     std::vector<boost::array<unsigned char, 2> > terrain;
+    /// Map sized array with the indices of the 2 triangles of each node into the gl_* arrays
+    std::vector<boost::array<unsigned, 2> > triangleOffsets;
+    /// Number of chunks in x and y
+    MapExtent numChunks_;
+    std::vector<TerrainChunk> chunks;
+    /// Chunks changed since the last upload to the VBOs with their ChunkDirtyFlags
+    /// (Uploaded when drawing, so all changes of a frame are combined)
+    mutable std::vector<unsigned> dirtyChunks;
+    mutable std::vector<unsigned char> chunkDirtyFlags;
 
     std::vector<Triangle> gl_vertices;
     std::vector<Triangle> gl_texcoords;
@@ -140,13 +176,36 @@ private:
 
     typedef boost::array<std::vector<PreparedRoad>, 4> PreparedRoads;
 
+    /// Batches of the last prepared area
+    struct DrawBatches
+    {
+        PointI firstPt, lastPt;
+        /// Chunks intersecting the area
+        std::vector<VisibleChunk> visibleChunks;
+        PreparedRoads sorted_roads;
+        /// Number of water triangles in the area
+        unsigned waterCount;
+        /// False if the area has to be prepared again (chunks and roads)
+        bool isValid;
+        /// False if only the roads have to be prepared again (changed roads, visibility or altitude)
+        bool areRoadsValid;
+        DrawBatches() : waterCount(0), isValid(false), areRoadsValid(false) {}
+    };
+    /// Only a cache, so it is updated when drawing
+    mutable DrawBatches drawBatches;
+
     /// Returns the index of a vertex. Used to access vertices and borders
     unsigned GetVertexIdx(const MapPoint pt) const
     {
         return static_cast<unsigned>(pt.y) * static_cast<unsigned>(size_.x) + static_cast<unsigned>(pt.x);
     }
-    /// Returns the index of the first triangle (each point has 2). Used to access gl_* structs
-    unsigned GetTriangleIdx(const MapPoint pt) const { return GetVertexIdx(pt) * 2; }
+    /// Returns the index of one of the 2 triangles of a point. Used to access gl_* structs
+    unsigned GetTriangleIdx(const MapPoint pt, unsigned char triangle) const { return triangleOffsets[GetVertexIdx(pt)][triangle]; }
+    /// Returns the index of the chunk containing the point
+    unsigned GetChunkIdx(const MapPoint pt) const
+    {
+        return static_cast<unsigned>(pt.y / CHUNK_SIZE) * static_cast<unsigned>(numChunks_.x) + pt.x / CHUNK_SIZE;
+    }
     /// Return the coordinates of the neighbour node
     inline MapPoint GetNeighbour(const MapPoint& pt, const Direction dir) const;
 
@@ -162,8 +221,14 @@ private:
     void UpdateVertexTerrain(const MapPoint pt, const GameWorldViewer& gwv);
     /// Update (map-)border vertex attributes
     void UpdateBorderVertex(const MapPoint pt);
+    /// Divides the map into chunks and assigns the triangles of each node to them
+    void GenerateChunks();
+    /// Marks parts of the chunk containing the point for uploading to the VBOs
+    void MarkChunkDirty(const MapPoint pt, ChunkDirtyFlag flag);
+    /// Uploads the changed chunks to the VBOs
+    void UploadDirtyChunks() const;
 
-    /// Fills OGL vertex data from map vertex data (updateVBO = true updates also VBO if used)
+    /// Fills OGL vertex data from map vertex data (updateVBO = true marks the chunk for the upload to the VBO if used)
     void UpdateTrianglePos(const MapPoint pt, bool updateVBO);
     void UpdateTriangleColor(const MapPoint pt, bool updateVBO);
     void UpdateTriangleTerrain(const MapPoint pt, bool updateVBO);
@@ -181,6 +246,10 @@ private:
     /// liefert den Rand-Vertex-Farbwert an der Stelle X,Y
     float GetBorderColor(const MapPoint pt, unsigned char triangle) const { return GetVertex(pt).borderColor[triangle]; }
 
+    /// Prepare the roads of the area of the draw batches
+    void PrepareRoads(const GameWorldViewer& gwv) const;
+    /// Return true if changes at the given point may affect the prepared area
+    bool IsInPreparedArea(const MapPoint pt) const;
     /// Adds possible roads from the given point to the prepared data struct
     void PrepareWaysPoint(PreparedRoads& sorted_roads, const GameWorldViewer& gwViewer, MapPoint pt, const PointI& offset) const;
     /// Draw the prepared roads
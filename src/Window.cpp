@@ -25,6 +25,8 @@
 #include "driver/src/MouseCoords.h"
 #include "drivers/ScreenResizeEvent.h"
 #include "drivers/VideoDriverWrapper.h"
+#include "WindowManager.h"
+#include "ogl/glSpriteBatch.h"
 #include <boost/foreach.hpp>
 #include <boost/range/adaptor/map.hpp>
 #include <cstdarg>
@@ -152,6 +154,31 @@ void Window::SetActive(bool activate)
 {
     this->active_ = activate;
     ActivateControls(activate);
+    Invalidate();
+}
+
+void Window::SetVisible(bool visible)
+{
+    if(visible_ != visible)
+        Invalidate();
+    this->visible_ = visible;
+}
+
+bool Window::HasActiveAnimations() const
+{
+    if(animations_.getNumActiveAnimations() > 0u)
+        return true;
+    for(ControlMap::const_iterator it = childIdToWnd_.begin(); it != childIdToWnd_.end(); ++it)
+    {
+        if(it->second->HasActiveAnimations())
+            return true;
+    }
+    return false;
+}
+
+void Window::Invalidate()
+{
+    WINDOWMANAGER.Invalidate();
 }
 
 /**
@@ -195,6 +222,8 @@ void Window::FreeRegion(Window* window)
 
 void Window::SetPos(const DrawPoint& newPos)
 {
+    if(pos_ != newPos)
+        Invalidate();
     pos_ = newPos;
 }
 
@@ -214,6 +243,7 @@ void Window::DeleteCtrl(unsigned id)
     delete it->second;
 
     childIdToWnd_.erase(it);
+    Invalidate();
 }
 
 ctrlBuildingIcon* Window::AddBuildingIcon(unsigned id, const DrawPoint& pos, BuildingType type, const Nation nation, unsigned short size,
@@ -468,6 +498,7 @@ void Window::Draw3D(const Rect& rect, TextureColor tc, unsigned short type, bool
     borderImg->DrawPart(Rect(vertImgBorderPos, Extent(2, rect.getSize().y)));
 
     // Draw black borders over the img borders
+    SPRITEBATCH.Flush();
     glDisable(GL_TEXTURE_2D);
     glColor3f(0.0f, 0.0f, 0.0f);
     glBegin(GL_TRIANGLE_STRIP);
@@ -501,6 +532,7 @@ void Window::Draw3D(const Rect& rect, TextureColor tc, unsigned short type, bool
     if(illuminated)
     {
         // Modulate2x anmachen
+        SPRITEBATCH.Flush();
         glTexEnvi(GL_TEXTURE_ENV, GL_TEXTURE_ENV_MODE, GL_COMBINE_EXT);
         glTexEnvf(GL_TEXTURE_ENV, GL_RGB_SCALE_EXT, 2.0f);
     }
@@ -519,6 +551,7 @@ void Window::Draw3D(const Rect& rect, TextureColor tc, unsigned short type, bool
     if(illuminated)
     {
         // Modulate2x wieder ausmachen
+        SPRITEBATCH.Flush();
         glTexEnvi(GL_TEXTURE_ENV, GL_TEXTURE_ENV_MODE, GL_MODULATE);
     }
 }
@@ -529,6 +562,7 @@ void Window::Draw3D(const Rect& rect, TextureColor tc, unsigned short type, bool
  */
 void Window::DrawRectangle(const Rect& rect, unsigned color)
 {
+    SPRITEBATCH.Flush();
     glDisable(GL_TEXTURE_2D);
 
     glColor4ub(GetRed(color), GetGreen(color), GetBlue(color), GetAlpha(color));
@@ -550,6 +584,7 @@ void Window::DrawRectangle(const Rect& rect, unsigned color)
  */
 void Window::DrawLine(DrawPoint pt1, DrawPoint pt2, unsigned short width, unsigned color)
 {
+    SPRITEBATCH.Flush();
     glDisable(GL_TEXTURE_2D);
     glColor4ub(GetRed(color), GetGreen(color), GetBlue(color), GetAlpha(color));
 
@@ -107,7 +107,7 @@ public:
     void SetPos(const DrawPoint& newPos);
 
     // macht das Fenster sichtbar oder blendet es aus
-    virtual void SetVisible(bool visible) { this->visible_ = visible; }
+    virtual void SetVisible(bool visible);
     /// Ist das Fenster sichtbar?
     bool IsVisible() const { return visible_; }
     /// Ist das Fenster aktiv?
@@ -132,6 +132,10 @@ public:
     void DeleteCtrl(unsigned id);
 
     AnimationManager& GetAnimationManager() { return animations_; }
+    /// Return true if this window or any of its controls is animated
+    bool HasActiveAnimations() const;
+    /// Mark the UI as changed so it gets redrawn (see WindowManager::NeedsRedraw)
+    static void Invalidate();
 
     ctrlBuildingIcon* AddBuildingIcon(unsigned id, const DrawPoint& pos, BuildingType type, const Nation nation, unsigned short size = 36,
                                       const std::string& tooltip_ = "");
@@ -28,13 +28,18 @@
 #include "ingameWindows/IngameWindow.h"
 #include "ogl/SoundEffectItem.h"
 #include "ogl/glArchivItem_Font.h"
+#include "ogl/glSpriteBatch.h"
 #include "gameData/const_gui_ids.h"
 #include "libutil/src/Log.h"
 #include <boost/foreach.hpp>
 #include <algorithm>
 
+/// Maximum time between 2 redraws of an unchanged UI in ms
+static const unsigned MAX_UNCHANGED_FRAME_TIME = 250;
+
 WindowManager::WindowManager()
-    : disable_mouse(false), lastMousePos(Point<int>::Invalid()), screenSize(0, 0), lastLeftClickTime(0), lastLeftClickPos(0, 0)
+    : disable_mouse(false), lastMousePos(Point<int>::Invalid()), screenSize(0, 0), lastLeftClickTime(0), lastLeftClickPos(0, 0),
+      needsRedraw_(true), lastDrawTime_(0), isRedrawScheduled_(false), scheduledRedrawTime_(0)
 {
 }
 
@@ -67,6 +72,14 @@ void WindowManager::Draw()
     if(!curDesktop)
         return;
 
+    // Changes made while drawing (e.g. by timers) are shown in this frame already
+    needsRedraw_ = false;
+    isRedrawScheduled_ = false;
+    lastDrawTime_ = VIDEODRIVER.GetTickCount();
+
+    // Draw all images and texts of the frame with as few draw calls as possible
+    SPRITEBATCH.Begin();
+
     // ja, Msg_PaintBefore aufrufen
     curDesktop->Msg_PaintBefore();
 
@@ -90,6 +103,33 @@ void WindowManager::Draw()
 
     // Msg_PaintAfter aufrufen
     curDesktop->Msg_PaintAfter();
+
+    SPRITEBATCH.End();
+}
+
+void WindowManager::ScheduleRedraw(unsigned time)
+{
+    if(!isRedrawScheduled_ || static_cast<int>(time - scheduledRedrawTime_) < 0)
+        scheduledRedrawTime_ = time;
+    isRedrawScheduled_ = true;
+}
+
+bool WindowManager::NeedsRedraw(unsigned curTime) const
+{
+    if(needsRedraw_ || nextdesktop || !curDesktop)
+        return true;
+    if(curTime - lastDrawTime_ >= MAX_UNCHANGED_FRAME_TIME)
+        return true;
+    if(isRedrawScheduled_ && static_cast<int>(curTime - scheduledRedrawTime_) >= 0)
+        return true;
+    if(curDesktop->HasActiveAnimations())
+        return true;
+    BOOST_FOREACH(const IngameWindow* wnd, windows)
+    {
+        if(wnd->HasActiveAnimations())
+            return true;
+    }
+    return false;
 }
 
 /**
@@ -181,6 +221,7 @@ void WindowManager::Show(IngameWindow* window, bool mouse)
 {
     RTTR_Assert(window);
     SetToolTip(NULL, "");
+    Invalidate();
 
     // haben wir ein gültiges Fenster erhalten?
     if(!window)
@@ -281,6 +322,7 @@ IngameWindow* WindowManager::FindWindowUnderMouse(const MouseCoords& mc) const
  */
 void WindowManager::Msg_LeftDown(MouseCoords mc)
 {
+    Invalidate();
     // ist unser Desktop gültig?
     if(!curDesktop)
         return;
@@ -387,6 +429,7 @@ void WindowManager::Msg_LeftDown(MouseCoords mc)
  */
 void WindowManager::Msg_LeftUp(MouseCoords mc)
 {
+    Invalidate();
     // ist unser Desktop gültig?
     if(!curDesktop)
         return;
@@ -439,6 +482,7 @@ void WindowManager::Msg_LeftUp(MouseCoords mc)
  */
 void WindowManager::Msg_RightDown(const MouseCoords& mc)
 {
+    Invalidate();
     // ist unser Desktop gültig?
     if(!curDesktop)
         return;
@@ -509,6 +553,7 @@ void WindowManager::Msg_RightDown(const MouseCoords& mc)
 
 void WindowManager::Msg_RightUp(const MouseCoords& mc)
 {
+    Invalidate();
     RelayMouseMessage(&Window::Msg_RightUp, mc);
 }
 
@@ -519,6 +564,7 @@ void WindowManager::Msg_RightUp(const MouseCoords& mc)
  */
 void WindowManager::Msg_WheelUp(const MouseCoords& mc)
 {
+    Invalidate();
     // ist unser Desktop gültig?
     if(!curDesktop)
         return;
@@ -595,6 +641,7 @@ void WindowManager::Msg_WheelUp(const MouseCoords& mc)
  */
 void WindowManager::Msg_WheelDown(const MouseCoords& mc)
 {
+    Invalidate();
     if(!curDesktop)
         return;
     if(windows.empty())
@@ -639,6 +686,7 @@ void WindowManager::Msg_WheelDown(const MouseCoords& mc)
  */
 void WindowManager::Msg_MouseMove(const MouseCoords& mc)
 {
+    Invalidate();
     lastMousePos = Point<int>(mc.x, mc.y);
 
     // ist unser Desktop gültig?
@@ -669,6 +717,7 @@ void WindowManager::Msg_MouseMove(const MouseCoords& mc)
 
 void WindowManager::Msg_KeyDown(const KeyEvent& ke)
 {
+    Invalidate();
     if(ke.alt && (ke.kt == KT_RETURN))
     {
 // Switch Fullscreen/Windowed
@@ -709,6 +758,7 @@ void WindowManager::ScreenResized(unsigned short newWidth, unsigned short newHei
  */
 void WindowManager::Msg_ScreenResize(const Extent& newSize)
 {
+    Invalidate();
     // Falls sich nichts ändert, brauchen wir auch nicht reagieren
     // (Evtl hat sich ja nur der Modus Fenster/Vollbild geändert)
     if(newSize == screenSize)
@@ -769,6 +819,7 @@ void WindowManager::Close(const IngameWindow* window)
         return; // Window already closed -> Out
 
     SetToolTip(NULL, "");
+    Invalidate();
 
     // War es an vorderster Stelle?
     if(window == windows.back())
@@ -863,7 +914,11 @@ void WindowManager::SetToolTip(const ctrlBaseTooltip* ttw, const std::string& to
     static const ctrlBaseTooltip* lttw = NULL;
 
     if(tooltip.empty() && (!ttw || lttw == ttw))
+    {
+        if(!curTooltip.empty())
+            Invalidate();
         this->curTooltip.clear();
+    }
     else if(!tooltip.empty())
     {
         glArchivItem_Font::WrapInfo wi = NormalFont->GetWrapInfo(tooltip, MAX_TOOLTIP_WIDTH, MAX_TOOLTIP_WIDTH);
@@ -876,6 +931,7 @@ void WindowManager::SetToolTip(const ctrlBaseTooltip* ttw, const std::string& to
             curTooltip += *it;
         }
         lttw = ttw;
+        Invalidate();
     }
 }
 
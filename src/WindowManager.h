@@ -95,6 +95,15 @@ public:
     /// Return the window currently on the top (probably active)
     const Window* GetTopMostWindow() const;
 
+    /// Mark the UI as changed so it is redrawn in the next frame
+    void Invalidate() { needsRedraw_ = true; }
+    /// Request a redraw at the given time (e.g. for a timer)
+    void ScheduleRedraw(unsigned time);
+    /// Return true if the UI might have changed since the last Draw, so a frame must be drawn.
+    /// Changes are detected by input, window (de)activation and movement, text changes, animations and scheduled redraws.
+    /// As not every change marks the UI (e.g. variable texts) it is also redrawn after some time.
+    bool NeedsRedraw(unsigned curTime) const;
+
 protected:
     void DrawToolTip();
     IngameWindow* FindWindowUnderMouse(const MouseCoords& mc) const;
@@ -123,6 +132,12 @@ private:
     // Für Doppelklick merken:
     unsigned lastLeftClickTime;  /// Zeit des letzten Links-Klicks
     Point<int> lastLeftClickPos; /// Position beim letzten Links-Klick
+
+    bool needsRedraw_;
+    /// Time of the last Draw
+    unsigned lastDrawTime_;
+    bool isRedrawScheduled_;
+    unsigned scheduledRedrawTime_;
 };
 
 #define WINDOWMANAGER WindowManager::inst()
@@ -86,7 +86,9 @@ int AIInterface::GetResourceRating(const MapPoint pt, AIJH::Resource res) const
     {
         AIJH::Resource surfaceRes = GetSurfaceResource(pt);
         TerrainType t1 = gwb.GetNode(pt).t1, t2 = gwb.GetNode(pt).t2;
-        if(surfaceRes == res || (res == AIJH::PLANTSPACE && surfaceRes == AIJH::NOTHING && TerrainData::IsVital(t1))
+        // Nothing can be planted on roads
+        if(surfaceRes == res
+           || (res == AIJH::PLANTSPACE && surfaceRes == AIJH::NOTHING && TerrainData::IsVital(t1) && !IsRoadPoint(pt))
            || (res == AIJH::BORDERLAND && (IsBorder(pt) || !IsOwnTerritory(pt))
                && (TerrainData::IsUseable(t1) || TerrainData::IsUseable(t2))))
         {
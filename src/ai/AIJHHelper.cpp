@@ -167,7 +167,7 @@ void AIJH::BuildJob::TryToBuild()
                 // buildings (probably important map part)
                 AIInterface& aiInterface = aijh.GetInterface();
                 if(type != BLD_FORTRESS && aiInterface.GetBuildingQuality(bPos) != BQ_MINE
-                   && aiInterface.GetBuildingQuality(bPos) > BUILDING_SIZE[type] && aijh.BQsurroundcheck(bPos, 6, true, 10) < 10)
+                   && aiInterface.GetBuildingQuality(bPos) > BUILDING_SIZE[type] && aijh.BQsurroundcheck(bPos, 6, true) < 10)
                 {
                     // more than 80% is unbuildable in range 7 -> upgrade
                     if(type == BLD_WATCHTOWER)
@@ -0,0 +1,90 @@
+// Copyright (c) 2016 Settlers Freaks (sf-team at siedler25.org)
+//
+// This file is part of Return To The Roots.
+//
+// Return To The Roots is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 2 of the License, or
+// (at your option) any later version.
+//
+// Return To The Roots is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Return To The Roots. If not, see <http://www.gnu.org/licenses/>.
+
+#include "defines.h" // IWYU pragma: keep
+#include "AIMapLayer.h"
+#include <cstdlib>
+
+void AIMapLayer::Init(const MapExtent& size)
+{
+    this->size = size;
+    values.clear();
+    values.resize(size.x * size.y, 0);
+    rowSums.clear();
+    rowSums.resize((size.x + 1) * size.y, 0);
+    isRowDirty.assign(size.y, false);
+}
+
+void AIMapLayer::Set(const MapPoint pt, int value)
+{
+    int& curValue = values[GetIdx(pt)];
+    if(curValue == value)
+        return;
+    curValue = value;
+    isRowDirty[pt.y] = true;
+}
+
+void AIMapLayer::GetRowRangeInRadius(const MapPoint pt, int dy, unsigned radius, int& xStart, int& xEnd)
+{
+    // Use doubled x coordinates (odd rows are shifted by half a node) in which the points in the radius
+    // are all points with |dy| <= radius and |dx| <= 2 * radius - |dy| of the same parity as the row
+    RTTR_Assert(static_cast<unsigned>(std::abs(dy)) <= radius);
+    const int centerX = pt.x * 2 + (pt.y & 1);
+    const int halfWidth = 2 * static_cast<int>(radius) - std::abs(dy);
+    // The parity of the row is the same as of pt.y + dy as the height is even
+    const int rowShift = (pt.y + dy) & 1;
+    xStart = (centerX - halfWidth - rowShift) / 2;
+    xEnd = (centerX + halfWidth - rowShift) / 2;
+}
+
+int AIMapLayer::GetSumInRadius(const MapPoint pt, unsigned radius)
+{
+    RTTR_Assert(2 * radius < size.x && 2 * radius < size.y);
+    const int iRadius = static_cast<int>(radius);
+    int sum = 0;
+    for(int dy = -iRadius; dy <= iRadius; ++dy)
+    {
+        int xStart, xEnd;
+        GetRowRangeInRadius(pt, dy, radius, xStart, xEnd);
+        sum += GetRowSum((pt.y + dy + size.y) % size.y, xStart, xEnd);
+    }
+    return sum;
+}
+
+int AIMapLayer::GetRowSum(unsigned y, int xStart, int xEnd)
+{
+    if(isRowDirty[y])
+        UpdateRowSums(y);
+    const int* row = &rowSums[y * (size.x + 1)];
+    const int width = size.x;
+    if(xStart < 0)
+        return row[width] - row[xStart + width] + row[xEnd + 1];
+    else if(xEnd >= width)
+        return row[width] - row[xStart] + row[xEnd - width + 1];
+    else
+        return row[xEnd + 1] - row[xStart];
+}
+
+void AIMapLayer::UpdateRowSums(unsigned y)
+{
+    const int* rowValues = &values[y * size.x];
+    int* row = &rowSums[y * (size.x + 1)];
+    row[0] = 0;
+    for(unsigned x = 0; x < size.x; ++x)
+        row[x + 1] = row[x] + rowValues[x];
+    isRowDirty[y] = false;
+}
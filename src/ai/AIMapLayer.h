@@ -0,0 +1,60 @@
+// Copyright (c) 2016 Settlers Freaks (sf-team at siedler25.org)
+//
+// This file is part of Return To The Roots.
+//
+// Return To The Roots is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 2 of the License, or
+// (at your option) any later version.
+//
+// Return To The Roots is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Return To The Roots. If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef AIMapLayer_h__
+#define AIMapLayer_h__
+
+#include "gameTypes/MapCoordinates.h"
+#include <vector>
+
+/// A value per map node with row wise prefix sums (summed-area table of each row).
+/// The sum over all points in a radius then only needs 2 lookups per row.
+class AIMapLayer
+{
+public:
+    AIMapLayer() {}
+
+    /// Resize the layer and set all values to 0
+    void Init(const MapExtent& size);
+
+    int operator[](const MapPoint pt) const { return values[GetIdx(pt)]; }
+    void Set(const MapPoint pt, int value);
+
+    /// Return the sum of the values of all points in the radius around pt (including pt)
+    int GetSumInRadius(const MapPoint pt, unsigned radius);
+
+    /// Return the number of points in a radius (including the center)
+    static unsigned GetNumPointsInRadius(unsigned radius) { return 3 * radius * (radius + 1) + 1; }
+
+    /// Get the first and last (inclusive, may be outside of the map) x coordinate of the points in the radius around pt
+    /// in the row with distance dy to pt. A hex map with shifted odd rows and an even height is assumed.
+    static void GetRowRangeInRadius(const MapPoint pt, int dy, unsigned radius, int& xStart, int& xEnd);
+
+private:
+    MapExtent size;
+    std::vector<int> values;
+    /// Prefix sums of each row: rowSums[y * (width + 1) + x] = sum of values[0..x-1] in row y
+    std::vector<int> rowSums;
+    std::vector<bool> isRowDirty;
+
+    unsigned GetIdx(const MapPoint pt) const { return static_cast<unsigned>(pt.y) * size.x + pt.x; }
+    /// Return the sum of the values in row y from xStart to xEnd (inclusive, may wrap around)
+    int GetRowSum(unsigned y, int xStart, int xEnd);
+    void UpdateRowSums(unsigned y);
+};
+
+#endif // AIMapLayer_h__
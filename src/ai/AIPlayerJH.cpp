@@ -24,6 +24,7 @@
 #include "FindWhConditions.h"
 #include "GameMessages.h"
 #include "GameServer.h"
+#include "Instrumentation.h"
 #include "addons/const_addons.h"
 #include "buildings/noBuildingSite.h"
 #include "buildings/nobHQ.h"
@@ -32,6 +33,7 @@
 #include "buildings/nobUsual.h"
 #include "notifications/BuildingNote.h"
 #include "notifications/ExpeditionNote.h"
+#include "notifications/NodeNote.h"
 #include "notifications/ResourceNote.h"
 #include "notifications/RoadNote.h"
 #include "notifications/ShipNote.h"
@@ -103,7 +105,8 @@ void HandleShipNote(AIEventManager& eventMgr, const ShipNote& note)
 } // namespace
 
 AIPlayerJH::AIPlayerJH(const unsigned char playerId, const GameWorldBase& gwb, const AI::Level level)
-    : AIBase(playerId, gwb, level), UpgradeBldListNumber(-1), isInitGfCompleted(false), defeated(false), UpgradeBldPos(MapPoint::Invalid())
+    : AIBase(playerId, gwb, level), UpgradeBldListNumber(-1), isInitGfCompleted(false), defeated(false), UpgradeBldPos(MapPoint::Invalid()),
+      nextRowToRefresh(0)
 {
     construction = new AIConstruction(aii, *this);
     InitNodes();
@@ -131,16 +134,17 @@ AIPlayerJH::AIPlayerJH(const unsigned char playerId, const GameWorldBase& gwb, c
     namespace bl = boost::lambda;
     using bl::_1;
     NotificationManager& notifications = gwb.GetNotifications();
-    subBuilding = notifications.subscribe<BuildingNote>(
-      bl::if_(bl::bind(&BuildingNote::player, _1) == playerId)[bl::bind(&HandleBuildingNote, boost::ref(eventManager), _1)]);
+    subBuilding = notifications.subscribe<BuildingNote>(bl::if_(bl::bind(&BuildingNote::player, _1) == playerId)[(
+      bl::bind(&HandleBuildingNote, boost::ref(eventManager), _1), bl::bind(&AIPlayerJH::MarkNodeChanged, this, bl::bind(&BuildingNote::pos, _1)))]);
     subExpedition = notifications.subscribe<ExpeditionNote>(
       bl::if_(bl::bind(&ExpeditionNote::player, _1) == playerId)[bl::bind(&HandleExpeditionNote, boost::ref(eventManager), _1)]);
-    subResource = notifications.subscribe<ResourceNote>(
-      bl::if_(bl::bind(&ResourceNote::player, _1) == playerId)[bl::bind(&HandleResourceNote, boost::ref(eventManager), _1)]);
+    subResource = notifications.subscribe<ResourceNote>(bl::if_(bl::bind(&ResourceNote::player, _1) == playerId)[(
+      bl::bind(&HandleResourceNote, boost::ref(eventManager), _1), bl::bind(&AIPlayerJH::MarkNodeChanged, this, bl::bind(&ResourceNote::pos, _1)))]);
     subRoad = notifications.subscribe<RoadNote>(
       bl::if_(bl::bind(&RoadNote::player, _1) == playerId)[bl::bind(&HandleRoadNote, boost::ref(eventManager), _1)]);
     subShip = notifications.subscribe<ShipNote>(
       bl::if_(bl::bind(&ShipNote::player, _1) == playerId)[bl::bind(&HandleShipNote, boost::ref(eventManager), _1)]);
+    subNode = notifications.subscribe<NodeNote>(bl::bind(&AIPlayerJH::HandleNodeNote, this, _1));
 }
 
 AIPlayerJH::~AIPlayerJH()
@@ -151,11 +155,13 @@ AIPlayerJH::~AIPlayerJH()
 /// Wird jeden GF aufgerufen und die KI kann hier entsprechende Handlungen vollziehen
 void AIPlayerJH::RunGF(const unsigned gf, bool gfisnwf)
 {
+    Instrumentation::ScopedTimer timer(INSTR_AI);
     if(defeated)
         return;
 
     if(TestDefeat())
         return;
+    UpdateNodes();
     if(!isInitGfCompleted)
     {
         InitStoreAndMilitarylists();
@@ -559,6 +565,12 @@ void AIPlayerJH::InitNodes()
     unsigned short height = aii.GetMapHeight();
 
     nodes.resize(width * height);
+    changedNodes.clear();
+    isNodeChanged.assign(width * height, false);
+    for(unsigned res = 0; res < AIJH::RES_TYPE_COUNT; ++res)
+        resourceLayers[res].Init(MapExtent(width, height));
+    buildingPlaceLayer.Init(MapExtent(width, height));
+    existingBuildingLayer.Init(MapExtent(width, height));
 
     InitReachableNodes();
 
@@ -568,26 +580,90 @@ void AIPlayerJH::InitNodes()
         {
             unsigned i = gwb.GetIdx(pt);
 
-            // if reachable, we'll calc bq
-            if(nodes[i].reachable)
-            {
-                nodes[i].owned = true;
-                nodes[i].bq = aii.GetBuildingQuality(pt);
-            } else
-            {
-                nodes[i].owned = false;
-                nodes[i].bq = BQ_NOTHING;
-            }
-
-            nodes[i].res = CalcResource(pt);
+            nodes[i].owned = aii.IsOwnTerritory(pt);
+            nodes[i].bq = aii.GetBuildingQuality(pt);
+            nodes[i].res = AIJH::NOTHING;
+            SetNodeResource(pt, CalcResource(pt));
             nodes[i].border = aii.IsBorder(pt);
             nodes[i].farmed = false;
+            UpdateBuildingPlaceLayers(pt);
         }
     }
 }
 
 void AIPlayerJH::UpdateNodes()
 {
+    // Refresh one row per call, so changes without a notification are also taken into account eventually
+    for(MapPoint pt(0, nextRowToRefresh); pt.x < aii.GetMapWidth(); ++pt.x)
+        MarkNodeChanged(pt);
+    if(++nextRowToRefresh >= aii.GetMapHeight())
+        nextRowToRefresh = 0;
+
+    BOOST_FOREACH(const MapPoint& pt, changedNodes)
+    {
+        const unsigned i = aii.GetIdx(pt);
+        isNodeChanged[i] = false;
+        nodes[i].owned = aii.IsOwnTerritory(pt);
+        nodes[i].bq = aii.GetBuildingQuality(pt);
+        SetNodeResource(pt, CalcResource(pt));
+        nodes[i].border = aii.IsBorder(pt);
+        UpdateBuildingPlaceLayers(pt);
+        for(unsigned res = 0; res < AIJH::RES_TYPE_COUNT; ++res)
+            resourceMaps[res].UpdateRating(pt);
+    }
+    changedNodes.clear();
+}
+
+void AIPlayerJH::SetNodeResource(const MapPoint pt, AIJH::Resource res)
+{
+    AIJH::Resource& curRes = nodes[aii.GetIdx(pt)].res;
+    if(curRes < AIJH::RES_TYPE_COUNT)
+        resourceLayers[curRes].Set(pt, 0);
+    curRes = res;
+    if(res < AIJH::RES_TYPE_COUNT)
+        resourceLayers[res].Set(pt, 1);
+}
+
+void AIPlayerJH::UpdateBuildingPlaceLayers(const MapPoint pt)
+{
+    const BuildingQuality bq = aii.GetBuildingQualityAnyOwner(pt);
+    const bool isBuildingPlace = (bq >= BQ_HUT && bq <= BQ_CASTLE) || bq == BQ_HARBOR;
+    buildingPlaceLayer.Set(pt, isBuildingPlace ? 1 : 0);
+    bool isExistingBuilding = false;
+    if(!isBuildingPlace)
+    {
+        const NodalObjectType nob = gwb.GetNO(pt)->GetType();
+        isExistingBuilding = nob == NOP_BUILDING || nob == NOP_BUILDINGSITE || nob == NOP_EXTENSION || nob == NOP_FIRE
+                             || nob == NOP_CHARBURNERPILE;
+    }
+    existingBuildingLayer.Set(pt, isExistingBuilding ? 1 : 0);
+}
+
+void AIPlayerJH::MarkNodeChanged(const MapPoint pt)
+{
+    const unsigned i = aii.GetIdx(pt);
+    if(isNodeChanged[i])
+        return;
+    isNodeChanged[i] = true;
+    changedNodes.push_back(pt);
+}
+
+void AIPlayerJH::HandleNodeNote(const NodeNote& note)
+{
+    switch(note.type)
+    {
+        case NodeNote::BQ:
+        case NodeNote::Resource:
+        case NodeNote::Object: // Trees, granite and buildings are (surface) resources
+        case NodeNote::Border: MarkNodeChanged(note.pt); break;
+        case NodeNote::Owner: // The border and the BQ (flags) of the neighbours depend on the owner too
+        case NodeNote::Road:  // Only one of the 2 nodes of a road piece is reported
+            MarkNodeChanged(note.pt);
+            for(unsigned dir = 0; dir < Direction::COUNT; ++dir)
+                MarkNodeChanged(aii.GetNeighbour(note.pt, Direction::fromInt(dir)));
+            break;
+        case NodeNote::Altitude: break; // Reported as BQ changes
+    }
 }
 
 void AIPlayerJH::InitResourceMaps()
@@ -715,18 +791,8 @@ PositionSearchState AIPlayerJH::FindGoodPosition(PositionSearch* search, bool be
 bool AIPlayerJH::FindBestPositionDiminishingResource(MapPoint& pt, AIJH::Resource res, BuildingQuality size, int minimum, int radius,
                                                      bool inTerritory)
 {
-    bool fixed = ggs.isEnabled(AddonId::INEXHAUSTIBLE_MINES)
-                 && (res == AIJH::IRONORE || res == AIJH::COAL || res == AIJH::GOLD || res == AIJH::GRANITE);
-    unsigned short width = aii.GetMapWidth();
-    unsigned short height = aii.GetMapHeight();
-    int temp = 0;
-    bool lastcirclevaluecalculated = false;
-    bool lastvaluecalculated = false;
-    // to avoid having to calculate a value twice and still move left on the same level without any problems we use this variable to
-    // remember the first calculation we did in the circle.
-    int circlestartvalue = 0;
     // outside of map bounds? -> search around our main storehouse!
-    if(pt.x >= width || pt.y >= height)
+    if(pt.x >= aii.GetMapWidth() || pt.y >= aii.GetMapHeight())
     {
         pt = aii.GetStorehouses().front()->GetPos();
     }
@@ -735,119 +801,39 @@ bool AIPlayerJH::FindBestPositionDiminishingResource(MapPoint& pt, AIJH::Resourc
     if(radius == -1)
         radius = 11;
 
-    MapPoint best(0, 0);
-    int best_value = -1;
-
-    for(MapCoord tx = aii.GetXA(pt, Direction::WEST), r = 1; r <= radius; tx = aii.GetXA(tx, pt.y, Direction::WEST), ++r)
+    // The resource map and the nodes are up to date, so just check the usable candidates from best to worst
+    AIResourceMap& resMap = resourceMaps[res];
+    resMap.InitPositionHeap(pt, radius, std::max(minimum, 0), size, inTerritory);
+    MapPoint curPt;
+    int value;
+    while(resMap.PopBestPosition(curPt, value))
     {
-        MapPoint t2(tx, pt.y);
-        for(unsigned curDir = 2; curDir < 8; ++curDir)
+        const TerrainType t1 = aii.GetTerrain(curPt);
+        if(res == AIJH::FISH || res == AIJH::STONES)
         {
-            for(MapCoord step = 0; step < r; ++step)
-            {
-                unsigned n = aii.GetIdx(t2);
-                int& resMapVal = resourceMaps[res][t2];
-                if(fixed)
-                    temp = resMapVal;
-                else
-                {
-                    // only do a complete calculation for the first point or when moving outward and the last value is unknown
-                    if((r < 2 || !lastcirclevaluecalculated) && step < 1 && curDir < 3 && resMapVal)
-                    {
-                        temp = aii.CalcResourceValue(t2, res);
-                        circlestartvalue = temp;
-                        lastcirclevaluecalculated = true;
-                        lastvaluecalculated = true;
-                    } else if(!resMapVal) // was there ever anything? if not skip it!
-                    {
-                        if(step < 1 && curDir < 3)
-                            lastcirclevaluecalculated = false;
-                        lastvaluecalculated = false;
-                        temp = resMapVal;
-                    } else if(step < 1 && curDir < 3) // circle not yet started? -> last direction was outward (left=0)
-                    {
-                        temp = aii.CalcResourceValue(t2, res, 0, circlestartvalue);
-                        circlestartvalue = temp;
-                    } else if(lastvaluecalculated)
-                    {
-                        if(step > 0) // we moved direction i%6
-                            temp = aii.CalcResourceValue(t2, res, curDir % 6, temp);
-                        else // last step was the previous direction
-                            temp = aii.CalcResourceValue(t2, res, (curDir - 1) % 6, temp);
-                    } else
-                    {
-                        temp = aii.CalcResourceValue(t2, res);
-                        lastvaluecalculated = true;
-                    }
-                    // if(resMapVal)
-                    // RTTR_Assert(temp==aii.CalcResourceValue(t2,res));
-                    // copy the value to the resource map
-                    resMapVal = temp;
-                }
-                if(res == AIJH::FISH || res == AIJH::STONES)
-                {
-                    // remove permanently invalid spots to speed up future checks
-                    TerrainType t1 = aii.GetTerrain(t2);
-                    if(!TerrainData::IsUseable(t1) || TerrainData::IsMineable(t1) || t1 == TT_DESERT)
-                        resMapVal = 0;
-                } else //= granite,gold,iron,coal
-                {
-                    if(!TerrainData::IsMineable(aii.GetTerrain(t2)))
-                        resMapVal = 0;
-                }
-                if(temp > best_value)
-                {
-                    if(!nodes[n].reachable || (inTerritory && !aii.IsOwnTerritory(t2)) || nodes[n].farmed)
-                    {
-                        t2 = aii.GetNeighbour(t2, Direction(curDir));
-                        continue;
-                    }
-                    // special case fish -> check for other fishery buildings
-                    if(res == AIJH::FISH && BuildingNearby(t2, BLD_FISHERY, 6))
-                    {
-                        t2 = aii.GetNeighbour(t2, Direction(curDir));
-                        continue;
-                    }
-                    // dont build next to harborspots
-                    if(HarborPosClose(t2, 3, true))
-                    {
-                        t2 = aii.GetNeighbour(t2, Direction(curDir));
-                        continue;
-                    }
-                    BuildingQuality bq = aii.GetBuildingQuality(t2);
-                    if((bq >= size && bq < BQ_MINE) // normales Gebäude
-                       || (bq == size))             // auch Bergwerke
-                    {
-                        best = t2;
-                        best_value = temp;
-                        // TODO: calculate "perfect" rating and instantly return if we got that already
-                    }
-                }
-                t2 = aii.GetNeighbour(t2, Direction(curDir));
-            }
-        }
-    }
-
-    if(best_value >= minimum)
-    {
-        pt = best;
+            if(!TerrainData::IsUseable(t1) || TerrainData::IsMineable(t1) || t1 == TT_DESERT)
+                continue;
+        } else if(!TerrainData::IsMineable(t1)) //= granite,gold,iron,coal
+            continue;
+        // special case fish -> check for other fishery buildings
+        if(res == AIJH::FISH && BuildingNearby(curPt, BLD_FISHERY, 6))
+            continue;
+        // dont build next to harborspots
+        if(HarborPosClose(curPt, 3, true))
+            continue;
+        pt = curPt;
         return true;
     }
     return false;
 }
 
-// TODO: this totally ignores existing buildings of the same type. It should not. Re-introduce the resource maps?
+// TODO: this totally ignores existing buildings of the same type. It should not.
 bool AIPlayerJH::FindBestPosition(MapPoint& pt, AIJH::Resource res, BuildingQuality size, int minimum, int radius, bool inTerritory)
 {
     if(res == AIJH::IRONORE || res == AIJH::COAL || res == AIJH::GOLD || res == AIJH::GRANITE || res == AIJH::STONES || res == AIJH::FISH)
         return FindBestPositionDiminishingResource(pt, res, size, minimum, radius, inTerritory);
-    unsigned short width = aii.GetMapWidth();
-    unsigned short height = aii.GetMapHeight();
-    // to avoid having to calculate a value twice and still move left on the same level without any problems we use this variable to
-    // remember the first calculation we did in the circle.
-    int circlestartvalue = 0;
     // outside of map bounds? -> search around our main storehouse!
-    if(pt.x >= width || pt.y >= height)
+    if(pt.x >= aii.GetMapWidth() || pt.y >= aii.GetMapHeight())
     {
         pt = aii.GetStorehouses().front()->GetPos();
     }
@@ -856,67 +842,20 @@ bool AIPlayerJH::FindBestPosition(MapPoint& pt, AIJH::Resource res, BuildingQual
     if(radius == -1)
         radius = 11;
 
-    MapPoint best(0, 0);
-    int best_value = -1;
-    int temp = 0;
-
-    for(MapCoord tx = aii.GetXA(pt, Direction::WEST), r = 1; r <= radius; tx = aii.GetXA(tx, pt.y, Direction::WEST), ++r)
+    // The resource map and the nodes are up to date, so just check the usable candidates from best to worst
+    AIResourceMap& resMap = resourceMaps[res];
+    resMap.InitPositionHeap(pt, radius, std::max(minimum, 0), size, inTerritory);
+    MapPoint curPt;
+    int value;
+    while(resMap.PopBestPosition(curPt, value))
     {
-        MapPoint t2(tx, pt.y);
-        for(unsigned curDir = 2; curDir < 8; ++curDir)
-        {
-            for(MapCoord step = 0; step < r; ++step)
-            {
-                unsigned n = aii.GetIdx(t2);
-                if(r == 1 && step == 0 && curDir == 2)
-                {
-                    // only do a complete calculation for the first point!
-                    temp = aii.CalcResourceValue(t2, res);
-                    circlestartvalue = temp;
-                } else if(step == 0 && curDir == 2)
-                {
-                    // circle not yet started? -> last direction was outward (left=0)
-                    temp = aii.CalcResourceValue(t2, res, 0, circlestartvalue);
-                    circlestartvalue = temp;
-                } else if(step > 0) // we moved direction i%6
-                    temp = aii.CalcResourceValue(t2, res, curDir % 6, temp);
-                else // last step was the previous direction
-                    temp = aii.CalcResourceValue(t2, res, (curDir - 1) % 6, temp);
-                // copy the value to the resource map (map is only used in the ai debug mode)
-                resourceMaps[res][t2] = temp;
-                if(temp > best_value)
-                {
-                    if(!nodes[n].reachable || (inTerritory && !aii.IsOwnTerritory(t2)) || nodes[n].farmed)
-                    {
-                        t2 = aii.GetNeighbour(t2, Direction(curDir));
-                        continue;
-                    }
-                    if(HarborPosClose(t2, 3, true))
-                    {
-                        t2 = aii.GetNeighbour(t2, Direction(curDir));
-                        continue;
-                    }
-                    BuildingQuality bq = aii.GetBuildingQuality(t2);
-                    if(((bq >= size && bq < BQ_MINE) // normales Gebäude
-                        || (bq == size))
-                       && // auch Bergwerke
-                       (res != AIJH::BORDERLAND || !aii.IsRoadPoint(aii.GetNeighbour(t2, Direction::SOUTHEAST))))
-                    // special: military buildings cannot be build next to an existing road as that would have them connected to 2 roads
-                    // which the ai no longer should do
-                    {
-                        best = t2;
-                        best_value = temp;
-                        // TODO: calculate "perfect" rating and instantly return if we got that already
-                    }
-                }
-                t2 = aii.GetNeighbour(t2, Direction(curDir));
-            }
-        }
-    }
-
-    if(best_value >= minimum)
-    {
-        pt = best;
+        if(HarborPosClose(curPt, 3, true))
+            continue;
+        // special: military buildings cannot be build next to an existing road as that would have them connected to 2 roads
+        // which the ai no longer should do
+        if(res == AIJH::BORDERLAND && aii.IsRoadPoint(aii.GetNeighbour(curPt, Direction::SOUTHEAST)))
+            continue;
+        pt = curPt;
         return true;
     }
     return false;
@@ -1227,16 +1166,11 @@ unsigned AIPlayerJH::GetDensity(MapPoint pt, AIJH::Resource res, int radius)
         pt = aii.GetStorehouses().front()->GetPos();
     }
 
-    std::vector<unsigned> idxs = aii.GetPointsInRadius(pt, radius, MapPoint2Idx(aii));
-    const unsigned all = idxs.size();
-    RTTR_Assert(all > 0);
-
-    unsigned good = 0;
-    for(std::vector<unsigned>::const_iterator it = idxs.begin(); it != idxs.end(); ++it)
-    {
-        if(nodes[*it].res == res)
-            good++;
-    }
+    RTTR_Assert(radius > 0 && res < AIJH::RES_TYPE_COUNT);
+    // All points in the radius except the center
+    const unsigned all = AIMapLayer::GetNumPointsInRadius(radius) - 1;
+    AIMapLayer& resLayer = resourceLayers[res];
+    const unsigned good = resLayer.GetSumInRadius(pt, radius) - resLayer[pt];
 
     return (good * 100) / all;
 }
@@ -1976,8 +1910,8 @@ void AIPlayerJH::RecalcGround(const MapPoint buildingPos, std::vector<Direction>
     RecalcBQAround(pt);
     if(GetAINode(pt).res == AIJH::PLANTSPACE)
     {
-        resourceMaps[AIJH::PLANTSPACE].Change(pt, -1);
-        GetAINode(pt).res = AIJH::NOTHING;
+        SetNodeResource(pt, AIJH::NOTHING);
+        MarkNodeChanged(pt);
     }
 
     // flag of building
@@ -1985,8 +1919,8 @@ void AIPlayerJH::RecalcGround(const MapPoint buildingPos, std::vector<Direction>
     RecalcBQAround(pt);
     if(GetAINode(pt).res == AIJH::PLANTSPACE)
     {
-        resourceMaps[AIJH::PLANTSPACE].Change(pt, -1);
-        GetAINode(pt).res = AIJH::NOTHING;
+        SetNodeResource(pt, AIJH::NOTHING);
+        MarkNodeChanged(pt);
     }
 
     // along the road
@@ -1997,8 +1931,8 @@ void AIPlayerJH::RecalcGround(const MapPoint buildingPos, std::vector<Direction>
         // Auch Plantspace entsprechend anpassen:
         if(GetAINode(pt).res == AIJH::PLANTSPACE)
         {
-            resourceMaps[AIJH::PLANTSPACE].Change(pt, -1);
-            GetAINode(pt).res = AIJH::NOTHING;
+            SetNodeResource(pt, AIJH::NOTHING);
+            MarkNodeChanged(pt);
         }
     }
 }
@@ -2187,7 +2121,6 @@ bool AIPlayerJH::HuntablesinRange(const MapPoint pt, unsigned min)
     unsigned maxrange = 25;
     unsigned short fx, fy, lx, ly;
     const unsigned short SQUARE_SIZE = 19;
-    unsigned huntablecount = 0;
     if(pt.x > SQUARE_SIZE)
         fx = pt.x - SQUARE_SIZE;
     else
@@ -2205,6 +2138,8 @@ bool AIPlayerJH::HuntablesinRange(const MapPoint pt, unsigned min)
     else
         ly = aii.GetMapHeight() - 1;
     // Durchgehen und nach Tieren suchen
+    // Collect the huntable animals first, so the expensive path finding is only done if there can be enough of them
+    std::vector<MapPoint> animalPositions;
     for(MapPoint p2(0, fy); p2.y <= ly; ++p2.y)
     {
         for(p2.x = fx; p2.x <= lx; ++p2.x)
@@ -2216,22 +2151,27 @@ bool AIPlayerJH::HuntablesinRange(const MapPoint pt, unsigned min)
             // Dann nach Tieren suchen
             for(std::list<noBase*>::const_iterator it = figures.begin(); it != figures.end(); ++it)
             {
-                if((*it)->GetType() == NOP_ANIMAL)
-                {
-                    // Ist das Tier überhaupt zum Jagen geeignet?
-                    if(!static_cast<noAnimal*>(*it)->CanHunted())
-                        continue;
-                    // Und komme ich hin?
-                    if(gwb.FindHumanPath(pt, static_cast<noAnimal*>(*it)->GetPos(), maxrange) != 0xFF)
-                    // Dann nehmen wir es
-                    {
-                        if(++huntablecount >= min)
-                            return true;
-                    }
-                }
+                // Ist das Tier überhaupt zum Jagen geeignet?
+                if((*it)->GetType() == NOP_ANIMAL && static_cast<noAnimal*>(*it)->CanHunted())
+                    animalPositions.push_back(static_cast<noAnimal*>(*it)->GetPos());
             }
         }
     }
+    if(animalPositions.size() < min)
+        return false;
+    unsigned huntablecount = 0;
+    for(std::vector<MapPoint>::const_iterator it = animalPositions.begin(); it != animalPositions.end(); ++it)
+    {
+        // Und komme ich hin? Dann nehmen wir es
+        if(gwb.FindHumanPath(pt, *it, maxrange) != 0xFF)
+        {
+            if(++huntablecount >= min)
+                return true;
+        }
+        // Stop if there are not enough animals left
+        if(huntablecount + (animalPositions.end() - it) - 1 < min)
+            break;
+    }
     return false;
 }
 
@@ -2427,7 +2367,7 @@ bool AIPlayerJH::HarborPosClose(const MapPoint pt, unsigned range, bool onlyempt
 }
 
 /// returns the percentage*100 of possible normal+ building places
-unsigned AIPlayerJH::BQsurroundcheck(const MapPoint pt, unsigned range, bool includeexisting, unsigned limit)
+unsigned AIPlayerJH::BQsurroundcheck(const MapPoint pt, unsigned range, bool includeexisting)
 {
     unsigned maxvalue = 6 * (2 << (range - 1)) - 5; // 1,7,19,43,91,... = 6*2^range -5
     unsigned count = 0;
@@ -2441,33 +2381,10 @@ unsigned AIPlayerJH::BQsurroundcheck(const MapPoint pt, unsigned range, bool inc
         if(nob == NOP_BUILDING || nob == NOP_BUILDINGSITE || nob == NOP_EXTENSION || nob == NOP_FIRE || nob == NOP_CHARBURNERPILE)
             count++;
     }
-    // first count all the possible building places
-    for(MapCoord tx = gwb.GetXA(pt, 0), r = 1; r <= range; tx = gwb.GetXA(tx, pt.y, 0), ++r)
-    {
-        MapPoint t2(tx, pt.y);
-        for(unsigned i = 2; i < 8; ++i)
-        {
-            for(MapCoord r2 = 0; r2 < r; t2 = gwb.GetNeighbour(t2, i % 6), ++r2)
-            {
-                if(limit && ((count * 100) / maxvalue) > limit)
-                    return ((count * 100) / maxvalue);
-                // point can be used for a building
-                if((aii.GetBuildingQualityAnyOwner(t2) >= BQ_HUT && aii.GetBuildingQualityAnyOwner(t2) <= BQ_CASTLE)
-                   || aii.GetBuildingQualityAnyOwner(t2) == BQ_HARBOR)
-                {
-                    count++;
-                    continue;
-                }
-                if(includeexisting)
-                {
-                    nob = gwb.GetNO(t2)->GetType();
-                    if(nob == NOP_BUILDING || nob == NOP_BUILDINGSITE || nob == NOP_EXTENSION || nob == NOP_FIRE
-                       || nob == NOP_CHARBURNERPILE)
-                        count++;
-                }
-            }
-        }
-    }
+    // then count all the possible building places (and existing buildings) around it
+    count += buildingPlaceLayer.GetSumInRadius(pt, range) - buildingPlaceLayer[pt];
+    if(includeexisting)
+        count += existingBuildingLayer.GetSumInRadius(pt, range) - existingBuildingLayer[pt];
     // LOG.write(("bqcheck at %i,%i r%u result: %u,%u \n",pt,range,count,maxvalue);
     return ((count * 100) / maxvalue);
 }
@@ -22,6 +22,7 @@
 #include "AIBase.h"
 #include "AIEventManager.h"
 #include "AIJHHelper.h"
+#include "AIMapLayer.h"
 #include "AIResourceMap.h"
 #include "GamePlayer.h"
 #include "helpers/Deleter.h"
@@ -36,6 +37,7 @@ class AIConstruction;
 class GlobalGameSettings;
 class noShip;
 class nobBaseWarehouse;
+struct NodeNote;
 namespace AIEvent {
 class Base;
 }
@@ -154,8 +156,16 @@ protected:
 
     /// Initializes the nodes on start of the game
     void InitNodes();
-    /// Updates all nodes (takes a while so dont call it too often)
+    /// Updates all nodes (and their resource ratings) that changed since the last call
     void UpdateNodes();
+    /// Marks a node as changed so it gets updated by the next call to UpdateNodes
+    void MarkNodeChanged(const MapPoint pt);
+    /// Marks the nodes affected by a change in the world
+    void HandleNodeNote(const NodeNote& note);
+    /// Sets the resource of the node and updates the layers depending on it
+    void SetNodeResource(const MapPoint pt, AIJH::Resource res);
+    /// Updates the building place layers for the node
+    void UpdateBuildingPlaceLayers(const MapPoint pt);
 
     /// Updates the nodes around a position
     void UpdateNodesAround(const MapPoint pt, unsigned radius);
@@ -340,6 +350,12 @@ protected:
 
     /// Resource maps, containing a rating for every map point concerning a resource
     boost::array<AIResourceMap, AIJH::RES_TYPE_COUNT> resourceMaps;
+    /// 1 for each node whose resource (nodes[].res) is the layers resource, 0 otherwise
+    boost::array<AIMapLayer, AIJH::RES_TYPE_COUNT> resourceLayers;
+    /// 1 for each node where a building can be placed (independent of the owner), 0 otherwise
+    AIMapLayer buildingPlaceLayer;
+    /// 1 for each node without a building place which contains a building (or site, fire...), 0 otherwise
+    AIMapLayer existingBuildingLayer;
 
     // Required by the AIJobs:
 
@@ -358,7 +374,7 @@ public:
     /// checks distance to all harborpositions
     bool HarborPosClose(const MapPoint pt, unsigned range, bool onlyempty = false);
     /// returns the percentage*100 of possible normal building places
-    unsigned BQsurroundcheck(const MapPoint pt, unsigned range, bool includeexisting, unsigned limit = 0);
+    unsigned BQsurroundcheck(const MapPoint pt, unsigned range, bool includeexisting);
     /// returns list entry of the building the ai uses for troop upgrades
     int UpdateUpgradeBuilding();
     /// returns amount of good/people stored in warehouses right now
@@ -370,7 +386,12 @@ protected:
     AIConstruction* construction;
 
 private:
-    Subscribtion subBuilding, subExpedition, subResource, subRoad, subShip;
+    Subscribtion subBuilding, subExpedition, subResource, subRoad, subShip, subNode;
+    /// Nodes changed since the last update (flag per node to avoid duplicates)
+    std::vector<MapPoint> changedNodes;
+    std::vector<bool> isNodeChanged;
+    /// Row which is updated next even if no change was reported (catches changes without notification)
+    unsigned short nextRowToRefresh;
 };
 
 #endif //! AIPLAYERJH_H_INCLUDED
@@ -18,9 +18,11 @@
 #include "defines.h" // IWYU pragma: keep
 #include "AIResourceMap.h"
 #include "AIJHHelper.h"
+#include "AIMapLayer.h"
 #include "buildings/noBuildingSite.h"
 #include "buildings/nobUsual.h"
 #include "gameData/TerrainData.h"
+#include <algorithm>
 
 AIResourceMap::AIResourceMap(const AIJH::Resource res, const AIInterface& aii, const std::vector<AIJH::Node>& nodes)
     : res(res), aii(&aii), nodes(&nodes), resRadius(AIJH::RES_RADIUS[res])
@@ -38,32 +40,45 @@ void AIResourceMap::Init()
 
     map.clear();
     map.resize(width * height);
+    ratings.resize(width * height);
     for(MapPoint pt(0, 0); pt.y < height; ++pt.y)
     {
         for(pt.x = 0; pt.x < width; ++pt.x)
         {
-            unsigned i = aii->GetIdx(pt);
-            if((*nodes)[i].res == res && res == AIJH::FISH)
-            {
-                Change(pt, 1);
-            } else if((*nodes)[i].res == res && res != AIJH::BORDERLAND && TerrainData::IsUseable(aii->GetTerrain(pt)))
-            {
-                Change(pt, 1);
-            } else if(res == AIJH::BORDERLAND && aii->IsBorder(pt))
-            {
-                // only count border area that is actually passable terrain
-                if(TerrainData::IsUseable(aii->GetTerrain(pt)))
-                    Change(pt, 1);
-            }
-            if((*nodes)[i].res == AIJH::MULTIPLE && TerrainData::IsUseable(aii->GetTerrain(pt)))
-            {
-                if(aii->GetSubsurfaceResource(pt) == res || aii->GetSurfaceResource(pt) == res)
-                    Change(pt, 1);
-            }
+            const int rating = aii->GetResourceRating(pt, res);
+            ratings[aii->GetIdx(pt)] = rating;
+            if(rating)
+                AddToRadius(pt, rating);
         }
     }
 }
 
+void AIResourceMap::UpdateRating(const MapPoint pt)
+{
+    int& rating = ratings[aii->GetIdx(pt)];
+    const int newRating = aii->GetResourceRating(pt, res);
+    if(newRating == rating)
+        return;
+    AddToRadius(pt, newRating - rating);
+    rating = newRating;
+}
+
+void AIResourceMap::AddToRadius(const MapPoint pt, int value)
+{
+    const int width = aii->GetMapWidth();
+    const int height = aii->GetMapHeight();
+    const int radius = resRadius;
+    RTTR_Assert(2 * radius < width && 2 * radius < height);
+    for(int dy = -radius; dy <= radius; ++dy)
+    {
+        int xStart, xEnd;
+        AIMapLayer::GetRowRangeInRadius(pt, dy, radius, xStart, xEnd);
+        int* row = &map[((pt.y + dy + height) % height) * width];
+        for(int x = xStart; x <= xEnd; ++x)
+            row[(x + width) % width] += value;
+    }
+}
+
 void AIResourceMap::Recalc()
 {
     Init();
@@ -128,9 +143,9 @@ bool AIResourceMap::FindGoodPosition(MapPoint& pt, int threshold, BuildingQualit
         {
             if((inTerritory && !(*nodes)[idx].owned) || (*nodes)[idx].farmed)
                 continue;
-            const BuildingQuality bq = aii->GetBuildingQuality(*it); //(*nodes)[idx].bq; TODO: Update nodes BQ and use that
-            if((bq >= size && bq < BQ_MINE)                          // normales Gebäude
-               || (bq == size))                                      // auch Bergwerke
+            const BuildingQuality bq = (*nodes)[idx].bq;
+            if((bq >= size && bq < BQ_MINE) // normales Gebäude
+               || (bq == size))             // auch Bergwerke
             {
                 pt = *it;
                 return true;
@@ -148,31 +163,44 @@ bool AIResourceMap::FindBestPosition(MapPoint& pt, BuildingQuality size, int min
     if(radius == -1)
         radius = 30;
 
-    MapPoint best(0, 0);
-    int best_value = -1;
+    // The best candidate is the result
+    InitPositionHeap(pt, radius, std::max(minimum, 0), size, inTerritory);
+    int value;
+    return PopBestPosition(pt, value);
+}
+
+bool AIResourceMap::IsUsable(unsigned idx, BuildingQuality size, bool inTerritory) const
+{
+    const AIJH::Node& node = (*nodes)[idx];
+    if(!node.reachable || (inTerritory && !node.owned) || node.farmed)
+        return false;
+    return (node.bq >= size && node.bq < BQ_MINE) // normales Gebäude
+           || (node.bq == size);                  // auch Bergwerke
+}
 
+void AIResourceMap::InitPositionHeap(const MapPoint pt, unsigned radius, int minimum, BuildingQuality size, bool inTerritory)
+{
+    positionHeap.clear();
+    const unsigned ptIdx = aii->GetIdx(pt);
+    if(map[ptIdx] >= minimum && IsUsable(ptIdx, size, inTerritory))
+        positionHeap.push_back(RatedPosition(map[ptIdx], pt));
     std::vector<MapPoint> pts = aii->GetPointsInRadius(pt, radius);
-    for(std::vector<MapPoint>::iterator it = pts.begin(); it != pts.end(); ++it)
+    for(std::vector<MapPoint>::const_iterator it = pts.begin(); it != pts.end(); ++it)
     {
         const unsigned idx = aii->GetIdx(*it);
-        if(map[idx] > best_value)
-        {
-            if(!(*nodes)[idx].reachable || (inTerritory && !(*nodes)[idx].owned) || (*nodes)[idx].farmed)
-                continue;
-            const BuildingQuality bq = aii->GetBuildingQuality(*it); //(*nodes)[idx].bq; TODO: Update nodes BQ and use that
-            if((bq >= size && bq < BQ_MINE)                          // normales Gebäude
-               || (bq == size))                                      // auch Bergwerke
-            {
-                best = *it;
-                best_value = map[idx];
-            }
-        }
+        if(map[idx] >= minimum && IsUsable(idx, size, inTerritory))
+            positionHeap.push_back(RatedPosition(map[idx], *it));
     }
+    std::make_heap(positionHeap.begin(), positionHeap.end());
+}
 
-    if(best_value >= minimum)
-    {
-        pt = best;
-        return true;
-    }
-    return false;
+bool AIResourceMap::PopBestPosition(MapPoint& pt, int& value)
+{
+    if(positionHeap.empty())
+        return false;
+    std::pop_heap(positionHeap.begin(), positionHeap.end());
+    pt = positionHeap.back().pt;
+    value = positionHeap.back().value;
+    positionHeap.pop_back();
+    return true;
 }
@@ -33,14 +33,23 @@ public:
     AIResourceMap(const AIJH::Resource res, const AIInterface& aii, const std::vector<AIJH::Node>& nodes);
     ~AIResourceMap();
 
-    /// Initialize the resource map
+    /// Initialize the resource map: The value of each point is the sum of the resource ratings of all points in the resource radius
     void Init();
     void Recalc();
+    /// Recalculates the rating of a single (changed) point and updates the values of all points in the resource radius accordingly
+    void UpdateRating(const MapPoint pt);
 
     /// Changes a single resource map around point pt in radius; to every point around pt distanceFromCenter * value is added
     void Change(const MapPoint pt, unsigned radius, int value);
     void Change(const MapPoint pt, int value) { Change(pt, resRadius, value); }
 
+    /// Fills the position heap with all points in the radius around pt (including pt) which have at least the minimum value
+    /// and are usable for a building of the given size according to the AI nodes (reachable, not farmed, BQ, in territory if requested)
+    void InitPositionHeap(const MapPoint pt, unsigned radius, int minimum, BuildingQuality size, bool inTerritory);
+    /// Removes the remaining position with the highest value from the heap. Returns false if it is empty.
+    /// Successive calls return the k best positions
+    bool PopBestPosition(MapPoint& pt, int& value);
+
     /// Finds a good position for a specific resource in an area using the resource maps,
     /// first position satisfying threshold is returned, returns false if no such position found
     bool FindGoodPosition(MapPoint& pt, int threshold, BuildingQuality size, int radius = -1, bool inTerritory = true);
@@ -57,9 +66,24 @@ public:
     int operator[](const MapPoint& pt) const { return map[aii->GetIdx(pt)]; }
 
 private:
+    struct RatedPosition
+    {
+        int value;
+        MapPoint pt;
+        RatedPosition(int value, const MapPoint pt) : value(value), pt(pt) {}
+        bool operator<(const RatedPosition& rhs) const { return value < rhs.value; }
+    };
+
     void AdjustRatingForBlds(BuildingType bld, unsigned radius, int value);
+    bool IsUsable(unsigned idx, BuildingQuality size, bool inTerritory) const;
+    /// Adds the value to all points in the resource radius around pt
+    void AddToRadius(const MapPoint pt, int value);
 
     std::vector<int> map;
+    /// Resource rating of each point as used for the values in the map
+    std::vector<int> ratings;
+    /// Candidates of the current position search (max-heap)
+    std::vector<RatedPosition> positionHeap;
     AIJH::Resource res; // Do not change! const ommited to to able to store this in a vector
     const AIInterface* aii;
     const std::vector<AIJH::Node>* nodes;
@@ -97,7 +97,7 @@ void nobBaseMilitary::Destroy_nobBaseMilitary()
     for(sortedMilitaryBlds::iterator it = buildings.begin(); it != buildings.end(); ++it)
     {
         if((*it)->GetPlayer() != player && (*it)->GetBuildingType() >= BLD_BARRACKS && (*it)->GetBuildingType() <= BLD_FORTRESS)
-            static_cast<nobMilitary*>(*it)->LookForEnemyBuildings(this);
+            gwg->RequestFrontierCheck(*static_cast<nobMilitary*>(*it), this);
     }
 
     Destroy_noBuilding();
@@ -49,12 +49,11 @@
 
 nobMilitary::nobMilitary(const BuildingType type, const MapPoint pos, const unsigned char player, const Nation nation)
     : nobBaseMilitary(type, pos, player, nation), new_built(true), captured_not_built(false), coins(0), coinsDisabled(false),
-      coinsDisabledVirtual(false), capturing(false), capturing_soldiers(0), goldorder_event(NULL), upgrade_event(NULL),
-      is_regulating_troops(false)
+      coinsDisabledVirtual(false), frontier_distance(0), capturing(false), capturing_soldiers(0), goldorder_event(NULL),
+      upgrade_event(NULL), is_regulating_troops(false), isNearHarbor(-1)
 {
     // Gebäude entsprechend als Militärgebäude registrieren und in ein Militärquadrat eintragen
     gwg->GetPlayer(player).AddMilitaryBuilding(this);
-    gwg->GetMilitarySquares().Add(this);
 
     // Größe ermitteln
     switch(type)
@@ -68,8 +67,10 @@ nobMilitary::nobMilitary(const BuildingType type, const MapPoint pos, const unsi
             size = 0xFF;
             break;
     }
+    // Needs the size for the radius
+    gwg->GetMilitarySquares().Add(this);
 
-    LookForEnemyBuildings();
+    gwg->RequestFrontierCheck(*this);
 
     // Tür aufmachen, bis Gebäude besetzt ist
     OpenDoor();
@@ -105,6 +106,7 @@ void nobMilitary::Destroy_nobMilitary()
     // Remove from military square and buildings first, to avoid e.g. sending canceled soldiers back to this building
     gwg->GetPlayer(player).RemoveMilitaryBuilding(this);
     gwg->GetMilitarySquares().Remove(this);
+    gwg->CancelMilitaryRequests(*this);
 
     // Bestellungen stornieren
     CancelOrders();
@@ -160,7 +162,7 @@ nobMilitary::nobMilitary(SerializedGameData& sgd, const unsigned obj_id)
     : nobBaseMilitary(sgd, obj_id), new_built(sgd.PopBool()), captured_not_built(sgd.PopBool()), coins(sgd.PopUnsignedChar()),
       coinsDisabled(sgd.PopBool()), coinsDisabledVirtual(coinsDisabled), frontier_distance(sgd.PopUnsignedChar()),
       size(sgd.PopUnsignedChar()), capturing(sgd.PopBool()), capturing_soldiers(sgd.PopUnsignedInt()), goldorder_event(sgd.PopEvent()),
-      upgrade_event(sgd.PopEvent()), is_regulating_troops(false)
+      upgrade_event(sgd.PopEvent()), is_regulating_troops(false), isNearHarbor(-1)
 {
     sgd.PopObjectContainer(ordered_troops, GOT_NOF_PASSIVESOLDIER);
     sgd.PopObjectContainer(ordered_coins, GOT_WARE);
@@ -378,14 +380,16 @@ void nobMilitary::LookForEnemyBuildings(const nobBaseMilitary* const exception)
 
     // Evtl. Hafenpunkte in der N? mit ber?htigen
     if(frontier_distance <= 1)
-        if(gwg->CalcDistanceToNearestHarbor(pos) < SEAATTACK_DISTANCE + 2)
-        {
-            // if(gwg->IsAHarborInSeaAttackDistance(MapPoint(x,y)))
+    {
+        // Harbor points don't change, so check this only once
+        if(isNearHarbor < 0)
+            isNearHarbor = (gwg->CalcDistanceToNearestHarbor(pos) < SEAATTACK_DISTANCE + 2) ? 1 : 0;
+        if(isNearHarbor)
             frontier_distance = 2;
-        }
+    }
 
     // Truppen schicken
-    RegulateTroops();
+    gwg->RequestTroopRegulation(*this);
 }
 
 void nobMilitary::NewEnemyMilitaryBuilding(const unsigned short distance)
@@ -404,7 +408,7 @@ void nobMilitary::NewEnemyMilitaryBuilding(const unsigned short distance)
             frontier_distance = 1;
     }
 
-    RegulateTroops();
+    gwg->RequestTroopRegulation(*this);
 }
 
 void nobMilitary::RegulateTroops()
@@ -938,6 +942,7 @@ void nobMilitary::Capture(const unsigned char new_owner)
 
     // neuer Spieler
     player = new_owner;
+    gwg->GetMilitarySquares().UpdateOwner(this);
 
     // Flagge davor auch übernehmen
     GetFlag()->Capture(new_owner);
@@ -949,7 +954,7 @@ void nobMilitary::Capture(const unsigned char new_owner)
     gwg->RecalcVisibilitiesAroundPoint(pos, GetMilitaryRadius() + VISUALRANGE_MILITARY + 1, old_player, NULL);
 
     // Grenzflagge entsprechend neu setzen von den Feinden
-    LookForEnemyBuildings();
+    gwg->RequestFrontierCheck(*this);
     // und von den Verbündeten (da ja ein Feindgebäude weg ist)!
     sortedMilitaryBlds buildings = gwg->LookForMilitaryBuildings(pos, 4);
     for(sortedMilitaryBlds::iterator it = buildings.begin(); it != buildings.end(); ++it)
@@ -958,7 +963,7 @@ void nobMilitary::Capture(const unsigned char new_owner)
         if(gwg->GetPlayer((*it)->GetPlayer()).IsAttackable(old_player) && (*it)->GetBuildingType() >= BLD_BARRACKS
            && (*it)->GetBuildingType() <= BLD_FORTRESS)
             // Grenzflaggen von dem neu berechnen
-            static_cast<nobMilitary*>(*it)->LookForEnemyBuildings();
+            gwg->RequestFrontierCheck(*static_cast<nobMilitary*>(*it));
     }
 
     // ehemalige Leute dieses Gebäudes nach Hause schicken, die ggf. grad auf dem Weg rein/raus waren
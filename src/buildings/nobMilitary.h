@@ -66,6 +66,8 @@ class nobMilitary : public nobBaseMilitary
     GameEvent* upgrade_event;
     /// Is the military building regulating its troops at the moment? (then block furthere RegulateTroop calls)
     bool is_regulating_troops;
+    /// Is a harbor point close enough to count as frontier (-1 = not checked yet)
+    signed char isNearHarbor;
     /// Soldatenbesatzung
     SortedTroops troops;
 
@@ -23,6 +23,7 @@
 #include "driver/src/MouseCoords.h"
 #include "drivers/VideoDriverWrapper.h"
 #include "ogl/glArchivItem_Bitmap.h"
+#include "ogl/glSpriteBatch.h"
 
 ctrlButton::ctrlButton(Window* parent, unsigned id, const DrawPoint& pos, const Extent& size, TextureColor tc, const std::string& tooltip)
     : Window(parent, id, pos, size), ctrlBaseTooltip(tooltip), tc(tc), state(BUTTON_UP), hasBorder(true), isChecked(false),
@@ -135,12 +136,16 @@ void ctrlButton::Draw_()
                 texture = tc * 2;
             if(isIlluminated)
             {
+                SPRITEBATCH.Flush();
                 glTexEnvi(GL_TEXTURE_ENV, GL_TEXTURE_ENV_MODE, GL_COMBINE_EXT);
                 glTexEnvf(GL_TEXTURE_ENV, GL_RGB_SCALE_EXT, 2.0f);
             }
             LOADER.GetImageN("io", texture)->DrawPart(Rect(GetDrawPos(), GetSize()), DrawPoint::all(0), color);
             if(isIlluminated)
+            {
+                SPRITEBATCH.Flush();
                 glTexEnvi(GL_TEXTURE_ENV, GL_TEXTURE_ENV_MODE, GL_MODULATE);
+            }
         }
     }
 
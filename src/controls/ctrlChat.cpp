@@ -237,6 +237,7 @@ void ctrlChat::AddMessage(const std::string& time_string, const std::string& pla
     // Waren wir am Ende? Dann mit runterscrollen
     if(scrollbar->GetScrollPos() + page_size == oldlength)
         scrollbar->SetScrollPos(chat_lines.size() - page_size);
+    Invalidate();
 }
 
 bool ctrlChat::Msg_MouseMove(const MouseCoords& mc)
@@ -48,6 +48,7 @@ void ctrlEdit::SetText(const std::string& text)
 
     for(ucString::const_iterator it = tmp.begin(); it != tmp.end(); ++it)
         AddChar(*it);
+    Invalidate();
 }
 
 void ctrlEdit::SetText(const unsigned text)
@@ -60,6 +61,7 @@ void ctrlEdit::SetText(const unsigned text)
     std::string tmp = helpers::toString(text);
     for(std::string::const_iterator it = tmp.begin(); it != tmp.end(); ++it)
         AddChar(*it);
+    Invalidate();
 }
 
 std::string ctrlEdit::GetText() const
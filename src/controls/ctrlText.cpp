@@ -17,6 +17,7 @@
 
 #include "defines.h" // IWYU pragma: keep
 #include "ctrlText.h"
+#include "WindowManager.h"
 #include "ogl/glArchivItem_Font.h"
 
 ctrlBaseText::ctrlBaseText(const std::string& text, const unsigned color, glArchivItem_Font* font) : text(text), color_(color), font(font)
@@ -25,7 +26,10 @@ ctrlBaseText::ctrlBaseText(const std::string& text, const unsigned color, glArch
 
 void ctrlBaseText::SetText(const std::string& text)
 {
+    if(this->text == text)
+        return;
     this->text = text;
+    WINDOWMANAGER.Invalidate();
 }
 
 void ctrlBaseText::SetFont(glArchivItem_Font* font)
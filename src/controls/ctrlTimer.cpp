@@ -18,6 +18,7 @@
 #include "defines.h" // IWYU pragma: keep
 #include "ctrlTimer.h"
 
+#include "WindowManager.h"
 #include "drivers/VideoDriverWrapper.h"
 
 /** @var ctrlTimer::timer
@@ -44,6 +45,7 @@ void ctrlTimer::Start(unsigned timeout)
 
     // timer initialisieren
     timer = VIDEODRIVER.GetTickCount();
+    WINDOWMANAGER.ScheduleRedraw(timer + timeout);
 }
 
 /**
@@ -71,4 +73,7 @@ void ctrlTimer::Msg_PaintBefore()
             timer = VIDEODRIVER.GetTickCount();
         }
     }
+    // Make sure we get called again when the timer fires even if nothing else changes
+    if(timer != 0)
+        WINDOWMANAGER.ScheduleRedraw(timer + timeout + 1);
 }
@@ -48,6 +48,7 @@
 #include "ingameWindows/iwEndgame.h"
 #include "ingameWindows/iwHQ.h"
 #include "ingameWindows/iwHarborBuilding.h"
+#include "ingameWindows/iwInstrumentation.h"
 #include "ingameWindows/iwInventory.h"
 #include "ingameWindows/iwMainMenu.h"
 #include "ingameWindows/iwMapDebug.h"
@@ -649,6 +650,12 @@ bool dskGameInterface::Msg_KeyDown(const KeyEvent& ke)
         case KT_F3: // Map debug window/ Multiplayer coordinates
             WINDOWMANAGER.Show(new iwMapDebug(gwv, gameClient.IsSinglePlayer() || gameClient.IsReplayModeOn()));
             return true;
+        case KT_F6: // Time used by the game subsystems
+            WINDOWMANAGER.Show(new iwInstrumentation);
+            return true;
+        case KT_F7: // Frame times and GF lag
+            GAMEMANAGER.ToggleFrameStats();
+            return true;
         case KT_F8: // Tastaturbelegung
             WINDOWMANAGER.Show(new iwTextfile("keyboardlayout.txt", _("Keyboard layout")));
             return true;
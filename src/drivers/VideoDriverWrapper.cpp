@@ -277,7 +277,11 @@ unsigned VideoDriverWrapper::GenerateTexture()
     }
 
     GLuint newTexture = 0;
-    glGenTextures(1, &newTexture);
+    if(isOglEnabled_)
+        glGenTextures(1, &newTexture);
+    else
+        newTexture = texture_pos + 1; // Dummy handle so textures can still be told apart
+
 #if !defined(NDEBUG) && defined(HAVE_MEMCHECK_H)
     VALGRIND_MAKE_MEM_DEFINED(&newTexture, sizeof(newTexture));
 #endif
@@ -93,6 +93,8 @@ public:
 
     std::string GetName() const;
     bool IsLoaded() const { return videodriver != NULL; }
+    /// Whether OpenGL calls are actually made (not the case for e.g. the test driver)
+    bool IsOpenGL() const { return isOglEnabled_; }
 
     /// Calculate the size of the texture which is optimal for the driver and at least minSize
     Extent calcPreferredTextureSize(const Extent& minSize) const;
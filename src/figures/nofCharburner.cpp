@@ -154,7 +154,7 @@ nofFarmhand::PointQuality nofCharburner::GetPointQuality(const MapPoint pt) cons
         return PQ_NOTPOSSIBLE;
 
     // Kein Grenzstein darf da stehen
-    if(gwg->GetNode(pt).boundary_stones[0])
+    if(gwg->HasBorderStone(pt))
         return PQ_NOTPOSSIBLE;
 
     for(unsigned char i = 0; i < 6; ++i)
@@ -116,7 +116,7 @@ nofFarmhand::PointQuality nofForester::GetPointQuality(const MapPoint pt) const
         return PQ_NOTPOSSIBLE;
 
     // Kein Grenzstein darf da stehen
-    if(gwg->GetNode(pt).boundary_stones[0])
+    if(gwg->HasBorderStone(pt))
         return PQ_NOTPOSSIBLE;
 
     // darf außerdem nich auf einer Straße liegen
@@ -145,7 +145,7 @@ const char* const FILE_PATHS[] = {
   /* 97 */ RTTRDIR "",                            // unbenutzt
   /* 98 */ RTTR_SETTINGSDIR "/LSTS/",             // persönliche lstfiles (immer bei start geladen)
   /* 99 */ RTTR_SETTINGSDIR "/LSTS/GAME/",        // persönliche lstfiles (immer bei spielstart geladen)
-  /*100 */ RTTR_SETTINGSDIR "",                   // unbenutzt
+  /*100 */ RTTR_SETTINGSDIR "/CACHE/",            // Zwischenspeicher (z.B. gepackte Texturen)
   /*101 */ RTTRDIR "",                            // unbenutzt
   /*102 */ RTTR_GAMEDIR "/GFX/PICS/SETUP013.LBM", // Optionen
   /*103 */ RTTR_GAMEDIR "/GFX/PICS/SETUP015.LBM", // Freies Spiel
@@ -63,6 +63,7 @@ enum GUI_ID
     CGI_MISSION_STATEMENT,
     CGI_MAP_DEBUG,
     CGI_AI_DEBUG,
+    CGI_INSTRUMENTATION,
     CGI_MAP_GENERATOR,
     CGI_NEXT = CGI_MAP_GENERATOR + 40
 };
@@ -0,0 +1,104 @@
+// Copyright (c) 2016 Settlers Freaks (sf-team at siedler25.org)
+//
+// This file is part of Return To The Roots.
+//
+// Return To The Roots is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 2 of the License, or
+// (at your option) any later version.
+//
+// Return To The Roots is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Return To The Roots. If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef LRUCache_h__
+#define LRUCache_h__
+
+#include <boost/functional/hash.hpp>
+#include <boost/unordered_map.hpp>
+#include <list>
+#include <utility>
+
+namespace helpers {
+
+/// Map with a limited size. When full, the least recently used (inserted or found) entry is removed
+template<class T_Key, class T_Value, class T_Hash = boost::hash<T_Key> >
+class LRUCache
+{
+    typedef std::list<std::pair<T_Key, T_Value> > Entries;
+    typedef boost::unordered_map<T_Key, typename Entries::iterator, T_Hash> Index;
+
+    /// Entries with the most recently used first
+    Entries entries_;
+    Index index_;
+    unsigned maxSize_;
+
+    void RebuildIndex()
+    {
+        index_.clear();
+        for(typename Entries::iterator it = entries_.begin(); it != entries_.end(); ++it)
+            index_[it->first] = it;
+    }
+
+public:
+    explicit LRUCache(unsigned maxSize) : maxSize_(maxSize) {}
+    LRUCache(const LRUCache& other) : entries_(other.entries_), maxSize_(other.maxSize_) { RebuildIndex(); }
+    LRUCache& operator=(const LRUCache& other)
+    {
+        if(this != &other)
+        {
+            entries_ = other.entries_;
+            maxSize_ = other.maxSize_;
+            RebuildIndex();
+        }
+        return *this;
+    }
+
+    /// Return the value stored for the key or NULL if there is none
+    T_Value* find(const T_Key& key)
+    {
+        typename Index::iterator it = index_.find(key);
+        if(it == index_.end())
+            return NULL;
+        // Move to front
+        entries_.splice(entries_.begin(), entries_, it->second);
+        return &it->second->second;
+    }
+
+    /// Store the value for the key (replacing an existing one) and return a reference to the stored value.
+    /// The reference is valid till the next insertion
+    T_Value& insert(const T_Key& key, const T_Value& value)
+    {
+        typename Index::iterator it = index_.find(key);
+        if(it != index_.end())
+        {
+            entries_.splice(entries_.begin(), entries_, it->second);
+            it->second->second = value;
+            return it->second->second;
+        }
+        if(entries_.size() >= maxSize_ && !entries_.empty())
+        {
+            index_.erase(entries_.back().first);
+            entries_.pop_back();
+        }
+        entries_.push_front(std::make_pair(key, value));
+        index_[key] = entries_.begin();
+        return entries_.front().second;
+    }
+
+    void clear()
+    {
+        entries_.clear();
+        index_.clear();
+    }
+    unsigned size() const { return static_cast<unsigned>(entries_.size()); }
+    unsigned maxSize() const { return maxSize_; }
+};
+
+} // namespace helpers
+
+#endif // LRUCache_h__
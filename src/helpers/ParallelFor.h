@@ -0,0 +1,91 @@
+// Copyright (c) 2016 Settlers Freaks (sf-team at siedler25.org)
+//
+// This file is part of Return To The Roots.
+//
+// Return To The Roots is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 2 of the License, or
+// (at your option) any later version.
+//
+// Return To The Roots is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Return To The Roots. If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef ParallelFor_h__
+#define ParallelFor_h__
+
+#include <boost/ref.hpp>
+#include <boost/thread/locks.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/thread.hpp>
+#include <algorithm>
+
+namespace helpers {
+
+namespace detail {
+    /// Work queue shared by the threads: Each thread takes the next unprocessed index until all are done
+    template<class T_Func>
+    class ParallelForQueue
+    {
+        T_Func& func_;
+        const unsigned numItems_;
+        unsigned nextItem_;
+        boost::mutex mutex_;
+
+        bool getNextItem(unsigned& item)
+        {
+            boost::lock_guard<boost::mutex> lock(mutex_);
+            if(nextItem_ >= numItems_)
+                return false;
+            item = nextItem_++;
+            return true;
+        }
+
+    public:
+        ParallelForQueue(T_Func& func, unsigned numItems) : func_(func), numItems_(numItems), nextItem_(0) {}
+
+        void operator()()
+        {
+            unsigned item;
+            while(getNextItem(item))
+                func_(item);
+        }
+    };
+} // namespace detail
+
+/// Return the number of threads to use for parallel work
+inline unsigned getNumWorkerThreads()
+{
+    return std::max(1u, boost::thread::hardware_concurrency());
+}
+
+/// Call func(i) for all i in [0, numItems) distributed over a pool of threads and wait till all are done.
+/// The calls must be independent of each other (no shared state without locking) and must not throw.
+/// The order in which the indices are processed is undefined, so results should be stored per index.
+/// With maxThreads == 1 (or only 1 item) everything is done in the current thread.
+template<class T_Func>
+void parallelFor(unsigned numItems, T_Func& func, unsigned maxThreads = 0)
+{
+    unsigned numThreads = std::min(maxThreads ? maxThreads : getNumWorkerThreads(), numItems);
+    if(numThreads <= 1)
+    {
+        for(unsigned i = 0; i < numItems; i++)
+            func(i);
+        return;
+    }
+    detail::ParallelForQueue<T_Func> queue(func, numItems);
+    boost::thread_group threads;
+    // The current thread works too
+    for(unsigned i = 1; i < numThreads; i++)
+        threads.create_thread(boost::ref(queue));
+    queue();
+    threads.join_all();
+}
+
+} // namespace helpers
+
+#endif // ParallelFor_h__
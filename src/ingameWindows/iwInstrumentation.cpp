@@ -0,0 +1,128 @@
+// Copyright (c) 2016 Settlers Freaks (sf-team at siedler25.org)
+//
+// This file is part of Return To The Roots.
+//
+// Return To The Roots is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 2 of the License, or
+// (at your option) any later version.
+//
+// Return To The Roots is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Return To The Roots. If not, see <http://www.gnu.org/licenses/>.
+
+#include "defines.h" // IWYU pragma: keep
+#include "iwInstrumentation.h"
+#include "Instrumentation.h"
+#include "Loader.h"
+#include "controls/ctrlText.h"
+#include "controls/ctrlTextButton.h"
+#include "files.h"
+#include "ogl/glArchivItem_Font.h"
+#include "gameData/const_gui_ids.h"
+#include "libutil/src/MyTime.h"
+#include "libutil/src/colors.h"
+#include "libutil/src/fileFuncs.h"
+#include <iomanip>
+#include <sstream>
+
+namespace {
+enum
+{
+    ID_btTrace,
+    ID_txtTrace,
+    ID_txtFirstCell // Header row, then one row per subsystem
+};
+const unsigned NUM_COLUMNS = 5;
+const unsigned ROW_HEIGHT = 15;
+/// x-position of each column. The first one is left, the others right aligned
+const unsigned short COLUMN_POS[NUM_COLUMNS] = {15, 175, 235, 310, 395};
+
+std::string FormatMs(unsigned timeInUs)
+{
+    std::stringstream s;
+    s << std::fixed << std::setprecision(2) << timeInUs / 1000.;
+    return s.str();
+}
+} // namespace
+
+iwInstrumentation::iwInstrumentation()
+    : IngameWindow(CGI_INSTRUMENTATION, IngameWindow::posLastOrCenter, Extent(410, 120 + INSTR_COUNT * ROW_HEIGHT), _("Performance"),
+                   LOADER.GetImageN("resource", 41))
+{
+    glArchivItem_Font* font = LOADER.GetFontN("resource", 0);
+    const char* const headers[NUM_COLUMNS] = {"Subsystem", "ms / GF", "max ms", "calls / GF", "count / GF"};
+    for(unsigned row = 0; row <= INSTR_COUNT; row++)
+    {
+        for(unsigned col = 0; col < NUM_COLUMNS; col++)
+        {
+            const unsigned format = (col == 0 ? glArchivItem_Font::DF_LEFT : glArchivItem_Font::DF_RIGHT) | glArchivItem_Font::DF_TOP;
+            std::string text;
+            if(row == 0)
+                text = headers[col];
+            else if(col == 0)
+            {
+                const InstrumentedSubsystem subsystem = InstrumentedSubsystem(row - 1);
+                text = Instrumentation::GetName(subsystem);
+                // The drawing subsystems are shown per frame instead of per GF
+                if(Instrumentation::IsPerFrame(subsystem))
+                    text += _(" (frame)");
+            }
+            AddText(ID_txtFirstCell + row * NUM_COLUMNS + col, DrawPoint(COLUMN_POS[col], 30 + row * ROW_HEIGHT), text,
+                    row == 0 ? COLOR_ORANGE : COLOR_YELLOW, format, font);
+        }
+    }
+    const unsigned short btPosY = GetSize().y - 60;
+    AddTextButton(ID_btTrace, DrawPoint(15, btPosY), Extent(150, 22), TC_GREY, _("Start trace"), NormalFont);
+    AddText(ID_txtTrace, DrawPoint(15, btPosY + 27), "", COLOR_YELLOW, glArchivItem_Font::DF_LEFT | glArchivItem_Font::DF_TOP, font);
+
+    INSTRUMENTATION.Clear();
+    INSTRUMENTATION.SetEnabled(true);
+}
+
+iwInstrumentation::~iwInstrumentation()
+{
+    INSTRUMENTATION.SetEnabled(false);
+}
+
+void iwInstrumentation::Msg_ButtonClick(const unsigned ctrl_id)
+{
+    if(ctrl_id != ID_btTrace)
+        return;
+    ctrlText* txtTrace = GetCtrl<ctrlText>(ID_txtTrace);
+    if(INSTRUMENTATION.IsTracing())
+    {
+        INSTRUMENTATION.StopTrace();
+        GetCtrl<ctrlTextButton>(ID_btTrace)->SetText(_("Start trace"));
+        return;
+    }
+    const std::string filePath = GetFilePath(FILE_PATHS[47]) + TIME.FormatTime("trace_%Y-%m-%d_%H-%i-%s") + ".json";
+    if(INSTRUMENTATION.StartTrace(filePath))
+    {
+        GetCtrl<ctrlTextButton>(ID_btTrace)->SetText(_("Stop trace"));
+        txtTrace->SetText(filePath);
+    } else
+        txtTrace->SetText(_("Could not open the trace file"));
+}
+
+void iwInstrumentation::Msg_PaintBefore()
+{
+    IngameWindow::Msg_PaintBefore();
+    for(unsigned i = 0; i < INSTR_COUNT; i++)
+    {
+        const Instrumentation::Stats avg = INSTRUMENTATION.GetAverage(InstrumentedSubsystem(i));
+        const Instrumentation::Stats max = INSTRUMENTATION.GetMax(InstrumentedSubsystem(i));
+        const unsigned firstCell = ID_txtFirstCell + (i + 1) * NUM_COLUMNS;
+        GetCtrl<ctrlText>(firstCell + 1)->SetText(FormatMs(avg.time));
+        GetCtrl<ctrlText>(firstCell + 2)->SetText(FormatMs(max.time));
+        std::stringstream calls, count;
+        calls << avg.numCalls;
+        count << avg.count;
+        GetCtrl<ctrlText>(firstCell + 3)->SetText(calls.str());
+        GetCtrl<ctrlText>(firstCell + 4)->SetText(count.str());
+    }
+}
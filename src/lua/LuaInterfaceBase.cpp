@@ -47,7 +47,7 @@ unsigned LuaInterfaceBase::GetVersion()
 
 unsigned LuaInterfaceBase::GetFeatureLevel()
 {
-    return 1;
+    return 2;
 }
 
 LuaInterfaceBase::LuaInterfaceBase() : lua(kaguya::NoLoadLib())
@@ -94,7 +94,18 @@ void LuaInterfaceBase::ErrorHandlerThrow(int status, const char* message)
 
 bool LuaInterfaceBase::LoadScript(const std::string& scriptPath)
 {
-    if(!lua.dofile(scriptPath))
+    bool success;
+    try
+    {
+        success = lua.dofile(scriptPath);
+    } catch(...)
+    {
+        // The error handler might throw after parts of the script ran
+        OnScriptExecuted();
+        throw;
+    }
+    OnScriptExecuted();
+    if(!success)
     {
         script_.clear();
         return false;
@@ -108,7 +119,18 @@ bool LuaInterfaceBase::LoadScript(const std::string& scriptPath)
 
 bool LuaInterfaceBase::LoadScriptString(const std::string& script)
 {
-    if(!lua.dostring(script))
+    bool success;
+    try
+    {
+        success = lua.dostring(script);
+    } catch(...)
+    {
+        // The error handler might throw after parts of the script ran
+        OnScriptExecuted();
+        throw;
+    }
+    OnScriptExecuted();
+    if(!success)
     {
         script_.clear();
         return false;
@@ -59,6 +59,9 @@ protected:
     void MsgBoxEx(const std::string& title, const std::string& msg, const std::string& iconFile, unsigned iconIdx);
     void MsgBoxEx2(const std::string& title, const std::string& msg, const std::string& iconFile, unsigned iconIdx, int iconX, int iconY);
 
+    /// Called after a script was loaded (e.g. to clear references to global functions that might have changed)
+    virtual void OnScriptExecuted() {}
+
     static void ErrorHandler(int status, const char* message);
     static void ErrorHandlerThrow(int status, const char* message);
 };
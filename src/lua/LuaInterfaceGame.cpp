@@ -33,7 +33,7 @@
 #include "libutil/src/Serializer.h"
 #include <fstream>
 
-LuaInterfaceGame::LuaInterfaceGame(GameWorldGame& gw) : gw(gw)
+LuaInterfaceGame::LuaInterfaceGame(GameWorldGame& gw) : gw(gw), profiler(lua.state()), nodeCallbacksExecuted(false)
 {
 #pragma region ConstDefs
 #define ADD_LUA_CONST(name) lua[#name] = name
@@ -211,7 +211,10 @@ Serializer LuaInterfaceGame::Serialize()
         lua.setErrorHandler(ErrorHandlerThrow);
         try
         {
-            if(!save.call<bool>(kaguya::standard::ref(luaSaveState)))
+            LuaProfiler::CallbackScope profilerScope(profiler, "onSave");
+            const bool result = save.call<bool>(kaguya::standard::ref(luaSaveState));
+            OnScriptExecuted();
+            if(!result)
             {
                 LOG.write("Lua state could not be saved!");
                 luaSaveState.Clear();
@@ -220,6 +223,7 @@ Serializer LuaInterfaceGame::Serialize()
             return luaSaveState;
         } catch(std::exception& e)
         {
+            OnScriptExecuted();
             lua.setErrorHandler(ErrorHandler);
             LOG.write("Error during saving: %s\n") % e.what();
             if(GLOBALVARS.isTest)
@@ -237,7 +241,13 @@ bool LuaInterfaceGame::Deserialize(Serializer& luaSaveState)
         lua.setErrorHandler(ErrorHandlerThrow);
         try
         {
-            bool result = load.call<bool>(kaguya::standard::ref(luaSaveState));
+            bool result;
+            {
+                LuaProfiler::CallbackScope profilerScope(profiler, "onLoad");
+                result = load.call<bool>(kaguya::standard::ref(luaSaveState));
+            }
+            OnScriptExecuted();
+            profiler.DiscardGF();
             lua.setErrorHandler(ErrorHandler);
             if(result)
                 return true;
@@ -248,6 +258,7 @@ bool LuaInterfaceGame::Deserialize(Serializer& luaSaveState)
             }
         } catch(std::exception& e)
         {
+            OnScriptExecuted();
             lua.setErrorHandler(ErrorHandler);
             LOG.write("Error during loading: %s\n") % e.what();
             if(GLOBALVARS.isTest)
@@ -328,47 +339,159 @@ LuaWorld LuaInterfaceGame::GetWorld()
     return LuaWorld(gw);
 }
 
+namespace {
+// Same order as the enum
+const char* const CALLBACK_NAMES[] = {"onExplored", "onExploredBatch", "onOccupied", "onOccupiedBatch", "onGameFrame", "onResourceFound"};
+} // namespace
+
+kaguya::LuaRef& LuaInterfaceGame::GetCallback(Callback cb)
+{
+    if(callbacks.empty())
+    {
+        callbacks.reserve(NUM_CALLBACKS);
+        for(unsigned i = 0; i < NUM_CALLBACKS; i++)
+            callbacks.push_back(lua[CALLBACK_NAMES[i]]);
+    }
+    return callbacks[cb];
+}
+
+void LuaInterfaceGame::OnNodeCallbackExecuted(Callback cb)
+{
+    // Looking up all callbacks after each node would be slower than not caching them at all.
+    // So only take over changes of the called one directly and the others at the end of the GF
+    if(!callbacks.empty())
+        callbacks[cb] = lua[CALLBACK_NAMES[cb]];
+    nodeCallbacksExecuted = true;
+}
+
+void LuaInterfaceGame::OnScriptExecuted()
+{
+    callbacks.clear();
+    nodeCallbacksExecuted = false;
+}
+
 void LuaInterfaceGame::EventExplored(unsigned player, const MapPoint pt, unsigned char owner)
 {
-    kaguya::LuaRef onExplored = lua["onExplored"];
+    if(HasCallback(CB_EXPLORED_BATCH))
+        exploredBatch.push_back(NodeEvent(player, pt, owner));
+    kaguya::LuaRef& onExplored = GetCallback(CB_EXPLORED);
     if(onExplored.type() == LUA_TFUNCTION)
     {
         if(owner == 0)
         {
+            LuaProfiler::CallbackScope profilerScope(profiler, "onExplored");
             // No owner? Pass nil value to Lua.
             onExplored.call<void>(player, pt.x, pt.y, kaguya::NilValue());
         } else
         {
+            LuaProfiler::CallbackScope profilerScope(profiler, "onExplored");
             // Adapt owner to be comparable with the player index
             onExplored.call<void>(player, pt.x, pt.y, owner - 1);
         }
+        OnNodeCallbackExecuted(CB_EXPLORED);
     }
 }
 
 void LuaInterfaceGame::EventOccupied(unsigned player, const MapPoint pt)
 {
-    kaguya::LuaRef onOccupied = lua["onOccupied"];
+    if(HasCallback(CB_OCCUPIED_BATCH))
+        occupiedBatch.push_back(NodeEvent(player, pt, 0));
+    kaguya::LuaRef& onOccupied = GetCallback(CB_OCCUPIED);
     if(onOccupied.type() == LUA_TFUNCTION)
-        onOccupied.call<void>(player, pt.x, pt.y);
+    {
+        {
+            LuaProfiler::CallbackScope profilerScope(profiler, "onOccupied");
+            onOccupied.call<void>(player, pt.x, pt.y);
+        }
+        OnNodeCallbackExecuted(CB_OCCUPIED);
+    }
 }
 
 void LuaInterfaceGame::EventStart(bool isFirstStart)
 {
     kaguya::LuaRef onStart = lua["onStart"];
     if(onStart.type() == LUA_TFUNCTION)
-        onStart.call<void>(isFirstStart);
+    {
+        {
+            LuaProfiler::CallbackScope profilerScope(profiler, "onStart");
+            onStart.call<void>(isFirstStart);
+        }
+        OnScriptExecuted();
+        // Not part of any GF
+        profiler.DiscardGF();
+    }
 }
 
 void LuaInterfaceGame::EventGameFrame(unsigned nr)
 {
-    kaguya::LuaRef onGameFrame = lua["onGameFrame"];
+    // Take over the callbacks (re)defined by the node callbacks of this GF
+    if(nodeCallbacksExecuted)
+        OnScriptExecuted();
+    kaguya::LuaRef& onGameFrame = GetCallback(CB_GAMEFRAME);
     if(onGameFrame.type() == LUA_TFUNCTION)
-        onGameFrame.call<void>(nr);
+    {
+        {
+            LuaProfiler::CallbackScope profilerScope(profiler, "onGameFrame");
+            onGameFrame.call<void>(nr);
+        }
+        OnScriptExecuted();
+    }
+    // This is the last callback of a GF
+    profiler.EndGF(nr);
 }
 
 void LuaInterfaceGame::EventResourceFound(unsigned char player, const MapPoint pt, unsigned char type, unsigned char quantity)
 {
-    kaguya::LuaRef onResourceFound = lua["onResourceFound"];
+    kaguya::LuaRef& onResourceFound = GetCallback(CB_RESOURCE_FOUND);
     if(onResourceFound.type() == LUA_TFUNCTION)
-        onResourceFound.call<void>(player, pt.x, pt.y, type, quantity);
+    {
+        {
+            LuaProfiler::CallbackScope profilerScope(profiler, "onResourceFound");
+            onResourceFound.call<void>(player, pt.x, pt.y, type, quantity);
+        }
+        OnScriptExecuted();
+    }
+}
+
+void LuaInterfaceGame::SendEventBatches()
+{
+    SendEventBatch(CB_EXPLORED_BATCH, exploredBatch, true);
+    SendEventBatch(CB_OCCUPIED_BATCH, occupiedBatch, false);
+}
+
+void LuaInterfaceGame::SendEventBatch(Callback cb, std::vector<NodeEvent>& batch, bool withOwner)
+{
+    if(batch.empty())
+        return;
+    // Take the events as the callback might cause new ones
+    std::vector<NodeEvent> events;
+    events.swap(batch);
+    for(unsigned player = 0; player < gw.GetPlayerCount(); player++)
+    {
+        // Callback might have been removed by a previous call
+        kaguya::LuaRef& callback = GetCallback(cb);
+        if(callback.type() != LUA_TFUNCTION)
+            break;
+        // Array of {x=, y=[, owner=]} in the order of the events. Owner is nil for unowned nodes as in onExplored
+        kaguya::LuaTable points = lua.newTable();
+        unsigned numPoints = 0;
+        for(std::vector<NodeEvent>::const_iterator it = events.begin(); it != events.end(); ++it)
+        {
+            if(it->player != player)
+                continue;
+            kaguya::LuaTable point = lua.newTable();
+            point["x"] = it->pt.x;
+            point["y"] = it->pt.y;
+            if(withOwner && it->owner != 0)
+                point["owner"] = it->owner - 1;
+            points[++numPoints] = point;
+        }
+        if(!numPoints)
+            continue;
+        {
+            LuaProfiler::CallbackScope profilerScope(profiler, cb == CB_EXPLORED_BATCH ? "onExploredBatch" : "onOccupiedBatch");
+            callback.call<void>(player, points);
+        }
+        OnScriptExecuted();
+    }
 }
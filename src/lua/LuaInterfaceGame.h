@@ -19,8 +19,10 @@
 #define LuaInterfaceGame_h__
 
 #include "LuaInterfaceBase.h"
+#include "LuaProfiler.h"
 #include "gameTypes/MapCoordinates.h"
 #include <string>
+#include <vector>
 
 class GameWorldGame;
 class LuaPlayer;
@@ -43,6 +45,11 @@ public:
     void EventStart(bool isFirstStart);
     void EventGameFrame(unsigned number);
     void EventResourceFound(unsigned char player, const MapPoint pt, unsigned char type, unsigned char quantity);
+    /// Call the batch callbacks (onExploredBatch, onOccupiedBatch) with all nodes explored/occupied since the last call.
+    /// Called once per GF
+    void SendEventBatches();
+
+    LuaProfiler& GetProfiler() { return profiler; }
 
     // Callable from Lua
     void ClearResources();
@@ -55,8 +62,47 @@ public:
     void PostMessageLua(unsigned playerIdx, const std::string& msg);
     void PostMessageWithLocation(unsigned playerIdx, const std::string& msg, int x, int y);
 
+protected:
+    void OnScriptExecuted() override;
+
 private:
+    /// Callbacks of the script that are cached as some of them are called for each changed node
+    enum Callback
+    {
+        CB_EXPLORED,
+        CB_EXPLORED_BATCH,
+        CB_OCCUPIED,
+        CB_OCCUPIED_BATCH,
+        CB_GAMEFRAME,
+        CB_RESOURCE_FOUND,
+        NUM_CALLBACKS
+    };
+    /// Node event waiting for the batch callback
+    struct NodeEvent
+    {
+        unsigned player;
+        MapPoint pt;
+        /// Owner as in the node (0 = none)
+        unsigned char owner;
+        NodeEvent(unsigned player, const MapPoint pt, unsigned char owner) : player(player), pt(pt), owner(owner) {}
+    };
+
     GameWorldGame& gw;
+    LuaProfiler profiler;
+    /// Global functions for all callbacks or empty if they need to be looked up again.
+    /// Cleared whenever Lua code other than the per node callbacks ran as it might have (re)defined callbacks
+    std::vector<kaguya::LuaRef> callbacks;
+    /// True if a per node callback ran since the cache was cleared, which might have (re)defined other callbacks
+    bool nodeCallbacksExecuted;
+    std::vector<NodeEvent> exploredBatch, occupiedBatch;
+
+    /// Return the function for the callback (nil if not defined)
+    kaguya::LuaRef& GetCallback(Callback cb);
+    bool HasCallback(Callback cb) { return GetCallback(cb).type() == LUA_TFUNCTION; }
+    /// Called after the per node callback cb was executed
+    void OnNodeCallbackExecuted(Callback cb);
+    /// Call the batch callback for each player that has events in the batch and clear it
+    void SendEventBatch(Callback cb, std::vector<NodeEvent>& batch, bool withOwner);
 
     LuaPlayer GetPlayer(unsigned playerIdx);
     LuaWorld GetWorld();
@@ -0,0 +1,200 @@
+// Copyright (c) 2016 Settlers Freaks (sf-team at siedler25.org)
+//
+// This file is part of Return To The Roots.
+//
+// Return To The Roots is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 2 of the License, or
+// (at your option) any later version.
+//
+// Return To The Roots is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Return To The Roots. If not, see <http://www.gnu.org/licenses/>.
+
+#include "defines.h" // IWYU pragma: keep
+#include "LuaProfiler.h"
+#include "libutil/src/Log.h"
+#include <kaguya/kaguya.hpp>
+#include <boost/date_time/posix_time/posix_time_types.hpp>
+#include <algorithm>
+#include <sstream>
+#include <utility>
+
+BOOST_CONSTEXPR_OR_CONST unsigned LuaProfiler::SAMPLE_INTERVAL;
+BOOST_CONSTEXPR_OR_CONST unsigned LuaProfiler::DEFAULT_GF_BUDGET;
+BOOST_CONSTEXPR_OR_CONST unsigned LuaProfiler::BUDGET_WARNING_INTERVAL;
+
+namespace {
+/// Key of the profiler in the Lua registry (used by the hook)
+const char* const REGISTRY_KEY = "RTTR_LuaProfiler";
+
+boost::posix_time::ptime GetTime()
+{
+    return boost::posix_time::microsec_clock::universal_time();
+}
+
+struct CmpSamples
+{
+    bool operator()(const std::pair<std::string, unsigned>& lhs, const std::pair<std::string, unsigned>& rhs) const
+    {
+        if(lhs.second != rhs.second)
+            return lhs.second > rhs.second;
+        return lhs.first < rhs.first;
+    }
+};
+
+void WriteSamples(std::ostream& out, const std::map<std::string, unsigned>& samples, unsigned maxEntries)
+{
+    std::vector<std::pair<std::string, unsigned> > sortedSamples(samples.begin(), samples.end());
+    std::sort(sortedSamples.begin(), sortedSamples.end(), CmpSamples());
+    if(sortedSamples.size() > maxEntries)
+        sortedSamples.resize(maxEntries);
+    for(std::vector<std::pair<std::string, unsigned> >::const_iterator it = sortedSamples.begin(); it != sortedSamples.end(); ++it)
+        out << "  " << it->first << ": " << it->second << "\n";
+}
+} // namespace
+
+LuaProfiler::LuaProfiler(lua_State* state)
+    : state(state), isEnabled(false), gfBudget(DEFAULT_GF_BUDGET), instructionsInGF(0), lastWarningGF(0), wasWarned(false)
+{
+    lua_pushlightuserdata(state, this);
+    lua_setfield(state, LUA_REGISTRYINDEX, REGISTRY_KEY);
+    UpdateHook();
+}
+
+LuaProfiler::~LuaProfiler()
+{
+    lua_sethook(state, NULL, 0, 0);
+    lua_pushnil(state);
+    lua_setfield(state, LUA_REGISTRYINDEX, REGISTRY_KEY);
+}
+
+void LuaProfiler::SetEnabled(bool enabled)
+{
+    isEnabled = enabled;
+    UpdateHook();
+}
+
+void LuaProfiler::SetGFBudget(unsigned maxInstructions)
+{
+    gfBudget = maxInstructions;
+    UpdateHook();
+}
+
+void LuaProfiler::UpdateHook()
+{
+    if(isEnabled || gfBudget)
+        lua_sethook(state, Hook, LUA_MASKCOUNT, SAMPLE_INTERVAL);
+    else
+        lua_sethook(state, NULL, 0, 0);
+}
+
+void LuaProfiler::Hook(lua_State* L, lua_Debug* ar)
+{
+    lua_getfield(L, LUA_REGISTRYINDEX, REGISTRY_KEY);
+    LuaProfiler* profiler = static_cast<LuaProfiler*>(lua_touserdata(L, -1));
+    lua_pop(L, 1);
+    if(profiler)
+        profiler->OnSample(L, *ar);
+}
+
+void LuaProfiler::OnSample(lua_State* L, lua_Debug& ar)
+{
+    // Only instructions of callbacks count, not the ones from loading the script
+    if(activeCallbacks.empty())
+        return;
+    instructionsInGF += SAMPLE_INTERVAL;
+    callbackInstructionsInGF[activeCallbacks.back().name] += SAMPLE_INTERVAL;
+    if(!isEnabled)
+        return;
+    callbackStats[activeCallbacks.back().name].numInstructions += SAMPLE_INTERVAL;
+    // L might be a coroutine of the state
+    if(!lua_getinfo(L, "nSl", &ar))
+        return;
+    std::stringstream function, line;
+    function << ar.short_src << ":" << ar.linedefined;
+    if(ar.name)
+        function << " (" << ar.name << ")";
+    line << ar.short_src << ":" << ar.currentline;
+    functionSamples[function.str()]++;
+    lineSamples[line.str()]++;
+}
+
+void LuaProfiler::BeginCallback(const char* name)
+{
+    ActiveCallback callback;
+    callback.name = name;
+    if(isEnabled)
+        callback.startTime = GetTime();
+    activeCallbacks.push_back(callback);
+}
+
+void LuaProfiler::EndCallback()
+{
+    RTTR_Assert(!activeCallbacks.empty());
+    if(isEnabled && !activeCallbacks.back().startTime.is_not_a_date_time())
+    {
+        const boost::posix_time::time_duration duration = GetTime() - activeCallbacks.back().startTime;
+        CallbackStats& stats = callbackStats[activeCallbacks.back().name];
+        stats.numCalls++;
+        stats.totalTime += duration;
+        stats.maxTime = std::max(stats.maxTime, duration);
+    }
+    activeCallbacks.pop_back();
+}
+
+void LuaProfiler::EndGF(unsigned gf)
+{
+    if(gfBudget && instructionsInGF > gfBudget && (!wasWarned || gf >= lastWarningGF + BUDGET_WARNING_INTERVAL))
+    {
+        // The callback with the most instructions (the first one if equal)
+        std::map<std::string, unsigned>::const_iterator offender = callbackInstructionsInGF.begin();
+        for(std::map<std::string, unsigned>::const_iterator it = callbackInstructionsInGF.begin(); it != callbackInstructionsInGF.end();
+            ++it)
+        {
+            if(it->second > offender->second)
+                offender = it;
+        }
+        RTTR_Assert(offender != callbackInstructionsInGF.end());
+        LOG.write("Lua script exceeded its budget in GF %1%: about %2% instructions (budget: %3%), %4% instructions in %5%\n") % gf
+          % instructionsInGF % gfBudget % offender->second % offender->first;
+        lastWarningGF = gf;
+        wasWarned = true;
+    }
+    DiscardGF();
+}
+
+void LuaProfiler::DiscardGF()
+{
+    instructionsInGF = 0;
+    callbackInstructionsInGF.clear();
+}
+
+std::string LuaProfiler::GetReport(unsigned maxEntries) const
+{
+    std::stringstream report;
+    report << "Lua profile\n";
+    report << "Callbacks (calls, total ms, max ms, instructions):\n";
+    for(std::map<std::string, CallbackStats>::const_iterator it = callbackStats.begin(); it != callbackStats.end(); ++it)
+    {
+        const CallbackStats& stats = it->second;
+        report << "  " << it->first << ": " << stats.numCalls << ", " << stats.totalTime.total_microseconds() / 1000. << ", "
+               << stats.maxTime.total_microseconds() / 1000. << ", " << stats.numInstructions << "\n";
+    }
+    report << "Functions (samples every " << SAMPLE_INTERVAL << " instructions):\n";
+    WriteSamples(report, functionSamples, maxEntries);
+    report << "Lines:\n";
+    WriteSamples(report, lineSamples, maxEntries);
+    return report.str();
+}
+
+void LuaProfiler::Reset()
+{
+    callbackStats.clear();
+    functionSamples.clear();
+    lineSamples.clear();
+}
@@ -0,0 +1,114 @@
+// Copyright (c) 2016 Settlers Freaks (sf-team at siedler25.org)
+//
+// This file is part of Return To The Roots.
+//
+// Return To The Roots is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 2 of the License, or
+// (at your option) any later version.
+//
+// Return To The Roots is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Return To The Roots. If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef LuaProfiler_h__
+#define LuaProfiler_h__
+
+#include <boost/date_time/posix_time/posix_time_types.hpp>
+#include <map>
+#include <string>
+#include <vector>
+
+struct lua_Debug;
+struct lua_State;
+
+/// Profiler for the callbacks (onGameFrame, onExplored...) of a Lua script.
+/// Every SAMPLE_INTERVAL executed VM instructions a hook samples the current function and line.
+/// The instruction counts are also used for a per GF budget: They are the same on all clients
+/// (unlike times) so the warning about a script exceeding it is reproducible. It is only logged,
+/// the game is never changed by the profiler.
+class LuaProfiler
+{
+public:
+    /// Number of instructions between 2 samples
+    BOOST_STATIC_CONSTEXPR unsigned SAMPLE_INTERVAL = 1000;
+    /// Default budget: About 1-5ms depending on the machine
+    BOOST_STATIC_CONSTEXPR unsigned DEFAULT_GF_BUDGET = 1000000;
+    /// Minimum number of GFs between 2 budget warnings
+    BOOST_STATIC_CONSTEXPR unsigned BUDGET_WARNING_INTERVAL = 250;
+
+    explicit LuaProfiler(lua_State* state);
+    ~LuaProfiler();
+
+    /// Enable collecting the statistics of the callbacks, functions and lines
+    void SetEnabled(bool enabled);
+    bool IsEnabled() const { return isEnabled; }
+    /// Set the maximum number of instructions (in steps of SAMPLE_INTERVAL) executed by the callbacks per GF. 0 = unlimited
+    void SetGFBudget(unsigned maxInstructions);
+    unsigned GetGFBudget() const { return gfBudget; }
+
+    /// Mark the start/end of a call into Lua for the given callback. Calls may be nested
+    void BeginCallback(const char* name);
+    void EndCallback();
+    /// Called at the end of each GF. Logs a warning if the budget was exceeded
+    void EndGF(unsigned gf);
+    /// Forget the instructions of the current GF (e.g. for callbacks not belonging to a GF like onStart)
+    void DiscardGF();
+
+    /// Return the number of instructions executed in the current GF (in steps of SAMPLE_INTERVAL)
+    unsigned GetNumInstructionsInGF() const { return instructionsInGF; }
+    /// Return a human readable report of the collected statistics with at most maxEntries per category
+    std::string GetReport(unsigned maxEntries = 20) const;
+    /// Clear all collected statistics
+    void Reset();
+
+    /// Calls Begin/EndCallback for the lifetime of this object
+    class CallbackScope
+    {
+        LuaProfiler& profiler;
+
+    public:
+        CallbackScope(LuaProfiler& profiler, const char* name) : profiler(profiler) { profiler.BeginCallback(name); }
+        ~CallbackScope() { profiler.EndCallback(); }
+    };
+
+private:
+    struct CallbackStats
+    {
+        unsigned numCalls;
+        boost::posix_time::time_duration totalTime, maxTime;
+        unsigned long long numInstructions;
+        CallbackStats() : numCalls(0), numInstructions(0) {}
+    };
+    struct ActiveCallback
+    {
+        std::string name;
+        boost::posix_time::ptime startTime;
+    };
+
+    lua_State* state;
+    bool isEnabled;
+    unsigned gfBudget;
+    /// Callbacks currently executed, innermost last
+    std::vector<ActiveCallback> activeCallbacks;
+    std::map<std::string, CallbackStats> callbackStats;
+    /// Number of samples per function ("source:line of definition (name)") and per line ("source:line")
+    std::map<std::string, unsigned> functionSamples, lineSamples;
+    unsigned instructionsInGF;
+    /// Instructions per callback in the current GF, to find the offender when the budget is exceeded
+    std::map<std::string, unsigned> callbackInstructionsInGF;
+    /// GF of the last budget warning
+    unsigned lastWarningGF;
+    bool wasWarned;
+
+    /// Set or remove the hook depending on whether anything needs to be counted
+    void UpdateHook();
+    void OnSample(lua_State* L, lua_Debug& ar);
+    static void Hook(lua_State* L, lua_Debug* ar);
+};
+
+#endif // LuaProfiler_h__
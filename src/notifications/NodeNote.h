@@ -28,7 +28,12 @@ struct NodeNote
     enum Type
     {
         Altitude, // Nodes altitude was changed
-        BQ        // Building quality
+        BQ,       // Building quality
+        Owner,    // Owner of the node (territory)
+        Resource, // Subsurface resource (e.g. reduced by mining)
+        Road,     // Road from this node
+        Object,   // Static object on the node (e.g. tree, granite, building)
+        Border    // Border stone on the node
     };
 
     NodeNote(Type type, const MapPoint& pt) : type(type), pt(pt) {}
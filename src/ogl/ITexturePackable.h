@@ -0,0 +1,39 @@
+// Copyright (c) 2016 Settlers Freaks (sf-team at siedler25.org)
+//
+// This file is part of Return To The Roots.
+//
+// Return To The Roots is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 2 of the License, or
+// (at your option) any later version.
+//
+// Return To The Roots is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Return To The Roots. If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef ITexturePackable_h__
+#define ITexturePackable_h__
+
+#include "Point.h"
+#include <stdint.h>
+#include <vector>
+
+/// Interface for images that can be packed into a shared texture (atlas) by the glTexturePacker
+class ITexturePackable
+{
+public:
+    virtual ~ITexturePackable() {}
+    /// Return the size required in the shared texture or (0, 0) if it cannot be packed
+    virtual Extent GetPackedSize() = 0;
+    /// Draw the image into the BGRA buffer (of size bufSize) with the top left corner at pos
+    virtual void DrawToBuffer(std::vector<uint32_t>& buffer, const Extent& bufSize, const Extent& pos) = 0;
+    /// Use the given shared texture (of size texSize) in which the image is at pos.
+    /// Texture 0 resets it so it creates its own texture again
+    virtual void SetSharedTexture(unsigned texture, const Extent& texSize, const Extent& pos) = 0;
+};
+
+#endif // ITexturePackable_h__
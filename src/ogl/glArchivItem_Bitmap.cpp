@@ -18,7 +18,7 @@
 #include "defines.h" // IWYU pragma: keep
 #include "glArchivItem_Bitmap.h"
 #include "Point.h"
-#include "drivers/VideoDriverWrapper.h"
+#include "ogl/glSpriteBatch.h"
 #include "ogl/oglIncludes.h"
 #include <vector>
 
@@ -66,18 +66,15 @@ void glArchivItem_Bitmap::Draw(Rect dstArea, Rect srcArea, unsigned color /*= CO
     vertices[0].y = vertices[3].y = GLfloat(dstArea.top);
     vertices[1].y = vertices[2].y = GLfloat(dstArea.bottom);
 
-    Point<GLfloat> srcOrig = Point<GLfloat>(srcArea.getOrigin()) / GetTexSize();
-    Point<GLfloat> srcEndPt = Point<GLfloat>(srcArea.getEndPt()) / GetTexSize();
+    const Point<GLfloat> texOrigin(GetTexOrigin());
+    Point<GLfloat> srcOrig = (Point<GLfloat>(srcArea.getOrigin()) + texOrigin) / GetTexSize();
+    Point<GLfloat> srcEndPt = (Point<GLfloat>(srcArea.getEndPt()) + texOrigin) / GetTexSize();
     texCoords[0].x = texCoords[1].x = srcOrig.x;
     texCoords[2].x = texCoords[3].x = srcEndPt.x;
     texCoords[0].y = texCoords[3].y = srcOrig.y;
     texCoords[1].y = texCoords[2].y = srcEndPt.y;
 
-    glVertexPointer(2, GL_FLOAT, 0, vertices);
-    glTexCoordPointer(2, GL_FLOAT, 0, texCoords);
-    VIDEODRIVER.BindTexture(GetTexture());
-    glColor4ub(GetRed(color), GetGreen(color), GetBlue(color), GetAlpha(color));
-    glDrawArrays(GL_QUADS, 0, 4);
+    SPRITEBATCH.Add(GetTexture(), vertices, texCoords, color, 4);
 }
 
 void glArchivItem_Bitmap::DrawFull(const Rect& destArea, unsigned color)
@@ -125,3 +122,14 @@ Extent glArchivItem_Bitmap::CalcTextureSize() const
 {
     return VIDEODRIVER.calcPreferredTextureSize(GetSize());
 }
+
+Extent glArchivItem_Bitmap::CalcPackedSize() const
+{
+    return GetSize();
+}
+
+void glArchivItem_Bitmap::DrawToBuffer(std::vector<uint32_t>& buffer, const Extent& bufSize, const Extent& pos)
+{
+    InitPalette();
+    print(reinterpret_cast<unsigned char*>(&buffer.front()), bufSize.x, bufSize.y, libsiedler2::FORMAT_BGRA, NULL, pos.x, pos.y);
+}
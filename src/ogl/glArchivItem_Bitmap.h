@@ -49,6 +49,8 @@ public:
     /// image->getHeight() * percent / 100), 0, image->getHeight() * percent / 100)
     void DrawPercent(const DrawPoint& dstPos, unsigned percent, unsigned color = COLOR_WHITE);
 
+    void DrawToBuffer(std::vector<uint32_t>& buffer, const Extent& bufSize, const Extent& pos) override;
+
 protected:
     /// Draw the texture.
     /// src_w/h default to the full bitmap size
@@ -56,6 +58,7 @@ protected:
     void Draw(Rect dstArea, Rect srcArea, unsigned color = COLOR_WHITE);
     void FillTexture() override;
     Extent CalcTextureSize() const override;
+    Extent CalcPackedSize() const override;
 };
 
 #endif // !GLARCHIVITEM_BITMAP_INCLUDED
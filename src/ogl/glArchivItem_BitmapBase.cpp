@@ -31,12 +31,14 @@
  *  OpenGL-Textur des Bildes.
  */
 
-glArchivItem_BitmapBase::glArchivItem_BitmapBase() : texture(0), textureSize_(0, 0), filter(GL_NEAREST)
+glArchivItem_BitmapBase::glArchivItem_BitmapBase()
+    : texture(0), textureSize_(0, 0), texOrigin_(0, 0), isTexShared_(false), filter(GL_NEAREST)
 {
 }
 
 glArchivItem_BitmapBase::glArchivItem_BitmapBase(const glArchivItem_BitmapBase& item)
-    : ArchivItem_BitmapBase(item), texture(0), textureSize_(item.textureSize_), filter(item.filter)
+    : ArchivItem_BitmapBase(item), texture(0), textureSize_(item.textureSize_), texOrigin_(0, 0), isTexShared_(false),
+      filter(item.filter)
 {
 }
 
@@ -60,9 +62,31 @@ unsigned glArchivItem_BitmapBase::GetTexture()
  */
 void glArchivItem_BitmapBase::DeleteTexture()
 {
-    VIDEODRIVER.DeleteTexture(texture);
-    // glDeleteTextures(1, (const GLuint*)&texture);
+    // Shared textures are deleted by their owner
+    if(!isTexShared_)
+        VIDEODRIVER.DeleteTexture(texture);
     texture = 0;
+    texOrigin_ = Extent(0, 0);
+    isTexShared_ = false;
+}
+
+Extent glArchivItem_BitmapBase::GetPackedSize()
+{
+    // Only the default filter is used for shared textures
+    if(filter != GL_NEAREST)
+        return Extent(0, 0);
+    return CalcPackedSize();
+}
+
+void glArchivItem_BitmapBase::SetSharedTexture(unsigned texture, const Extent& texSize, const Extent& pos)
+{
+    DeleteTexture();
+    if(!texture)
+        return;
+    this->texture = texture;
+    textureSize_ = texSize;
+    texOrigin_ = pos;
+    isTexShared_ = true;
 }
 
 /**
@@ -97,17 +121,35 @@ void glArchivItem_BitmapBase::GenerateTexture()
 
     texture = VIDEODRIVER.GenerateTexture();
 
-    if(!getPalette() && getFormat() == libsiedler2::FORMAT_PALETTED)
-        setPaletteCopy(*LOADER.GetPaletteN("pal5"));
+    InitPalette();
 
     VIDEODRIVER.BindTexture(texture);
 
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, filter);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, filter);
+    if(filter == GL_NEAREST_MIPMAP_NEAREST || filter == GL_NEAREST_MIPMAP_LINEAR)
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    else if(filter == GL_LINEAR_MIPMAP_NEAREST || filter == GL_LINEAR_MIPMAP_LINEAR)
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    else
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, filter);
+    // Let the driver create the smaller versions (also on every update of the texture)
+    if(HasMipmaps())
+        glTexParameteri(GL_TEXTURE_2D, GL_GENERATE_MIPMAP, GL_TRUE);
 
     FillTexture();
 }
 
+bool glArchivItem_BitmapBase::HasMipmaps() const
+{
+    return filter != GL_NEAREST && filter != GL_LINEAR;
+}
+
+void glArchivItem_BitmapBase::InitPalette()
+{
+    if(!getPalette() && getFormat() == libsiedler2::FORMAT_PALETTED)
+        setPaletteCopy(*LOADER.GetPaletteN("pal5"));
+}
+
 int glArchivItem_BitmapBase::GetInternalFormat() const
 {
     return GL_RGBA;
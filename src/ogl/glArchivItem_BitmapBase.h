@@ -20,9 +20,10 @@
 #pragma once
 
 #include "DrawPoint.h"
+#include "ogl/ITexturePackable.h"
 #include "libsiedler2/src/ArchivItem_Bitmap.h"
 
-class glArchivItem_BitmapBase : public virtual libsiedler2::ArchivItem_BitmapBase
+class glArchivItem_BitmapBase : public virtual libsiedler2::ArchivItem_BitmapBase, public ITexturePackable
 {
 public:
     glArchivItem_BitmapBase();
@@ -34,12 +35,18 @@ public:
     /// Löscht die GL-Textur (z.B fürs Neuerstellen)
     virtual void DeleteTexture();
     /// Setzt den Texturfilter auf einen bestimmten Wert.
+    /// With a mipmap filter (e.g. GL_LINEAR_MIPMAP_LINEAR) downscaled versions of the texture are created too
     virtual void setFilter(unsigned filter);
 
     /// Return the "Null point"
     DrawPoint GetOrigin() const { return DrawPoint(nx_, ny_); }
     Extent GetSize() const { return Extent(getWidth(), getHeight()); }
     Extent GetTexSize() const;
+    /// Return the position of the image in the texture (not (0, 0) for shared textures)
+    Extent GetTexOrigin() const { return texOrigin_; }
+
+    Extent GetPackedSize() override;
+    void SetSharedTexture(unsigned texture, const Extent& texSize, const Extent& pos) override;
 
 private:
     /// Erzeugt die Textur.
@@ -47,6 +54,8 @@ private:
 
     unsigned texture;    /// Das GL-Textur-Handle
     Extent textureSize_; /// The size of the texture. Only valid when texture exists
+    Extent texOrigin_;   /// Position of the image in the texture
+    bool isTexShared_;   /// True if the texture is owned by a glTexturePacker
     unsigned filter;     /// Der aktuell gewählte Texturfilter
 
 protected:
@@ -56,8 +65,14 @@ protected:
     virtual void FillTexture() = 0;
     /// Calculate the actual texture size
     virtual Extent CalcTextureSize() const = 0;
+    /// Calculate the size required in a shared texture or (0, 0) if the image cannot use one
+    virtual Extent CalcPackedSize() const = 0;
+    /// Set the default palette for paletted images without one
+    void InitPalette();
     /// Returns the currently set texture or 0 if none created
     unsigned GetTexNoCreate() { return texture; }
+    /// True if the driver generates the smaller versions of the texture (on every update)
+    bool HasMipmaps() const;
 };
 
 #endif // GLARCHIVITEM_BITMAPBASE_H_INCLUDED
@@ -20,6 +20,7 @@
 #include "drivers/VideoDriverWrapper.h"
 #include "ogl/oglIncludes.h"
 #include "libsiedler2/src/PixelBufferARGB.h"
+#include <algorithm>
 #include <stdexcept>
 
 glArchivItem_Bitmap_Direct::glArchivItem_Bitmap_Direct() : isUpdating_(false)
@@ -36,7 +37,7 @@ void glArchivItem_Bitmap_Direct::beginUpdate()
     if(isUpdating_)
         throw std::logic_error("Already updating! Forgot an endUpdate?");
     isUpdating_ = true;
-    areaToUpdate_ = Rect(0, 0, 0, 0);
+    changedRows_.clear();
 }
 
 void glArchivItem_Bitmap_Direct::endUpdate()
@@ -45,15 +46,46 @@ void glArchivItem_Bitmap_Direct::endUpdate()
         throw std::logic_error("Already updating! Forgot an endUpdate?");
     isUpdating_ = false;
     // Nothing to update or no texture created yet
-    if(prodOfComponents(areaToUpdate_.getSize()) == 0 || !GetTexNoCreate())
+    if(changedRows_.empty() || !GetTexNoCreate())
         return;
 
-    libsiedler2::PixelBufferARGB buffer(areaToUpdate_.getSize().x, areaToUpdate_.getSize().y);
-    Position origin = areaToUpdate_.getOrigin();
-    int ec = print(buffer.getPixelPtr(), buffer.getWidth(), buffer.getHeight(), libsiedler2::FORMAT_BGRA, NULL, 0, 0, origin.x, origin.y);
+    // Upload each block of consecutive changed rows. Unchanged rows in between are skipped.
+    // Every upload regenerates all mipmaps, so for those textures only the bounding rect of all blocks is uploaded
+    const bool uploadOnce = HasMipmaps();
+    const int numRows = static_cast<int>(changedRows_.size());
+    int firstRow = -1, lastRow = 0, left = 0, right = 0;
+    for(int y = 0; y <= numRows; y++)
+    {
+        if(y == numRows || changedRows_[y].isEmpty())
+        {
+            if(firstRow >= 0 && (!uploadOnce || y == numRows))
+            {
+                uploadRows(firstRow, lastRow, left, right);
+                firstRow = -1;
+            }
+        } else if(firstRow < 0)
+        {
+            firstRow = y;
+            lastRow = y + 1;
+            left = changedRows_[y].left;
+            right = changedRows_[y].right;
+        } else
+        {
+            lastRow = y + 1;
+            left = std::min(left, changedRows_[y].left);
+            right = std::max(right, changedRows_[y].right);
+        }
+    }
+    changedRows_.clear();
+}
+
+void glArchivItem_Bitmap_Direct::uploadRows(int firstRow, int lastRow, int left, int right)
+{
+    libsiedler2::PixelBufferARGB buffer(right - left, lastRow - firstRow);
+    int ec = print(buffer.getPixelPtr(), buffer.getWidth(), buffer.getHeight(), libsiedler2::FORMAT_BGRA, NULL, 0, 0, left, firstRow);
     RTTR_Assert(ec == 0);
     VIDEODRIVER.BindTexture(GetTexNoCreate());
-    glTexSubImage2D(GL_TEXTURE_2D, 0, origin.x, origin.y, buffer.getWidth(), buffer.getHeight(), GL_BGRA, GL_UNSIGNED_BYTE,
+    glTexSubImage2D(GL_TEXTURE_2D, 0, left, firstRow, buffer.getWidth(), buffer.getHeight(), GL_BGRA, GL_UNSIGNED_BYTE,
                     buffer.getPixelPtr());
 }
 
@@ -63,19 +95,16 @@ void glArchivItem_Bitmap_Direct::updatePixel(const DrawPoint& pos, const libsied
     RTTR_Assert(pos.x >= 0 && pos.y >= 0);
     RTTR_Assert(static_cast<unsigned>(pos.x) < GetSize().x && static_cast<unsigned>(pos.y) < GetSize().y);
     setPixel(pos.x, pos.y, clr);
-    // If the area is empty, create one
-    if(areaToUpdate_.getSize().x == 0)
-        areaToUpdate_ = Rect(Position(pos), Extent(1, 1));
-    else
+    if(changedRows_.empty())
+        changedRows_.resize(GetSize().y);
+    RowSpan& row = changedRows_[pos.y];
+    if(row.isEmpty())
+    {
+        row.left = pos.x;
+        row.right = pos.x + 1;
+    } else
     {
-        // Else resize if required
-        if(pos.x < areaToUpdate_.left)
-            areaToUpdate_.left = pos.x;
-        if(pos.x >= areaToUpdate_.right)
-            areaToUpdate_.right = pos.x + 1;
-        if(pos.y < areaToUpdate_.top)
-            areaToUpdate_.top = pos.y;
-        if(pos.y >= areaToUpdate_.bottom)
-            areaToUpdate_.bottom = pos.y + 1;
+        row.left = std::min<int>(row.left, pos.x);
+        row.right = std::max<int>(row.right, pos.x + 1);
     }
 }
@@ -21,6 +21,7 @@
 
 #include "Rect.h"
 #include "glArchivItem_Bitmap.h"
+#include <vector>
 
 namespace libsiedler2 {
 struct ColorARGB;
@@ -36,7 +37,7 @@ public:
 
     /// Call before updating texture
     void beginUpdate();
-    /// Call after updating texture
+    /// Call after updating texture. Only the changed rows are uploaded
     void endUpdate();
     /// Updates a pixels color
     void updatePixel(const DrawPoint& pos, const libsiedler2::ColorARGB& clr);
@@ -46,9 +47,24 @@ public:
     /// schreibt die Bilddaten in eine Datei.
     int write(std::ostream& /*file*/, const libsiedler2::ArchivItem_Palette* /*palette*/) const override { return 254; }
 
+protected:
+    /// The texture is updated directly so it cannot be shared
+    Extent CalcPackedSize() const override { return Extent(0, 0); }
+
 private:
+    /// Changed pixels [left, right) of a row
+    struct RowSpan
+    {
+        int left, right;
+        RowSpan() : left(0), right(0) {}
+        bool isEmpty() const { return left >= right; }
+    };
+
+    /// Upload the given rows [firstRow, lastRow) and the union of their changed pixels
+    void uploadRows(int firstRow, int lastRow, int left, int right);
+
     bool isUpdating_;
-    Rect areaToUpdate_;
+    std::vector<RowSpan> changedRows_;
 };
 
 #endif // !GLARCHIVITEM_BITMAP_DIRECT_H_INCLUDED
@@ -20,6 +20,7 @@
 #include "Loader.h"
 #include "Point.h"
 #include "drivers/VideoDriverWrapper.h"
+#include "ogl/glSpriteBatch.h"
 #include "oglIncludes.h"
 #include <vector>
 
@@ -29,6 +30,19 @@ Extent glArchivItem_Bitmap_Player::CalcTextureSize() const
     return VIDEODRIVER.calcPreferredTextureSize(Extent(GetSize().x * 2, GetSize().y));
 }
 
+Extent glArchivItem_Bitmap_Player::CalcPackedSize() const
+{
+    return Extent(GetSize().x * 2, GetSize().y);
+}
+
+void glArchivItem_Bitmap_Player::DrawToBuffer(std::vector<uint32_t>& buffer, const Extent& bufSize, const Extent& pos)
+{
+    const libsiedler2::ArchivItem_Palette* palette = LOADER.GetPaletteN("colors");
+    unsigned char* data = reinterpret_cast<unsigned char*>(&buffer.front());
+    print(data, bufSize.x, bufSize.y, libsiedler2::FORMAT_BGRA, palette, 128, pos.x, pos.y, 0, 0, 0, 0, false);
+    print(data, bufSize.x, bufSize.y, libsiedler2::FORMAT_BGRA, palette, 128, pos.x + GetSize().x, pos.y, 0, 0, 0, 0, true);
+}
+
 void glArchivItem_Bitmap_Player::DrawFull(const Rect& destArea, unsigned color, unsigned player_color)
 {
     Draw(destArea, Rect(Position::all(0), GetSize()), color, player_color);
@@ -69,8 +83,9 @@ void glArchivItem_Bitmap_Player::Draw(Rect dstArea, Rect srcArea, unsigned color
     vertices[0].y = vertices[3].y = GLfloat(dstArea.top);
     vertices[1].y = vertices[2].y = GLfloat(dstArea.bottom);
 
-    Point<GLfloat> srcOrig = Point<GLfloat>(srcArea.getOrigin()) / GetTexSize();
-    Point<GLfloat> srcEndPt = Point<GLfloat>(srcArea.getEndPt()) / GetTexSize();
+    const Point<GLfloat> texOrigin(GetTexOrigin());
+    Point<GLfloat> srcOrig = (Point<GLfloat>(srcArea.getOrigin()) + texOrigin) / GetTexSize();
+    Point<GLfloat> srcEndPt = (Point<GLfloat>(srcArea.getEndPt()) + texOrigin) / GetTexSize();
     texCoords[0].x = texCoords[1].x = srcOrig.x;
     texCoords[2].x = texCoords[3].x = srcEndPt.x;
     texCoords[0].y = texCoords[3].y = srcOrig.y;
@@ -79,15 +94,14 @@ void glArchivItem_Bitmap_Player::Draw(Rect dstArea, Rect srcArea, unsigned color
     std::copy(vertices, vertices + 4, vertices + 4);
     std::copy(texCoords, texCoords + 4, texCoords + 4);
 
-    texCoords[4].x += 0.5f;
-    texCoords[5].x += 0.5f;
-    texCoords[6].x += 0.5f;
-    texCoords[7].x += 0.5f;
+    // Player colors are right of the image
+    const GLfloat playerOffset = static_cast<GLfloat>(GetSize().x) / GetTexSize().x;
+    texCoords[4].x += playerOffset;
+    texCoords[5].x += playerOffset;
+    texCoords[6].x += playerOffset;
+    texCoords[7].x += playerOffset;
 
-    struct
-    {
-        GLbyte r, g, b, a;
-    } colors[8];
+    glSpriteBatch::Color colors[8];
     colors[0].r = GetRed(color);
     colors[0].g = GetGreen(color);
     colors[0].b = GetBlue(color);
@@ -100,13 +114,7 @@ void glArchivItem_Bitmap_Player::Draw(Rect dstArea, Rect srcArea, unsigned color
     colors[4].a = GetAlpha(player_color);
     colors[7] = colors[6] = colors[5] = colors[4];
 
-    glEnableClientState(GL_COLOR_ARRAY);
-    glVertexPointer(2, GL_FLOAT, 0, vertices);
-    glTexCoordPointer(2, GL_FLOAT, 0, texCoords);
-    glColorPointer(4, GL_UNSIGNED_BYTE, 0, colors);
-    VIDEODRIVER.BindTexture(GetTexture());
-    glDrawArrays(GL_QUADS, 0, 8);
-    glDisableClientState(GL_COLOR_ARRAY);
+    SPRITEBATCH.Add(GetTexture(), vertices, texCoords, colors, 8);
 }
 
 void glArchivItem_Bitmap_Player::FillTexture()
@@ -121,6 +129,6 @@ void glArchivItem_Bitmap_Player::FillTexture()
     std::vector<unsigned char> buffer(prodOfComponents(texSize) * 4);
 
     print(&buffer.front(), texSize.x, texSize.y, libsiedler2::FORMAT_BGRA, palette, 128, 0, 0, 0, 0, 0, 0, false);
-    print(&buffer.front(), texSize.x, texSize.y, libsiedler2::FORMAT_BGRA, palette, 128, texSize.x / 2u, 0, 0, 0, 0, 0, true);
+    print(&buffer.front(), texSize.x, texSize.y, libsiedler2::FORMAT_BGRA, palette, 128, GetSize().x, 0, 0, 0, 0, 0, true);
     glTexImage2D(GL_TEXTURE_2D, 0, iformat, texSize.x, texSize.y, 0, dformat, GL_UNSIGNED_BYTE, &buffer.front());
 }
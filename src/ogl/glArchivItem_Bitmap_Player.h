@@ -43,10 +43,14 @@ public:
     /// equivalent to Draw(dst, 0, 0, 0, 0, 0, 0, color, player_color)
     void DrawFull(const DrawPoint& dst, unsigned color = COLOR_WHITE, unsigned player_color = COLOR_WHITE);
 
+    /// Draws the image and the player colors right of it
+    void DrawToBuffer(std::vector<uint32_t>& buffer, const Extent& bufSize, const Extent& pos) override;
+
 protected:
     void Draw(Rect dstArea, Rect srcArea, unsigned color = COLOR_WHITE, unsigned player_color = COLOR_WHITE);
     void FillTexture() override;
     Extent CalcTextureSize() const override;
+    Extent CalcPackedSize() const override;
 };
 
 #endif // !GLARCHIVITEM_BITMAP_PLAYER_H_INCLUDED
@@ -23,6 +23,7 @@
 #include "drivers/VideoDriverWrapper.h"
 #include "glArchivItem_Bitmap.h"
 #include "helpers/containerUtils.h"
+#include "ogl/glSpriteBatch.h"
 #include "libsiedler2/src/ArchivItem_Bitmap_Player.h"
 #include "libsiedler2/src/IAllocator.h"
 #include "libsiedler2/src/libsiedler2.h"
@@ -98,13 +99,19 @@ T_Iterator nextIt(T_Iterator it)
 
 //////////////////////////////////////////////////////////////////////////
 
-glArchivItem_Font::glArchivItem_Font() : ArchivItem_Font(), fontNoOutline(NULL), fontWithOutline(NULL)
+/// Number of texts per font whose glyphs are kept (more than drawn in a frame by a table with many rows)
+static const unsigned TEXT_RUN_CACHE_SIZE = 1024;
+static const unsigned WRAP_INFO_CACHE_SIZE = 64;
+
+glArchivItem_Font::glArchivItem_Font()
+    : ArchivItem_Font(), fontNoOutline(NULL), fontWithOutline(NULL), textRunCache(TEXT_RUN_CACHE_SIZE), wrapInfoCache(WRAP_INFO_CACHE_SIZE)
 {
     ClearCharInfoMapping();
 }
 
 glArchivItem_Font::glArchivItem_Font(const glArchivItem_Font& obj)
-    : ArchivItem_Font(obj), asciiMapping(obj.asciiMapping), utf8_mapping(obj.utf8_mapping)
+    : ArchivItem_Font(obj), asciiMapping(obj.asciiMapping), utf8_mapping(obj.utf8_mapping), textRunCache(TEXT_RUN_CACHE_SIZE),
+      wrapInfoCache(WRAP_INFO_CACHE_SIZE)
 {
     if(obj.fontNoOutline)
         fontNoOutline.reset(dynamic_cast<glArchivItem_Bitmap*>(obj.fontNoOutline->clone()));
@@ -213,6 +220,45 @@ void glArchivItem_Font::Draw(DrawPoint pos, const std::string& text, unsigned fo
     RTTR_Assert(isValidUTF8(text));
     RTTR_Assert(isValidUTF8(end));
 
+    const TextRunKey key(text, format, length, maxWidth, end);
+    const VertexArrays* run = textRunCache.find(key);
+    if(!run)
+    {
+        VertexArrays newRun;
+        CreateTextRun(newRun, text, format, length, maxWidth, end);
+        run = &textRunCache.insert(key, newRun);
+    }
+
+    if(run->vertices.empty())
+        return;
+
+    // Get texture first as it might need to be created
+    glArchivItem_Bitmap& usedFont = (format & DF_NO_OUTLINE) ? *fontNoOutline : *fontWithOutline;
+    unsigned texture = usedFont.GetTexture();
+    const GlPoint texSize(usedFont.GetTexSize());
+    const GlPoint texOrigin(usedFont.GetTexOrigin());
+    const GlPoint offset(pos);
+    RTTR_Assert(run->texCoords.size() == run->vertices.size());
+    RTTR_Assert(run->texCoords.size() % 4u == 0);
+    const unsigned numVertices = static_cast<unsigned>(run->vertices.size());
+    texList.vertices.resize(numVertices);
+    texList.texCoords.resize(numVertices);
+    // Vectorizable loop
+    for(unsigned i = 0; i < numVertices; i++)
+    {
+        texList.vertices[i] = run->vertices[i] + offset;
+        texList.texCoords[i] = (run->texCoords[i] + texOrigin) / texSize;
+    }
+
+    // Texts drawn in a row (or between images of the same shared texture) end up in 1 draw call
+    SPRITEBATCH.Add(texture, &texList.vertices[0], &texList.texCoords[0], color, numVertices);
+}
+
+void glArchivItem_Font::CreateTextRun(VertexArrays& run, const std::string& text, unsigned format, unsigned short length,
+                                      unsigned short maxWidth, const std::string& end) const
+{
+    // The run is relative to the draw position
+    DrawPoint pos(0, 0);
     // Breite bestimmen
     if(length == 0)
         length = (unsigned short)text.length();
@@ -269,9 +315,6 @@ void glArchivItem_Font::Draw(DrawPoint pos, const std::string& text, unsigned fo
         curPos.x = pos.x - line_width / 2;
     }
 
-    texList.texCoords.clear();
-    texList.vertices.clear();
-
     for(std::string::const_iterator it = text.begin(); it != itEnd;)
     {
         const uint32_t curChar = utf8::next(it, itEnd);
@@ -287,7 +330,7 @@ void glArchivItem_Font::Draw(DrawPoint pos, const std::string& text, unsigned fo
                 curPos.x = pos.x;
             curPos.y += dy;
         } else
-            DrawChar(curChar, texList, curPos);
+            DrawChar(curChar, run, curPos);
     }
 
     if(drawEnd)
@@ -300,31 +343,9 @@ void glArchivItem_Font::Draw(DrawPoint pos, const std::string& text, unsigned fo
                 curPos.x = pos.x;
                 curPos.y += dy;
             } else
-                DrawChar(curChar, texList, curPos);
+                DrawChar(curChar, run, curPos);
         }
     }
-
-    if(texList.vertices.empty())
-        return;
-
-    // Get texture first as it might need to be created
-    glArchivItem_Bitmap& usedFont = (format & DF_NO_OUTLINE) ? *fontNoOutline : *fontWithOutline;
-    unsigned texture = usedFont.GetTexture();
-    const GlPoint texSize(usedFont.GetTexSize());
-    RTTR_Assert(texList.texCoords.size() == texList.vertices.size());
-    RTTR_Assert(texList.texCoords.size() % 4u == 0);
-    // Vectorizable loop
-    for(unsigned i = 0; i < texList.texCoords.size(); i += 4)
-    {
-        for(int j = 0; j < 4; j++)
-            texList.texCoords[i + j] /= texSize;
-    }
-
-    glVertexPointer(2, GL_FLOAT, 0, &texList.vertices[0]);
-    glTexCoordPointer(2, GL_FLOAT, 0, &texList.texCoords[0]);
-    VIDEODRIVER.BindTexture(texture);
-    glColor4ub(GetRed(color), GetGreen(color), GetBlue(color), GetAlpha(color));
-    glDrawArrays(GL_QUADS, 0, texList.vertices.size());
 }
 
 template<bool T_limitWidth, class T_Iterator>
@@ -454,6 +475,16 @@ glArchivItem_Font::WrapInfo glArchivItem_Font::GetWrapInfo(const std::string& te
 
     RTTR_Assert(isValidUTF8(text)); // Can only handle UTF-8 strings!
 
+    const WrapInfoKey key(text, primary_width, secondary_width);
+    const WrapInfo* wi = wrapInfoCache.find(key);
+    if(wi)
+        return *wi;
+    return wrapInfoCache.insert(key, CreateWrapInfo(text, primary_width, secondary_width));
+}
+
+glArchivItem_Font::WrapInfo glArchivItem_Font::CreateWrapInfo(const std::string& text, const unsigned short primary_width,
+                                                              const unsigned short secondary_width) const
+{
     // Current line width
     unsigned line_width = 0;
     // Width of current word
@@ -543,6 +574,14 @@ glArchivItem_Font::WrapInfo glArchivItem_Font::GetWrapInfo(const std::string& te
     return wi;
 }
 
+void glArchivItem_Font::GetBitmaps(std::vector<ITexturePackable*>& bitmaps)
+{
+    if(!fontNoOutline)
+        initFont();
+    bitmaps.push_back(fontNoOutline.get());
+    bitmaps.push_back(fontWithOutline.get());
+}
+
 /**
  *  @brief
  */
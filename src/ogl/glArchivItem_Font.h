@@ -21,6 +21,7 @@
 
 #include "DrawPoint.h"
 #include "Rect.h"
+#include "helpers/LRUCache.h"
 #include "ogl/glArchivItem_Bitmap.h"
 #include "ogl/oglIncludes.h"
 #include "libsiedler2/src/ArchivItem_Font.h"
@@ -108,6 +109,9 @@ public:
     /// liefert die Breite eines Zeichens
     unsigned CharWidth(unsigned c) const { return GetCharInfo(c).width; }
 
+    /// Append the bitmaps used for drawing the glyphs (e.g. for packing them into a shared texture)
+    void GetBitmaps(std::vector<ITexturePackable*>& bitmaps);
+
 private:
     typedef Point<GLfloat> GlPoint;
     struct VertexArrays
@@ -116,7 +120,54 @@ private:
         std::vector<GlPoint> vertices;
     };
 
+    /// Parameters of a Draw call that define the drawn glyphs
+    struct TextRunKey
+    {
+        std::string text, end;
+        unsigned format;
+        unsigned short length, maxWidth;
+        TextRunKey(const std::string& text, unsigned format, unsigned short length, unsigned short maxWidth, const std::string& end)
+            : text(text), end(end), format(format), length(length), maxWidth(maxWidth)
+        {}
+        bool operator==(const TextRunKey& rhs) const
+        {
+            return format == rhs.format && length == rhs.length && maxWidth == rhs.maxWidth && text == rhs.text && end == rhs.end;
+        }
+        friend std::size_t hash_value(const TextRunKey& key)
+        {
+            std::size_t seed = boost::hash_value(key.text);
+            boost::hash_combine(seed, key.end);
+            boost::hash_combine(seed, key.format);
+            boost::hash_combine(seed, key.length);
+            boost::hash_combine(seed, key.maxWidth);
+            return seed;
+        }
+    };
+    struct WrapInfoKey
+    {
+        std::string text;
+        unsigned short primaryWidth, secondaryWidth;
+        WrapInfoKey(const std::string& text, unsigned short primaryWidth, unsigned short secondaryWidth)
+            : text(text), primaryWidth(primaryWidth), secondaryWidth(secondaryWidth)
+        {}
+        bool operator==(const WrapInfoKey& rhs) const
+        {
+            return primaryWidth == rhs.primaryWidth && secondaryWidth == rhs.secondaryWidth && text == rhs.text;
+        }
+        friend std::size_t hash_value(const WrapInfoKey& key)
+        {
+            std::size_t seed = boost::hash_value(key.text);
+            boost::hash_combine(seed, key.primaryWidth);
+            boost::hash_combine(seed, key.secondaryWidth);
+            return seed;
+        }
+    };
+
     void initFont();
+    /// Create the glyph quads for the text relative to the draw position. Tex coords are in pixels of the font bitmap
+    void CreateTextRun(VertexArrays& run, const std::string& text, unsigned format, unsigned short length, unsigned short maxWidth,
+                       const std::string& end) const;
+    WrapInfo CreateWrapInfo(const std::string& text, const unsigned short primary_width, const unsigned short secondary_width) const;
     void ClearCharInfoMapping();
     void AddCharInfo(unsigned c, const CharInfo& info);
     /// liefert das Char-Info eines Zeichens
@@ -131,6 +182,9 @@ private:
     std::map<unsigned, CharInfo> utf8_mapping;
     CharInfo placeHolder; /// Placeholder if glyph is missing
     VertexArrays texList; /// Buffer to hold last textures. Used so memory reallocations are avoided
+    /// The UI draws the same texts every frame, so the glyph quads and line breaks are reused
+    helpers::LRUCache<TextRunKey, VertexArrays> textRunCache;
+    helpers::LRUCache<WrapInfoKey, WrapInfo> wrapInfoCache;
 
     /// Get width of the sequence defined by the begin/end pair of iterators
     template<class T_Iterator>
@@ -20,6 +20,7 @@
 #include "Loader.h"
 #include "drivers/VideoDriverWrapper.h"
 #include "ogl/glBitmapItem.h"
+#include "ogl/glSpriteBatch.h"
 #include "oglIncludes.h"
 #include "libsiedler2/src/ArchivItem_Bitmap.h"
 #include "libsiedler2/src/ArchivItem_Bitmap_Player.h"
@@ -59,6 +60,33 @@ Extent glSmartBitmap::getTexSize() const
     return texSize;
 }
 
+Extent glSmartBitmap::GetPackedSize()
+{
+    calcDimensions();
+    return getTexSize();
+}
+
+void glSmartBitmap::SetSharedTexture(unsigned tex, const Extent& texSize, const Extent& pos)
+{
+    texture = tex;
+    sharedTexture = (tex != 0);
+    if(!tex)
+        return;
+
+    const Point<float> fTexSize(texSize);
+    const Point<float> topLeft = Point<float>(pos) / fTexSize;
+    const Point<float> bottomRight = Point<float>(pos + size_) / fTexSize;
+    texCoords[0].x = texCoords[1].x = topLeft.x;
+    texCoords[2].x = texCoords[3].x = bottomRight.x;
+
+    texCoords[0].y = texCoords[3].y = texCoords[4].y = texCoords[7].y = topLeft.y;
+    texCoords[1].y = texCoords[2].y = texCoords[5].y = texCoords[6].y = bottomRight.y;
+
+    // Player colors are right of the image
+    texCoords[4].x = texCoords[5].x = bottomRight.x;
+    texCoords[6].x = texCoords[7].x = (pos.x + size_.x * 2) / fTexSize.x;
+}
+
 void glSmartBitmap::add(libsiedler2::ArchivItem_Bitmap_Player* bmp, bool transferOwnership /*= false*/)
 {
     if(bmp)
@@ -253,10 +281,7 @@ void glSmartBitmap::drawPercent(DrawPoint drawPt, unsigned percent, unsigned col
 
     const float partDrawn = percent / 100.f;
     Point<GLfloat> vertices[8], curTexCoords[8];
-    struct
-    {
-        GLbyte r, g, b, a;
-    } colors[8];
+    glSpriteBatch::Color colors[8];
 
     drawPt -= origin_;
     vertices[2] = Point<GLfloat>(drawPt) + size_;
@@ -300,11 +325,5 @@ void glSmartBitmap::drawPercent(DrawPoint drawPt, unsigned percent, unsigned col
     } else
         numQuads = 4;
 
-    glEnableClientState(GL_COLOR_ARRAY);
-    glVertexPointer(2, GL_FLOAT, 0, vertices);
-    glTexCoordPointer(2, GL_FLOAT, 0, curTexCoords);
-    glColorPointer(4, GL_UNSIGNED_BYTE, 0, colors);
-    VIDEODRIVER.BindTexture(texture);
-    glDrawArrays(GL_QUADS, 0, numQuads);
-    glDisableClientState(GL_COLOR_ARRAY);
+    SPRITEBATCH.Add(texture, vertices, curTexCoords, colors, numQuads);
 }
@@ -21,6 +21,7 @@
 #pragma once
 
 #include "DrawPoint.h"
+#include "ogl/ITexturePackable.h"
 #include <stdint.h>
 #include <vector>
 
@@ -31,7 +32,7 @@ class ArchivItem_Bitmap_Player;
 
 class glBitmapItem;
 
-class glSmartBitmap
+class glSmartBitmap : public ITexturePackable
 {
 private:
     DrawPoint origin_;
@@ -48,7 +49,7 @@ public:
     Point<float> texCoords[8];
 
     glSmartBitmap();
-    ~glSmartBitmap();
+    ~glSmartBitmap() override;
     void reset();
 
     Extent getWidth() const { return size_; }
@@ -58,11 +59,9 @@ public:
     bool isPlayer() const { return hasPlayer; }
     bool empty() const { return items.empty(); }
 
-    void setSharedTexture(unsigned tex)
-    {
-        texture = tex;
-        sharedTexture = (tex != 0);
-    }
+    Extent GetPackedSize() override;
+    void DrawToBuffer(std::vector<uint32_t>& buffer, const Extent& bufSize, const Extent& pos) override { drawTo(buffer, bufSize, pos); }
+    void SetSharedTexture(unsigned tex, const Extent& texSize, const Extent& pos) override;
 
     void calcDimensions();
 
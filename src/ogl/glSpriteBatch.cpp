@@ -0,0 +1,118 @@
+// Copyright (c) 2016 Settlers Freaks (sf-team at siedler25.org)
+//
+// This file is part of Return To The Roots.
+//
+// Return To The Roots is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 2 of the License, or
+// (at your option) any later version.
+//
+// Return To The Roots is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Return To The Roots. If not, see <http://www.gnu.org/licenses/>.
+
+#include "defines.h" // IWYU pragma: keep
+#include "glSpriteBatch.h"
+#include "drivers/VideoDriverWrapper.h"
+#include "ogl/oglIncludes.h"
+#include "libutil/src/colors.h"
+
+glSpriteBatch::glSpriteBatch() : depth(0), numSprites(0), numBatches(0), numDrawCalls(0) {}
+
+void glSpriteBatch::Begin()
+{
+    // The quads of an outer batch are drawn before the (probably differently set up) inner one
+    Flush();
+    ++depth;
+}
+
+void glSpriteBatch::End()
+{
+    RTTR_Assert(depth > 0u);
+    Flush();
+    --depth;
+}
+
+unsigned glSpriteBatch::AddVertices(unsigned texture, const Point<float>* newVertices, const Point<float>* newTexCoords,
+                                    unsigned numVertices)
+{
+    RTTR_Assert(numVertices % 4u == 0);
+    const unsigned firstVertex = vertices.size();
+    vertices.insert(vertices.end(), newVertices, newVertices + numVertices);
+    texCoords.insert(texCoords.end(), newTexCoords, newTexCoords + numVertices);
+    if(!runs.empty() && runs.back().texture == texture)
+        runs.back().numVertices += numVertices;
+    else
+    {
+        TextureRun run;
+        run.texture = texture;
+        run.firstVertex = firstVertex;
+        run.numVertices = numVertices;
+        runs.push_back(run);
+    }
+    numSprites += numVertices / 4;
+    return firstVertex;
+}
+
+void glSpriteBatch::Add(unsigned texture, const Point<float>* vertices, const Point<float>* texCoords, const Color* colors,
+                        unsigned numVertices)
+{
+    AddVertices(texture, vertices, texCoords, numVertices);
+    this->colors.insert(this->colors.end(), colors, colors + numVertices);
+    if(!depth)
+        Flush();
+}
+
+void glSpriteBatch::Add(unsigned texture, const Point<float>* vertices, const Point<float>* texCoords, unsigned color,
+                        unsigned numVertices)
+{
+    AddVertices(texture, vertices, texCoords, numVertices);
+    Color vertexColor;
+    vertexColor.r = GetRed(color);
+    vertexColor.g = GetGreen(color);
+    vertexColor.b = GetBlue(color);
+    vertexColor.a = GetAlpha(color);
+    colors.resize(colors.size() + numVertices, vertexColor);
+    if(!depth)
+        Flush();
+}
+
+void glSpriteBatch::Flush()
+{
+    if(runs.empty())
+        return;
+    RTTR_Assert(vertices.size() == texCoords.size() && vertices.size() == colors.size());
+
+    const bool useOgl = VIDEODRIVER.IsOpenGL();
+    if(useOgl)
+    {
+        glEnableClientState(GL_COLOR_ARRAY);
+        glVertexPointer(2, GL_FLOAT, 0, &vertices.front());
+        glTexCoordPointer(2, GL_FLOAT, 0, &texCoords.front());
+        glColorPointer(4, GL_UNSIGNED_BYTE, 0, &colors.front());
+    }
+    for(std::vector<TextureRun>::const_iterator it = runs.begin(); it != runs.end(); ++it)
+    {
+        VIDEODRIVER.BindTexture(it->texture);
+        if(useOgl)
+            glDrawArrays(GL_QUADS, it->firstVertex, it->numVertices);
+    }
+    if(useOgl)
+        glDisableClientState(GL_COLOR_ARRAY);
+
+    numDrawCalls += runs.size();
+    ++numBatches;
+    vertices.clear();
+    texCoords.clear();
+    colors.clear();
+    runs.clear();
+}
+
+void glSpriteBatch::ResetCounters()
+{
+    numSprites = numBatches = numDrawCalls = 0;
+}
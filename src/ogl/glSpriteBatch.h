@@ -0,0 +1,82 @@
+// Copyright (c) 2016 Settlers Freaks (sf-team at siedler25.org)
+//
+// This file is part of Return To The Roots.
+//
+// Return To The Roots is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 2 of the License, or
+// (at your option) any later version.
+//
+// Return To The Roots is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Return To The Roots. If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef glSpriteBatch_h__
+#define glSpriteBatch_h__
+
+#include "Point.h"
+#include "libutil/src/Singleton.h"
+#include <vector>
+
+/// Collects textured quads and draws them with as few draw calls as possible.
+/// Between Begin() and End() the quads are only drawn on Flush() which must be called before anything else is drawn
+/// (done by all non-batched drawing functions). Consecutive quads with the same texture are drawn with 1 call,
+/// so the drawing order is kept. Outside of Begin/End every added quad is drawn immediately.
+/// Begin/End can be nested (e.g. the map view inside a frame) in which case the outer batch is flushed first.
+class glSpriteBatch : public Singleton<glSpriteBatch>
+{
+public:
+    struct Color
+    {
+        unsigned char r, g, b, a;
+    };
+
+    glSpriteBatch();
+
+    /// Start collecting quads
+    void Begin();
+    /// Draw all collected quads and stop collecting (unless inside another Begin/End)
+    void End();
+    bool IsActive() const { return depth > 0u; }
+
+    /// Add numVertices / 4 quads with the given texture and a color per vertex
+    void Add(unsigned texture, const Point<float>* vertices, const Point<float>* texCoords, const Color* colors, unsigned numVertices);
+    /// Add numVertices / 4 quads with the given texture and the same color for all vertices
+    void Add(unsigned texture, const Point<float>* vertices, const Point<float>* texCoords, unsigned color, unsigned numVertices);
+    /// Draw the collected quads
+    void Flush();
+
+    /// Number of quads added since the last counter reset
+    unsigned GetNumSprites() const { return numSprites; }
+    /// Number of flushes that drew something since the last counter reset
+    unsigned GetNumBatches() const { return numBatches; }
+    /// Number of draw calls since the last counter reset
+    unsigned GetNumDrawCalls() const { return numDrawCalls; }
+    void ResetCounters();
+
+private:
+    /// Range of vertices using the same texture
+    struct TextureRun
+    {
+        unsigned texture;
+        unsigned firstVertex, numVertices;
+    };
+
+    /// Number of Begin calls without End
+    unsigned depth;
+    std::vector<Point<float> > vertices, texCoords;
+    std::vector<Color> colors;
+    std::vector<TextureRun> runs;
+    unsigned numSprites, numBatches, numDrawCalls;
+
+    /// Add the vertices and tex coords and return the index of the first added vertex
+    unsigned AddVertices(unsigned texture, const Point<float>* vertices, const Point<float>* texCoords, unsigned numVertices);
+};
+
+#define SPRITEBATCH glSpriteBatch::inst()
+
+#endif // glSpriteBatch_h__
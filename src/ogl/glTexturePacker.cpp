@@ -18,17 +18,50 @@
 #include "defines.h" // IWYU pragma: keep
 #include "glTexturePacker.h"
 #include "drivers/VideoDriverWrapper.h"
-#include "ogl/glSmartBitmap.h"
+#include "ogl/ITexturePackable.h"
 #include "ogl/glTexturePackerNode.h"
 #include "oglIncludes.h"
+#include "libutil/src/Log.h"
+#include <boost/filesystem/fstream.hpp>
 #include <boost/foreach.hpp>
+#include <boost/interprocess/file_mapping.hpp>
+#include <boost/interprocess/mapped_region.hpp>
 #include <algorithm>
+#include <cstring>
 
-bool isSizeGreater(glSmartBitmap* a, glSmartBitmap* b)
+/// Default limit for the size of the shared textures
+static const unsigned DEFAULT_MAX_TEX_SIZE = 2048;
+
+namespace {
+/// Layout of the cache file: Header, 1 CacheItem per added item, 1 CacheTexture per texture, texture data (BGRA)
+const char CACHE_MAGIC[8] = {'R', 'T', 'T', 'R', 'T', 'E', 'X', 'C'};
+/// Increase when the file layout or the way the images are drawn changes
+const uint32_t CACHE_VERSION = 1;
+
+struct CacheHeader
+{
+    char magic[8];
+    uint32_t version;
+    uint32_t maxTexSize;
+    uint64_t key;
+    uint32_t numItems;
+    uint32_t numTextures;
+};
+struct CacheItem
+{
+    uint32_t width, height;
+    int32_t texIdx;
+    uint32_t x, y;
+};
+struct CacheTexture
+{
+    uint32_t width, height;
+};
+} // namespace
+
+glTexturePacker::glTexturePacker()
+    : cacheKey(0), isLoadedFromCache(false), maxTexSize(DEFAULT_MAX_TEX_SIZE), numPacked(0), usedArea(0), totalArea(0)
 {
-    const Extent sizeA = a->getTexSize();
-    const Extent sizeB = b->getTexSize();
-    return (sizeA.x * sizeA.y) > (sizeB.x * sizeB.y);
 }
 
 glTexturePacker::~glTexturePacker()
@@ -37,7 +70,24 @@ glTexturePacker::~glTexturePacker()
         VIDEODRIVER.DeleteTexture((*it));
 }
 
-bool glTexturePacker::packHelper(std::vector<glSmartBitmap*>& list)
+bool glTexturePacker::isSizeGreater(const PackItem& a, const PackItem& b)
+{
+    return (a.size.x * a.size.y) > (b.size.x * b.size.y);
+}
+
+bool glTexturePacker::isSizeSupported(const Extent& size) const
+{
+    if(size.x > maxTexSize || size.y > maxTexSize)
+        return false;
+    if(!VIDEODRIVER.IsOpenGL())
+        return true;
+    int parTexWidth = 0;
+    glTexImage2D(GL_PROXY_TEXTURE_2D, 0, GL_RGBA, size.x, size.y, 0, GL_BGRA, GL_UNSIGNED_BYTE, NULL);
+    glGetTexLevelParameteriv(GL_PROXY_TEXTURE_2D, 0, GL_TEXTURE_WIDTH, &parTexWidth);
+    return parTexWidth != 0;
+}
+
+bool glTexturePacker::addTexture(const Extent& size, const uint32_t* data)
 {
     unsigned texture = VIDEODRIVER.GenerateTexture();
 
@@ -45,36 +95,43 @@ bool glTexturePacker::packHelper(std::vector<glSmartBitmap*>& list)
         return false;
 
     textures.push_back(texture);
+    textureSizes.push_back(size);
+    totalArea += size.x * size.y;
 
-    VIDEODRIVER.BindTexture(texture);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    if(VIDEODRIVER.IsOpenGL())
+    {
+        VIDEODRIVER.BindTexture(texture);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, size.x, size.y, 0, GL_BGRA, GL_UNSIGNED_BYTE, data);
+    }
+    return true;
+}
 
+bool glTexturePacker::packHelper(std::vector<PackItem>& list)
+{
     // find space needed in total and biggest texture to store (as a start)
     Extent maxBmpSize(0, 0);
     unsigned total = 0;
-    BOOST_FOREACH(glSmartBitmap* bmp, list)
+    BOOST_FOREACH(const PackItem& item, list)
     {
-        Extent texSize = bmp->getTexSize();
-        maxBmpSize = elMax(maxBmpSize, texSize);
-
-        total += texSize.x * texSize.y;
+        maxBmpSize = elMax(maxBmpSize, item.size);
+        total += item.size.x * item.size.y;
     }
 
     // most cards work much better with texture sizes of powers of two.
     maxBmpSize = VIDEODRIVER.calcPreferredTextureSize(maxBmpSize);
 
-    int parTexWidth = 0;
-    glTexImage2D(GL_PROXY_TEXTURE_2D, 0, GL_RGBA, maxBmpSize.x, maxBmpSize.y, 0, GL_BGRA, GL_UNSIGNED_BYTE, NULL);
-    glGetTexLevelParameteriv(GL_PROXY_TEXTURE_2D, 0, GL_TEXTURE_WIDTH, &parTexWidth);
-
-    if(parTexWidth == 0)
+    if(!isSizeSupported(maxBmpSize))
         return false;
 
     // maximum texture size reached?
     bool maxTex = false;
     std::vector<glTexturePackerNode*> tmpVec;
     tmpVec.reserve(list.size());
+    // Images that fit into the current texture with their positions and the ones we could not fit in
+    std::vector<PackItem> placed, left;
+    std::vector<Extent> positions;
 
     Extent curSize = maxBmpSize;
     do
@@ -82,114 +139,274 @@ bool glTexturePacker::packHelper(std::vector<glSmartBitmap*>& list)
         // two possibilities: enough space OR maximum texture size reached
         if((curSize.x * curSize.y >= total) || maxTex)
         {
-            // texture packer
-            glTexturePackerNode* root = new glTexturePackerNode(curSize);
-
-            // list to store bitmaps we could not fit in our current texture
-            std::vector<glSmartBitmap*> left;
-
-            std::vector<uint32_t> buffer(curSize.x * curSize.y);
+            glTexturePackerNode root(curSize);
+            placed.clear();
+            positions.clear();
+            left.clear();
 
             // try storing bitmaps in the big texture
-            BOOST_FOREACH(glSmartBitmap* bmp, list)
+            BOOST_FOREACH(const PackItem& item, list)
             {
-                if(!root->insert(bmp, buffer, curSize, tmpVec))
+                Extent pos;
+                if(root.insert(item.size, pos, tmpVec))
                 {
-                    // inserting this bitmap failed? just remember it for next texture
-                    left.push_back(bmp);
+                    placed.push_back(item);
+                    positions.push_back(pos);
                 } else
                 {
-                    // tell or glSmartBitmap, that it uses a shared texture (so it won't try to delete/free it)
-                    bmp->setSharedTexture(texture);
+                    // inserting this bitmap failed? just remember it for next texture
+                    left.push_back(item);
                 }
             }
-            /*
-            char tmp[100];
-            snprintf(tmp, sizeof(tmp), "%u-%ux%u.rgba", texture, curSize.x, curSize.y);
-
-            FILE *f = fopen(tmp, "w+");
-
-            for (int y = 0; y < curSize.y; ++y)
-            {
-            for (int x = 0; x < curSize.x; ++x)
-            {
-            fputc(buffer[((y * curSize.x + x) << 2) + 2], f);
-            fputc(buffer[((y * curSize.x + x) << 2) + 1], f);
-            fputc(buffer[((y * curSize.x + x) << 2) + 0], f);
-            fputc(buffer[((y * curSize.x + x) << 2) + 3], f);
-            }
-            }
-
-            fclose(f);
-            */
             // free texture packer, as it is not needed any more
-            root->destroy(list.size());
-            delete root;
+            root.destroy(list.size());
 
-            if(left.empty()) // nothing left, just generate texture and return success
+            // Either everything fits or the maximum texture size is reached and we need another texture for the rest.
+            // Otherwise our pre-estimated size was not enough for the algorithm to fit all textures in -> increase the size
+            if(left.empty() || maxTex)
             {
-                glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, curSize.x, curSize.y, 0, GL_BGRA, GL_UNSIGNED_BYTE, &buffer.front());
-                glGetTexLevelParameteriv(GL_PROXY_TEXTURE_2D, 0, GL_TEXTURE_WIDTH, &parTexWidth);
-
-                return parTexWidth != 0;
-            } else if(maxTex) // maximum texture size reached and something still left
-            {
-                // generate this texture and release the buffer
-                glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, curSize.x, curSize.y, 0, GL_BGRA, GL_UNSIGNED_BYTE, &buffer.front());
-                glGetTexLevelParameteriv(GL_PROXY_TEXTURE_2D, 0, GL_TEXTURE_WIDTH, &parTexWidth);
-
-                if(parTexWidth == 0)
+                std::vector<uint32_t> buffer(curSize.x * curSize.y);
+                for(unsigned i = 0; i < placed.size(); i++)
+                    placed[i].item->DrawToBuffer(buffer, curSize, positions[i]);
+                if(!addTexture(curSize, &buffer.front()))
                     return false;
+                for(unsigned i = 0; i < placed.size(); i++)
+                {
+                    // tell the image that it uses a shared texture (so it won't try to delete/free it)
+                    placed[i].item->SetSharedTexture(textures.back(), curSize, positions[i]);
+                    placements[placed[i].idx].texIdx = static_cast<int>(textures.size() - 1);
+                    placements[placed[i].idx].pos = positions[i];
+                    usedArea += placed[i].size.x * placed[i].size.y;
+                }
+                numPacked += placed.size();
+                if(!cacheFilePath.empty())
+                {
+                    textureData.push_back(std::vector<uint32_t>());
+                    textureData.back().swap(buffer);
+                }
 
+                if(left.empty()) // nothing left -> success
+                    return true;
                 // recursively generate textures for what is left
                 return packHelper(left);
             }
-
-            // our pre-estimated size if the big texture was not enough for the algorithm to fit all textures in
-            // delete buffer and try again with an increased big texture
-            left.clear();
         }
 
         // increase width or height, try whether opengl is able to handle textures that big
+        Extent newSize = curSize;
         if(curSize.x <= curSize.y)
+            newSize.x *= 2;
+        else
+            newSize.y *= 2;
+        if(isSizeSupported(newSize))
+            curSize = newSize;
+        else
+            maxTex = true;
+    } while(true);
+}
+
+bool glTexturePacker::loadCache(const std::vector<Extent>& sizes)
+{
+    namespace bip = boost::interprocess;
+    boost::system::error_code ec;
+    if(!bfs::is_regular_file(cacheFilePath, ec))
+        return false;
+    try
+    {
+        bip::file_mapping file(cacheFilePath.c_str(), bip::read_only);
+        bip::mapped_region region(file, bip::read_only);
+        const char* data = static_cast<const char*>(region.get_address());
+        const size_t fileSize = region.get_size();
+
+        CacheHeader header;
+        if(fileSize < sizeof(header))
+            return false;
+        std::memcpy(&header, data, sizeof(header));
+        if(std::memcmp(header.magic, CACHE_MAGIC, sizeof(CACHE_MAGIC)) != 0 || header.version != CACHE_VERSION
+           || header.maxTexSize != maxTexSize || header.key != cacheKey || header.numItems != sizes.size())
+            return false;
+
+        // Check the counts against the file size before multiplying, so a corrupt file can't overflow the offsets
+        const size_t itemsOffset = sizeof(header);
+        if(header.numItems > (fileSize - itemsOffset) / sizeof(CacheItem))
+            return false;
+        const size_t texturesOffset = itemsOffset + header.numItems * sizeof(CacheItem);
+        if(header.numTextures > (fileSize - texturesOffset) / sizeof(CacheTexture))
+            return false;
+        size_t dataOffset = texturesOffset + header.numTextures * sizeof(CacheTexture);
+        std::vector<CacheItem> cacheItems(header.numItems);
+        if(!cacheItems.empty())
+            std::memcpy(&cacheItems.front(), data + itemsOffset, cacheItems.size() * sizeof(CacheItem));
+        std::vector<CacheTexture> cacheTextures(header.numTextures);
+        if(!cacheTextures.empty())
+            std::memcpy(&cacheTextures.front(), data + texturesOffset, cacheTextures.size() * sizeof(CacheTexture));
+
+        // Check everything before using anything
+        std::vector<size_t> textureOffsets;
+        BOOST_FOREACH(const CacheTexture& texture, cacheTextures)
         {
-            glTexImage2D(GL_PROXY_TEXTURE_2D, 0, GL_RGBA, curSize.x * 2, curSize.y, 0, GL_BGRA, GL_UNSIGNED_BYTE, NULL);
-            glGetTexLevelParameteriv(GL_PROXY_TEXTURE_2D, 0, GL_TEXTURE_WIDTH, &parTexWidth);
-
-            if(parTexWidth == 0)
-                maxTex = true;
-            else
-                curSize.x *= 2;
-        } else if(curSize.y < curSize.x)
+            if(texture.width == 0 || texture.height == 0 || texture.width > maxTexSize || texture.height > maxTexSize)
+                return false;
+            // Texture data must fit into the rest of the file
+            const size_t remainingPixels = (fileSize - dataOffset) / sizeof(uint32_t);
+            if(texture.height > remainingPixels / texture.width)
+                return false;
+            textureOffsets.push_back(dataOffset);
+            dataOffset += static_cast<size_t>(texture.width) * texture.height * sizeof(uint32_t);
+        }
+        if(dataOffset != fileSize)
+            return false;
+        for(unsigned i = 0; i < sizes.size(); i++)
         {
-            glTexImage2D(GL_PROXY_TEXTURE_2D, 0, GL_RGBA, curSize.x, curSize.y * 2, 0, GL_BGRA, GL_UNSIGNED_BYTE, NULL);
-            glGetTexLevelParameteriv(GL_PROXY_TEXTURE_2D, 0, GL_TEXTURE_WIDTH, &parTexWidth);
+            const CacheItem& item = cacheItems[i];
+            if(item.width != sizes[i].x || item.height != sizes[i].y || item.texIdx >= static_cast<int32_t>(cacheTextures.size()))
+                return false;
+            if(item.texIdx >= 0)
+            {
+                const CacheTexture& texture = cacheTextures[item.texIdx];
+                if(item.width > texture.width || item.height > texture.height || item.x > texture.width - item.width
+                   || item.y > texture.height - item.height)
+                    return false;
+            }
+        }
 
-            if(parTexWidth == 0)
-                maxTex = true;
-            else
-                curSize.y *= 2;
+        for(unsigned i = 0; i < cacheTextures.size(); i++)
+        {
+            const Extent texSize(cacheTextures[i].width, cacheTextures[i].height);
+            if(!addTexture(texSize, reinterpret_cast<const uint32_t*>(data + textureOffsets[i])))
+                return false;
         }
-    } while(true);
+        for(unsigned i = 0; i < sizes.size(); i++)
+        {
+            const CacheItem& item = cacheItems[i];
+            if(item.texIdx < 0)
+                continue;
+            placements[i].texIdx = item.texIdx;
+            placements[i].pos = Extent(item.x, item.y);
+            items[i]->SetSharedTexture(textures[item.texIdx], textureSizes[item.texIdx], placements[i].pos);
+            usedArea += item.width * item.height;
+            ++numPacked;
+        }
+    } catch(const bip::interprocess_exception& e)
+    {
+        LOG.write("Could not read texture cache %s: %s\n") % cacheFilePath % e.what();
+        return false;
+    }
+    return true;
+}
+
+void glTexturePacker::saveCache(const std::vector<Extent>& sizes) const
+{
+    RTTR_Assert(textureData.size() == textures.size());
+    bfs::ofstream file(cacheFilePath, std::ios::binary);
+    if(!file)
+    {
+        LOG.write("Could not write texture cache %s\n") % cacheFilePath;
+        return;
+    }
+
+    CacheHeader header;
+    std::memcpy(header.magic, CACHE_MAGIC, sizeof(CACHE_MAGIC));
+    header.version = CACHE_VERSION;
+    header.maxTexSize = maxTexSize;
+    header.key = cacheKey;
+    header.numItems = sizes.size();
+    header.numTextures = textures.size();
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    for(unsigned i = 0; i < sizes.size(); i++)
+    {
+        CacheItem item;
+        item.width = sizes[i].x;
+        item.height = sizes[i].y;
+        item.texIdx = placements[i].texIdx;
+        item.x = placements[i].pos.x;
+        item.y = placements[i].pos.y;
+        file.write(reinterpret_cast<const char*>(&item), sizeof(item));
+    }
+    BOOST_FOREACH(const Extent& texSize, textureSizes)
+    {
+        CacheTexture texture;
+        texture.width = texSize.x;
+        texture.height = texSize.y;
+        file.write(reinterpret_cast<const char*>(&texture), sizeof(texture));
+    }
+    BOOST_FOREACH(const std::vector<uint32_t>& texData, textureData)
+        file.write(reinterpret_cast<const char*>(&texData.front()), texData.size() * sizeof(uint32_t));
+    if(!file)
+        LOG.write("Could not write texture cache %s\n") % cacheFilePath;
 }
 
 bool glTexturePacker::pack()
 {
-    BOOST_FOREACH(glSmartBitmap* bmp, items)
-        bmp->calcDimensions();
+    if(VIDEODRIVER.IsOpenGL())
+    {
+        int driverMaxTexSize = 0;
+        glGetIntegerv(GL_MAX_TEXTURE_SIZE, &driverMaxTexSize);
+        if(driverMaxTexSize > 0)
+            maxTexSize = std::min(maxTexSize, static_cast<unsigned>(driverMaxTexSize));
+    }
+
+    placements.clear();
+    placements.resize(items.size());
+    isLoadedFromCache = false;
+
+    std::vector<Extent> sizes;
+    sizes.reserve(items.size());
+    BOOST_FOREACH(ITexturePackable* item, items)
+        sizes.push_back(item->GetPackedSize());
 
-    std::sort(items.begin(), items.end(), isSizeGreater);
+    if(!cacheFilePath.empty() && loadCache(sizes))
+    {
+        isLoadedFromCache = true;
+        LOG.write("Loaded %u of %u images in %u textures from the cache\n") % numPacked % items.size() % textures.size();
+        return true;
+    }
+    // Clean up a possibly partially loaded cache
+    BOOST_FOREACH(unsigned tex, textures)
+        VIDEODRIVER.DeleteTexture(tex);
+    textures.clear();
+    textureSizes.clear();
+    numPacked = usedArea = totalArea = 0;
+
+    // Images covering a large part of a shared texture gain nothing from packing but would require big textures
+    // which might not be available (small maximum texture size) -> They keep their own texture
+    std::vector<PackItem> list;
+    list.reserve(items.size());
+    for(unsigned i = 0; i < items.size(); i++)
+    {
+        PackItem packItem;
+        packItem.item = items[i];
+        packItem.idx = i;
+        packItem.size = sizes[i];
+        if(packItem.size.x == 0 || packItem.size.y == 0 || packItem.size.x > maxTexSize / 2 || packItem.size.y > maxTexSize / 2)
+            continue;
+        list.push_back(packItem);
+    }
+
+    std::sort(list.begin(), list.end(), isSizeGreater);
 
-    if(packHelper(items))
+    if(list.empty() || packHelper(list))
+    {
+        LOG.write("Packed %u of %u images into %u textures, %.1f%% of the texture area used\n") % numPacked % items.size()
+          % textures.size() % (getEfficiency() * 100.f);
+        if(!cacheFilePath.empty())
+            saveCache(sizes);
+        textureData.clear();
         return true;
+    }
 
     // free all textures allocated by us
     BOOST_FOREACH(unsigned tex, textures)
         VIDEODRIVER.DeleteTexture(tex);
-
-    // reset glSmartBitmap textures
-    BOOST_FOREACH(glSmartBitmap* bmp, items)
-        bmp->setSharedTexture(0);
+    textures.clear();
+    textureSizes.clear();
+    textureData.clear();
+
+    // reset the textures of the images
+    BOOST_FOREACH(const PackItem& item, list)
+        item.item->SetSharedTexture(0, Extent(0, 0), Extent(0, 0));
+    placements.clear();
+    numPacked = usedArea = totalArea = 0;
 
     return false;
 }
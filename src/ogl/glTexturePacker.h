@@ -18,24 +18,82 @@
 #ifndef glTexturePacker_h__
 #define glTexturePacker_h__
 
+#include "Point.h"
+#include <stdint.h>
+#include <string>
 #include <vector>
 
-class glSmartBitmap;
+class ITexturePackable;
 
+/// Packs images into few shared textures (atlas pages) so they can be drawn without switching textures
 class glTexturePacker
 {
 private:
+    struct PackItem
+    {
+        ITexturePackable* item;
+        /// Index in items
+        unsigned idx;
+        Extent size;
+    };
+    /// Where an item was put: Index of the texture (-1 if not packed) and position in it
+    struct Placement
+    {
+        int texIdx;
+        Extent pos;
+        Placement() : texIdx(-1), pos(0, 0) {}
+    };
+
     std::vector<unsigned> textures;
-    std::vector<glSmartBitmap*> items;
+    std::vector<Extent> textureSizes;
+    std::vector<ITexturePackable*> items;
+    std::vector<Placement> placements;
+    /// Content of the textures, only kept for writing the cache
+    std::vector<std::vector<uint32_t> > textureData;
+    std::string cacheFilePath;
+    uint64_t cacheKey;
+    bool isLoadedFromCache;
+    /// Maximum size of the shared textures
+    unsigned maxTexSize;
+    unsigned numPacked;
+    /// Area covered by images and total area of all shared textures
+    unsigned usedArea, totalArea;
 
-    bool packHelper(std::vector<glSmartBitmap*>& list);
+    bool packHelper(std::vector<PackItem>& list);
+    /// Check if a texture of this size can be created
+    bool isSizeSupported(const Extent& size) const;
+    static bool isSizeGreater(const PackItem& a, const PackItem& b);
+    /// Create a texture from the data and add it to the shared textures
+    bool addTexture(const Extent& size, const uint32_t* data);
+    /// Try to use the textures from the cache file. Fails if it does not match the key or the items' sizes
+    bool loadCache(const std::vector<Extent>& sizes);
+    void saveCache(const std::vector<Extent>& sizes) const;
 
 public:
+    glTexturePacker();
     ~glTexturePacker();
 
+    /// Pack all added images. Images that are too big for the shared textures keep their own texture
     bool pack();
 
-    void add(glSmartBitmap& bmp) { items.push_back(&bmp); }
+    void add(ITexturePackable& item) { items.push_back(&item); }
+
+    /// Cache the packed textures in the file. They are only used if the key (identifying the source files) matches and
+    /// the same images (by size) are added. Otherwise the images are packed and the file is rewritten.
+    void setCacheFile(const std::string& filePath, uint64_t key)
+    {
+        cacheFilePath = filePath;
+        cacheKey = key;
+    }
+    /// True if the last pack() used the cache file
+    bool loadedFromCache() const { return isLoadedFromCache; }
+
+    /// Limit the size of the shared textures. The maximum texture size of the driver is used if it is smaller
+    void setMaxTextureSize(unsigned maxSize) { maxTexSize = maxSize; }
+    unsigned getNumTextures() const { return textures.size(); }
+    unsigned getNumPacked() const { return numPacked; }
+    /// Return the fraction of the shared textures' area covered by images
+    float getEfficiency() const { return totalArea ? static_cast<float>(usedArea) / totalArea : 0.f; }
 };
 
 #endif // glTexturePacker_h__
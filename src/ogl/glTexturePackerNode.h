@@ -19,10 +19,8 @@
 #define glTexturePackerNode_h__
 
 #include "Point.h"
-#include <stdint.h>
 #include <vector>
 
-class glSmartBitmap;
 class glTexturePackerNode;
 
 class glTexturePackerNode
@@ -32,15 +30,16 @@ class glTexturePackerNode
     /// Size of all the subnodes combined (makes up area covered)
     Extent size;
 
-    glSmartBitmap* bmp;
+    /// True if this leaf contains an image
+    bool isUsed;
     glTexturePackerNode* child[2];
 
 public:
-    glTexturePackerNode() : pos(0, 0), size(0, 0), bmp(NULL) { child[0] = child[1] = NULL; }
-    glTexturePackerNode(const Extent& size) : pos(0, 0), size(size), bmp(NULL) { child[0] = child[1] = NULL; }
-    /// Find a position in the buffer to draw the bitmap starting at this node
+    glTexturePackerNode() : pos(0, 0), size(0, 0), isUsed(false) { child[0] = child[1] = NULL; }
+    glTexturePackerNode(const Extent& size) : pos(0, 0), size(size), isUsed(false) { child[0] = child[1] = NULL; }
+    /// Find a free position for an image of the given size starting at this node and reserve it
     /// todo list is cleared and used to avoid frequent allocations
-    bool insert(glSmartBitmap* b, std::vector<uint32_t>& buffer, const Extent& bufferSize, std::vector<glTexturePackerNode*>& todo);
+    bool insert(const Extent& texSize, Extent& foundPos, std::vector<glTexturePackerNode*>& todo);
     void destroy(unsigned reserve = 0);
 };
 
@@ -51,6 +51,12 @@ public:
                                        std::vector<Direction>* route, unsigned* length, Direction* firstDir, FP_Node_OK_Callback IsNodeOK,
                                        FP_Node_OK_Callback IsNodeOKAlternate, FP_Node_OK_Callback IsNodeToDestOk, const void* param);
 
+    /// Check which of the goals can be reached from start with at most maxLength steps using one breadth first search.
+    /// Uses the same conditions as FindPath (goals are not checked by IsNodeOk) so the result equals calling FindPath for each goal
+    template<class TNodeChecker>
+    void FindReachableGoals(const MapPoint start, const std::vector<MapPoint>& goals, const unsigned maxLength,
+                            std::vector<bool>& isReachable, const TNodeChecker& nodeChecker);
+
     /// Ermittelt, ob eine freie Route noch passierbar ist und gibt den Endpunkt der Route zurück
     template<class TNodeChecker>
     bool CheckRoute(const MapPoint start, const std::vector<Direction>& route, const unsigned pos, const TNodeChecker& nodeChecker,
@@ -19,12 +19,15 @@
 #define FreePathFinderImpl_h__
 
 #include "EventManager.h"
+#include "Instrumentation.h"
 #include "pathfinding/FreePathFinder.h"
 #include "pathfinding/NewNode.h"
 #include "pathfinding/OpenListBinaryHeap.h"
 #include "pathfinding/OpenListPrioQueue.h"
 #include "pathfinding/PathfindingPoint.h"
 #include "world/GameWorldBase.h"
+#include <limits>
+#include <queue>
 
 typedef std::vector<FreePathNode> FreePathNodes;
 extern FreePathNodes fpNodes;
@@ -56,6 +59,7 @@ bool FreePathFinder::FindPath(const MapPoint start, const MapPoint dest, const b
                               std::vector<Direction>* route, unsigned* length, Direction* firstDir, const TNodeChecker& nodeChecker)
 {
     RTTR_Assert(start != dest);
+    Instrumentation::ScopedTimer timer(INSTR_PATHFINDING);
 
     // increase currentVisit, so we don't have to clear the visited-states at every run
     IncreaseCurrentVisit();
@@ -83,6 +87,7 @@ bool FreePathFinder::FindPath(const MapPoint start, const MapPoint dest, const b
     {
         // Knoten mit den geringsten Wegkosten auswählen
         FreePathNode& best = *todo.pop();
+        timer.AddCount();
 
         // Ziel schon erreicht?
         if(&best == &destNode)
@@ -177,6 +182,74 @@ bool FreePathFinder::FindPath(const MapPoint start, const MapPoint dest, const b
     return false;
 }
 
+template<class TNodeChecker>
+void FreePathFinder::FindReachableGoals(const MapPoint start, const std::vector<MapPoint>& goals, const unsigned maxLength,
+                                        std::vector<bool>& isReachable, const TNodeChecker& nodeChecker)
+{
+    // Goals are marked as visited with this distance till they are reached
+    const unsigned UNREACHED = std::numeric_limits<unsigned>::max();
+    Instrumentation::ScopedTimer timer(INSTR_PATHFINDING);
+
+    IncreaseCurrentVisit();
+
+    unsigned numUnreached = 0;
+    for(std::vector<MapPoint>::const_iterator it = goals.begin(); it != goals.end(); ++it)
+    {
+        FreePathNode& node = fpNodes[gwb_.GetIdx(*it)];
+        if(*it == start || node.lastVisited == currentVisit)
+            continue;
+        node.lastVisited = currentVisit;
+        node.curDistance = UNREACHED;
+        ++numUnreached;
+    }
+
+    FreePathNode& startNode = fpNodes[gwb_.GetIdx(start)];
+    startNode.lastVisited = currentVisit;
+    startNode.curDistance = 0;
+
+    std::queue<MapPoint> todo;
+    todo.push(start);
+    while(!todo.empty() && numUnreached > 0)
+    {
+        const MapPoint curPt = todo.front();
+        todo.pop();
+        timer.AddCount();
+        const unsigned nextDistance = fpNodes[gwb_.GetIdx(curPt)].curDistance + 1;
+        if(nextDistance > maxLength)
+            continue;
+
+        for(unsigned iDir = 0; iDir < Direction::COUNT; ++iDir)
+        {
+            const Direction dir = Direction::fromInt(iDir);
+            const MapPoint neighbourPos = gwb_.GetNeighbour(curPt, dir);
+            FreePathNode& neighbour = fpNodes[gwb_.GetIdx(neighbourPos)];
+            const bool isGoal = neighbour.lastVisited == currentVisit && neighbour.curDistance == UNREACHED;
+            if(neighbour.lastVisited == currentVisit && !isGoal)
+                continue;
+            // Check node for all but the goals
+            if(!isGoal && !nodeChecker.IsNodeOk(neighbourPos))
+                continue;
+            if(!nodeChecker.IsEdgeOk(curPt, dir))
+                continue;
+
+            neighbour.lastVisited = currentVisit;
+            neighbour.curDistance = nextDistance;
+            if(isGoal)
+            {
+                --numUnreached;
+                // Other goals may only be reached over this one if it is an usable node
+                if(!nodeChecker.IsNodeOk(neighbourPos))
+                    continue;
+            }
+            todo.push(neighbourPos);
+        }
+    }
+
+    isReachable.resize(goals.size());
+    for(unsigned i = 0; i < goals.size(); ++i)
+        isReachable[i] = fpNodes[gwb_.GetIdx(goals[i])].curDistance != UNREACHED;
+}
+
 /// Ermittelt, ob eine freie Route noch passierbar ist und gibt den Endpunkt der Route zurück
 template<class TNodeChecker>
 bool FreePathFinder::CheckRoute(const MapPoint start, const std::vector<Direction>& route, const unsigned pos,
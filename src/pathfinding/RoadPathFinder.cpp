@@ -18,6 +18,7 @@
 #include "defines.h" // IWYU pragma: keep
 #include "RoadPathFinder.h"
 #include "EventManager.h"
+#include "Instrumentation.h"
 #include "buildings/nobHarborBuilding.h"
 #include "pathfinding/OpenListPrioQueue.h"
 #include "pathfinding/OpenListVector.h"
@@ -135,6 +136,8 @@ bool RoadPathFinder::FindPathImpl(const noRoadNode& start, const noRoadNode& goa
         return true;
     }
 
+    Instrumentation::ScopedTimer timer(INSTR_PATHFINDING);
+
     // increase current_visit_on_roads, so we don't have to clear the visited-states at every run
     currentVisit++;
 
@@ -171,6 +174,7 @@ bool RoadPathFinder::FindPathImpl(const noRoadNode& start, const noRoadNode& goa
     {
         // Knoten mit den geringsten Wegkosten ausw�hlen
         const noRoadNode& best = *todo.pop();
+        timer.AddCount();
 
         // Ziel erreicht?
         if(&best == &goal)
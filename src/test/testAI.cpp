@@ -0,0 +1,318 @@
+// Copyright (c) 2016 Settlers Freaks (sf-team at siedler25.org)
+//
+// This file is part of Return To The Roots.
+//
+// Return To The Roots is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 2 of the License, or
+// (at your option) any later version.
+//
+// Return To The Roots is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Return To The Roots. If not, see <http://www.gnu.org/licenses/>.
+
+#include "defines.h" // IWYU pragma: keep
+#include "GamePlayer.h"
+#include "ai/AIJHHelper.h"
+#include "ai/AIMapLayer.h"
+#include "ai/AIPlayerJH.h"
+#include "ai/AIResourceMap.h"
+#include "nodeObjs/noGranite.h"
+#include "nodeObjs/noTree.h"
+#include "test/CreateEmptyWorld.h"
+#include "test/PointOutput.h"
+#include "test/WorldFixture.h"
+#include <boost/foreach.hpp>
+#include <boost/test/unit_test.hpp>
+#include <algorithm>
+#include <ctime>
+
+BOOST_AUTO_TEST_SUITE(AISuite)
+
+typedef WorldFixture<CreateEmptyWorld, 1, 32, 32> EmptyWorldFixture1P;
+
+namespace {
+/// Check that the resource map of the AI matches the resource values calculated from scratch
+boost::test_tools::predicate_result checkResourceMap(const GameWorldBase& world, AIPlayerJH& ai, AIJH::Resource res)
+{
+    std::vector<gc::GameCommandPtr> gcs;
+    AIInterface aii(world, gcs, 0);
+    RTTR_FOREACH_PT(MapPoint, world.GetSize())
+    {
+        const int expectedValue = aii.CalcResourceValue(pt, res);
+        const int value = ai.GetResMapValue(pt, res);
+        if(value == expectedValue)
+            continue;
+        boost::test_tools::predicate_result result(false);
+        result.message() << "Resource " << res << ": " << value << "!=" << expectedValue << " at " << pt;
+        return result;
+    }
+    return true;
+}
+
+/// Gives access to the protected members of the AI used by the tests
+class TestAIPlayer : public AIPlayerJH
+{
+public:
+    TestAIPlayer(const unsigned char playerId, const GameWorldBase& gwb, const AI::Level level) : AIPlayerJH(playerId, gwb, level) {}
+    using AIPlayerJH::FindBestPosition;
+    using AIPlayerJH::GetDensity;
+    using AIPlayerJH::RecalcGround;
+};
+
+/// Find the best position like the AI did before the resource maps were kept up to date:
+/// Walk in rings around pt (excluding pt) calculating the values incrementally and check the BQ and territory directly
+int findBestValueLive(const GameWorldBase& world, const AIInterface& aii, AIPlayerJH& ai, const MapPoint pt, AIJH::Resource res,
+                      BuildingQuality size, int radius)
+{
+    int bestValue = -1;
+    int circleStartValue = 0;
+    int value = 0;
+    MapCoord tx = world.GetXA(pt, Direction::WEST);
+    for(int r = 1; r <= radius; tx = world.GetXA(tx, pt.y, Direction::WEST), ++r)
+    {
+        MapPoint curPt(tx, pt.y);
+        for(unsigned curDir = 2; curDir < 8; ++curDir)
+        {
+            for(int step = 0; step < r; ++step)
+            {
+                if(r == 1 && step == 0 && curDir == 2)
+                {
+                    value = aii.CalcResourceValue(curPt, res);
+                    circleStartValue = value;
+                } else if(step == 0 && curDir == 2)
+                {
+                    value = aii.CalcResourceValue(curPt, res, 0, circleStartValue);
+                    circleStartValue = value;
+                } else if(step > 0)
+                    value = aii.CalcResourceValue(curPt, res, curDir % 6, value);
+                else
+                    value = aii.CalcResourceValue(curPt, res, (curDir - 1) % 6, value);
+                if(value > bestValue)
+                {
+                    const AIJH::Node& node = ai.GetAINode(curPt);
+                    const BuildingQuality bq = aii.GetBuildingQuality(curPt);
+                    if(node.reachable && !node.farmed && aii.IsOwnTerritory(curPt) && ((bq >= size && bq < BQ_MINE) || bq == size))
+                        bestValue = value;
+                }
+                curPt = world.GetNeighbour(curPt, Direction(curDir));
+            }
+        }
+    }
+    return bestValue;
+}
+
+/// Place some trees in the world with gaps between them
+void addForest(GameWorldBase& world)
+{
+    RTTR_FOREACH_PT(MapPoint, world.GetSize())
+    {
+        if((pt.x * 7 + pt.y * 13) % 11 != 0 || world.GetNO(pt)->GetType() != NOP_NOTHING)
+            continue;
+        world.SetNO(pt, new noTree(pt, 0, 3));
+        world.RecalcBQAroundPointBig(pt);
+    }
+}
+
+struct IsValueSet
+{
+    typedef bool result_type;
+    const AIMapLayer& layer;
+    IsValueSet(const AIMapLayer& layer) : layer(layer) {}
+    bool operator()(const MapPoint pt) const { return layer[pt] != 0; }
+};
+} // namespace
+
+BOOST_FIXTURE_TEST_CASE(ResourceMapsFollowWorldChanges, EmptyWorldFixture1P)
+{
+    AIPlayerJH ai(0, world, AI::EASY);
+    AIBase& aiBase = ai;
+    const AIJH::Resource resources[] = {AIJH::WOOD, AIJH::STONES, AIJH::PLANTSPACE, AIJH::BORDERLAND};
+    BOOST_FOREACH(AIJH::Resource res, resources)
+        BOOST_REQUIRE(checkResourceMap(world, ai, res));
+
+    // Add a small forest and some stones next to the HQ
+    const MapPoint hqPos = world.GetPlayer(0).GetHQPos();
+    for(unsigned i = 0; i < 6; i++)
+    {
+        const MapPoint treePt = world.MakeMapPoint(Point<int>(hqPos) + Point<int>(i, 5));
+        world.SetNO(treePt, new noTree(treePt, 0, 3));
+        world.RecalcBQAroundPointBig(treePt);
+        const MapPoint granitePt = world.MakeMapPoint(Point<int>(hqPos) - Point<int>(i, 5));
+        world.SetNO(granitePt, new noGranite(GT_1, 5));
+        world.RecalcBQAroundPointBig(granitePt);
+    }
+    // Changes are taken over on the next GF of the AI
+    aiBase.RunGF(1, false);
+    BOOST_FOREACH(AIJH::Resource res, resources)
+        BOOST_REQUIRE(checkResourceMap(world, ai, res));
+
+    // Remove a tree again
+    const MapPoint treePt = world.MakeMapPoint(Point<int>(hqPos) + Point<int>(2, 5));
+    world.DestroyNO(treePt);
+    world.RecalcBQAroundPointBig(treePt);
+    aiBase.RunGF(2, false);
+    BOOST_FOREACH(AIJH::Resource res, resources)
+        BOOST_REQUIRE(checkResourceMap(world, ai, res));
+
+    // Replace stones by a tree. The BQ stays the same, so only the object change is reported
+    const MapPoint granitePt = world.MakeMapPoint(Point<int>(hqPos) - Point<int>(2, 5));
+    world.DestroyNO(granitePt);
+    world.SetNO(granitePt, new noTree(granitePt, 0, 3));
+    aiBase.RunGF(3, false);
+    BOOST_FOREACH(AIJH::Resource res, resources)
+        BOOST_REQUIRE(checkResourceMap(world, ai, res));
+}
+
+BOOST_FIXTURE_TEST_CASE(ResourceMapsFollowRoads, EmptyWorldFixture1P)
+{
+    TestAIPlayer ai(0, world, AI::EASY);
+    AIBase& aiBase = ai;
+    const MapPoint hqPos = world.GetPlayer(0).GetHQPos();
+    const MapPoint hqFlagPos = world.GetNeighbour(hqPos, Direction::SOUTHEAST);
+    std::vector<Direction> route(4, Direction::EAST);
+    const MapPoint roadPt = world.GetNeighbour(hqFlagPos, Direction::EAST);
+    BOOST_REQUIRE_EQUAL(ai.GetAINode(roadPt).res, AIJH::PLANTSPACE);
+    const int plantSpaceBefore = ai.GetResMapValue(roadPt, AIJH::PLANTSPACE);
+
+    // Build a road over plant space as the AI does after its road command was executed
+    world.BuildRoad(0, false, hqFlagPos, route);
+    BOOST_REQUIRE(world.GetPointRoad(hqFlagPos, Direction::EAST));
+    ai.RecalcGround(hqPos, route);
+    aiBase.RunGF(1, false);
+
+    // The map must equal a freshly calculated one
+    std::vector<gc::GameCommandPtr> gcs;
+    AIInterface aii(world, gcs, 0);
+    const std::vector<AIJH::Node> nodes;
+    AIResourceMap expectedMap(AIJH::PLANTSPACE, aii, nodes);
+    expectedMap.Init();
+    RTTR_FOREACH_PT(MapPoint, world.GetSize())
+        BOOST_REQUIRE_EQUAL(ai.GetResMapValue(pt, AIJH::PLANTSPACE), expectedMap[pt]);
+    // and the road is no plant space anymore
+    BOOST_REQUIRE_EQUAL(ai.GetAINode(roadPt).res, AIJH::NOTHING);
+    BOOST_REQUIRE_LT(ai.GetResMapValue(roadPt, AIJH::PLANTSPACE), plantSpaceBefore);
+}
+
+BOOST_FIXTURE_TEST_CASE(BestPositionMatchesLiveSearch, EmptyWorldFixture1P)
+{
+    TestAIPlayer ai(0, world, AI::EASY);
+    AIBase& aiBase = ai;
+    addForest(world);
+    aiBase.RunGF(1, false);
+
+    std::vector<gc::GameCommandPtr> gcs;
+    AIInterface aii(world, gcs, 0);
+    // Start at the HQ, so the start point itself (which the old search skipped) is not usable
+    const MapPoint hqPos = world.GetPlayer(0).GetHQPos();
+    const AIJH::Resource resources[] = {AIJH::WOOD, AIJH::PLANTSPACE};
+    BOOST_FOREACH(AIJH::Resource res, resources)
+    {
+        const int radius = 11;
+        const int expectedValue = findBestValueLive(world, aii, ai, hqPos, res, BQ_HUT, radius);
+        MapPoint pt = hqPos;
+        // Positions can differ for equal values, so only compare the values
+        if(expectedValue < 1)
+            BOOST_REQUIRE(!ai.FindBestPosition(pt, res, BQ_HUT, 1, radius, true));
+        else
+        {
+            BOOST_REQUIRE(ai.FindBestPosition(pt, res, BQ_HUT, 1, radius, true));
+            BOOST_REQUIRE_EQUAL(ai.GetResMapValue(pt, res), expectedValue);
+            BOOST_REQUIRE_EQUAL(aii.CalcResourceValue(pt, res), expectedValue);
+        }
+    }
+}
+
+// Only a timing, not a check. Define RTTR_BENCHMARKS to build it
+#ifdef RTTR_BENCHMARKS
+BOOST_FIXTURE_TEST_CASE(BestPositionBenchmark, EmptyWorldFixture1P)
+{
+    TestAIPlayer ai(0, world, AI::EASY);
+    AIBase& aiBase = ai;
+    addForest(world);
+    aiBase.RunGF(1, false);
+
+    std::vector<gc::GameCommandPtr> gcs;
+    AIInterface aii(world, gcs, 0);
+    const int radius = 11;
+    clock_t liveTime = 0, mapTime = 0;
+    int checksum = 0;
+    RTTR_FOREACH_PT(MapPoint, world.GetSize())
+    {
+        clock_t start = std::clock();
+        checksum += findBestValueLive(world, aii, ai, pt, AIJH::WOOD, BQ_HUT, radius);
+        liveTime += std::clock() - start;
+
+        start = std::clock();
+        MapPoint bestPt = pt;
+        if(ai.FindBestPosition(bestPt, AIJH::WOOD, BQ_HUT, 1, radius, true))
+            checksum += ai.GetResMapValue(bestPt, AIJH::WOOD);
+        mapTime += std::clock() - start;
+    }
+    BOOST_TEST_MESSAGE("Best wood positions: " << liveTime << " ticks with the live search, " << mapTime
+                                               << " ticks with the resource map (checksum " << checksum << ")");
+}
+#endif // RTTR_BENCHMARKS
+
+BOOST_FIXTURE_TEST_CASE(MapLayerSums, EmptyWorldFixture1P)
+{
+    AIMapLayer layer;
+    layer.Init(world.GetSize());
+    // Some pseudo random pattern
+    RTTR_FOREACH_PT(MapPoint, world.GetSize())
+    {
+        if((pt.x * 7 + pt.y * 13) % 5 < 2)
+            layer.Set(pt, 1);
+    }
+    for(unsigned radius = 1; radius <= 8; radius++)
+        BOOST_REQUIRE_EQUAL(AIMapLayer::GetNumPointsInRadius(radius), world.GetPointsInRadiusWithCenter(MapPoint(0, 0), radius).size());
+
+    // Compare against counting the points directly (includes points wrapping around the map border)
+    const unsigned radius = 6;
+    clock_t layerTime = 0, pointsTime = 0;
+    RTTR_FOREACH_PT(MapPoint, world.GetSize())
+    {
+        clock_t start = std::clock();
+        const int sum = layer.GetSumInRadius(pt, radius);
+        layerTime += std::clock() - start;
+
+        start = std::clock();
+        std::vector<bool> isSet = world.GetPointsInRadius<0>(pt, radius, IsValueSet(layer), ReturnConst<bool, true>(), true);
+        const int expectedSum = static_cast<int>(std::count(isSet.begin(), isSet.end(), true));
+        pointsTime += std::clock() - start;
+        BOOST_REQUIRE_EQUAL(sum, expectedSum);
+    }
+    BOOST_TEST_MESSAGE("Radius sums: " << layerTime << " ticks with the layer, " << pointsTime << " ticks with GetPointsInRadius");
+
+    // Changes are reflected
+    const MapPoint pt(10, 11);
+    const int oldSum = layer.GetSumInRadius(pt, 2);
+    const MapPoint changedPt = world.GetNeighbour2(pt, 3);
+    layer.Set(changedPt, layer[changedPt] + 5);
+    BOOST_REQUIRE_EQUAL(layer.GetSumInRadius(pt, 2), oldSum + 5);
+}
+
+BOOST_FIXTURE_TEST_CASE(DensityFollowsResources, EmptyWorldFixture1P)
+{
+    TestAIPlayer ai(0, world, AI::EASY);
+    AIBase& aiBase = ai;
+    const MapPoint hqPos = world.GetPlayer(0).GetHQPos();
+    const MapPoint pt = world.MakeMapPoint(Point<int>(hqPos) + Point<int>(0, 6));
+    BOOST_REQUIRE_EQUAL(ai.GetDensity(pt, AIJH::WOOD, 2), 0u);
+    // Surround pt by trees
+    for(unsigned dir = 0; dir < 6; dir++)
+    {
+        const MapPoint treePt = world.GetNeighbour(pt, dir);
+        world.SetNO(treePt, new noTree(treePt, 0, 3));
+        world.RecalcBQAroundPointBig(treePt);
+    }
+    aiBase.RunGF(1, false);
+    // 6 of the 18 surrounding points
+    BOOST_REQUIRE_EQUAL(ai.GetDensity(pt, AIJH::WOOD, 2), 6u * 100u / 18u);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
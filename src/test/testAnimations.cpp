@@ -660,4 +660,39 @@ BOOST_AUTO_TEST_CASE(ToogleAnim)
     BOOST_REQUIRE(bt2->GetIlluminated());
 }
 
+BOOST_AUTO_TEST_CASE(RedrawOnlyOnChanges)
+{
+    MockupVideoDriver* video = GetVideoDriver();
+    Desktop* dsk = new Desktop(NULL);
+    WINDOWMANAGER.Switch(dsk);
+    BOOST_REQUIRE(WINDOWMANAGER.NeedsRedraw(video->tickCount_));
+    bt = dsk->AddTextButton(0, DrawPoint(10, 20), Extent(100, 20), TC_RED1, "", NormalFont);
+    WINDOWMANAGER.Draw();
+    BOOST_REQUIRE(!WINDOWMANAGER.NeedsRedraw(video->tickCount_));
+    // Changed controls
+    bt->SetVisible(false);
+    BOOST_REQUIRE(WINDOWMANAGER.NeedsRedraw(video->tickCount_));
+    WINDOWMANAGER.Draw();
+    BOOST_REQUIRE(!WINDOWMANAGER.NeedsRedraw(video->tickCount_));
+    // Refresh from time to time anyway
+    BOOST_REQUIRE(WINDOWMANAGER.NeedsRedraw(video->tickCount_ + 1000));
+    // Scheduled redraw
+    WINDOWMANAGER.ScheduleRedraw(video->tickCount_ + 10);
+    BOOST_REQUIRE(!WINDOWMANAGER.NeedsRedraw(video->tickCount_ + 9));
+    BOOST_REQUIRE(WINDOWMANAGER.NeedsRedraw(video->tickCount_ + 10));
+    WINDOWMANAGER.Draw();
+    BOOST_REQUIRE(!WINDOWMANAGER.NeedsRedraw(video->tickCount_));
+    // Running animations
+    dsk->GetAnimationManager().addAnimation(new MoveAnimation(bt, DrawPoint(100, 20), 1000, Animation::RPT_None));
+    BOOST_REQUIRE(WINDOWMANAGER.NeedsRedraw(video->tickCount_));
+    WINDOWMANAGER.Draw();
+    BOOST_REQUIRE(WINDOWMANAGER.NeedsRedraw(video->tickCount_));
+    video->tickCount_ += 1100;
+    WINDOWMANAGER.Draw();
+    // The last step moved the button, so it is drawn once more
+    BOOST_REQUIRE(WINDOWMANAGER.NeedsRedraw(video->tickCount_));
+    WINDOWMANAGER.Draw();
+    BOOST_REQUIRE(!WINDOWMANAGER.NeedsRedraw(video->tickCount_));
+}
+
 BOOST_AUTO_TEST_SUITE_END()
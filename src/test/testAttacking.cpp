@@ -25,6 +25,7 @@
 #include "world/GameWorldViewer.h"
 #include "nodeObjs/noFlag.h"
 #include "gameData/SettingTypeConv.h"
+#include "test/PointOutput.h"
 #include "test/WorldWithGCExecution.h"
 #include "test/initTestHelpers.h"
 #include <boost/foreach.hpp>
@@ -33,6 +34,23 @@
 
 BOOST_AUTO_TEST_SUITE(AttackSuite)
 
+namespace {
+/// Collects the entries of the military squares and checks that they match their buildings
+struct CollectMilEntries
+{
+    std::vector<nobBaseMilitary*> buildings;
+    bool operator()(const MilitarySquares::Entry& entry)
+    {
+        BOOST_CHECK_EQUAL(entry.pos, entry.bld->GetPos());
+        BOOST_CHECK_EQUAL(entry.player, entry.bld->GetPlayer());
+        BOOST_CHECK_EQUAL(entry.type, entry.bld->GetBuildingType());
+        BOOST_CHECK_EQUAL(entry.radius, entry.bld->GetMilitaryRadius());
+        buildings.push_back(entry.bld);
+        return false;
+    }
+};
+} // namespace
+
 struct AttackDefaults
 {
     BOOST_STATIC_CONSTEXPR unsigned width = 58;
@@ -389,4 +407,77 @@ BOOST_FIXTURE_TEST_CASE(ConquerBld, AttackFixture)
     }
 }
 
+BOOST_FIXTURE_TEST_CASE(MilitarySquaresQueries, AttackFixture)
+{
+    for(unsigned radius = 1; radius <= 4; radius++)
+    {
+        for(MapPoint pt(0, 0); pt.y < world.GetHeight(); pt.y += 5)
+        {
+            for(pt.x = 0; pt.x < world.GetWidth(); pt.x += 5)
+            {
+                sortedMilitaryBlds expectedBlds = world.LookForMilitaryBuildings(pt, radius);
+                CollectMilEntries collector;
+                BOOST_REQUIRE(!world.militarySquares.VisitBuildingsInRange(pt, radius, collector));
+                // Each building is visited exactly once
+                BOOST_REQUIRE_EQUAL(collector.buildings.size(), expectedBlds.size());
+                BOOST_FOREACH(nobBaseMilitary* bld, collector.buildings)
+                    BOOST_REQUIRE(expectedBlds.count(bld));
+            }
+        }
+    }
+    // All buildings are found on this small map
+    CollectMilEntries collector;
+    world.militarySquares.VisitBuildingsInRange(hqPos[0], 4, collector);
+    BOOST_REQUIRE_EQUAL(collector.buildings.size(), 6u);
+}
+
+BOOST_FIXTURE_TEST_CASE(HumanPathsToMultipleGoals, AttackFixture)
+{
+    std::vector<MapPoint> goals;
+    RTTR_FOREACH_PT(MapPoint, world.GetSize())
+    {
+        if((pt.x + 3 * pt.y) % 7 == 0)
+            goals.push_back(pt);
+    }
+    // Buildings are not passable but can be reached
+    goals.push_back(milBld1NearPos);
+    goals.push_back(milBld2Pos);
+    goals.push_back(hqPos[1]);
+    const MapPoint starts[] = {hqPos[0], milBld1FarPos};
+    const unsigned maxRoutes[] = {5, 20, 100};
+    BOOST_FOREACH(const MapPoint start, starts)
+    {
+        BOOST_FOREACH(const unsigned maxRoute, maxRoutes)
+        {
+            const std::vector<bool> isReachable = world.CheckHumanPaths(start, goals, maxRoute);
+            BOOST_REQUIRE_EQUAL(isReachable.size(), goals.size());
+            for(unsigned i = 0; i < goals.size(); i++)
+            {
+                if(goals[i] == start)
+                    BOOST_REQUIRE(isReachable[i]);
+                else
+                    BOOST_REQUIRE_EQUAL(isReachable[i], world.FindHumanPath(start, goals[i], maxRoute) != 0xFF);
+            }
+        }
+    }
+}
+
+BOOST_FIXTURE_TEST_CASE(FrontierChecksInMilitaryBatch, AttackFixture)
+{
+    nobMilitary* bld = world.GetSpecObj<nobMilitary>(milBld1NearPos);
+    BOOST_REQUIRE(bld);
+    const unsigned oldFrontierDistance = bld->GetFrontierDistance();
+    world.BeginMilitaryBatch();
+    // Destroying a building lets the enemy buildings around check their frontier distance
+    world.DestroyNO(hqPos[0]);
+    world.GetPlayer(1).RecalcMilitaryFlags();
+    // Delayed till the end of the batch
+    BOOST_REQUIRE_EQUAL(bld->GetFrontierDistance(), oldFrontierDistance);
+    world.EndMilitaryBatch();
+    // Same result as checking directly
+    const unsigned frontierDistance = bld->GetFrontierDistance();
+    bld->LookForEnemyBuildings();
+    BOOST_REQUIRE_EQUAL(bld->GetFrontierDistance(), frontierDistance);
+}
+
 BOOST_AUTO_TEST_SUITE_END()
@@ -436,4 +436,36 @@ BOOST_FIXTURE_TEST_CASE(BQNearObjects, EmptyWorldFixture1P)
     BOOST_REQUIRE(world.IsRoadAvailable(false, world.GetNeighbour(objPos, Direction::SOUTHWEST)));
 }
 
+BOOST_FIXTURE_TEST_CASE(BQInvalidation, EmptyWorldFixture1P)
+{
+    const MapPoint objPos = world.GetPlayer(0).GetHQPos() - MapPoint(3, 6);
+    const std::vector<MapPoint> ptsAroundObj = world.GetPointsInRadiusWithCenter(objPos, 2);
+    world.DestroyNO(objPos, false);
+    world.SetNO(objPos, new noStaticObject(objPos, 0, 0, 2));
+    // Nothing recalculated yet
+    BOOST_REQUIRE(checkBQs(world, ptsAroundObj, ReducedBQMap()));
+    BOOST_FOREACH(MapPoint pt, ptsAroundObj)
+        world.InvalidateBQ(pt);
+    // Still not recalculated
+    BOOST_REQUIRE(checkBQs(world, ptsAroundObj, ReducedBQMap()));
+    world.RecalcDirtyBQs();
+    ReducedBQMap reducedBQs;
+    BOOST_FOREACH(MapPoint pt, ptsAroundObj)
+    {
+        if(world.GetNode(pt).bq != BQ_CASTLE)
+            reducedBQs[pt] = world.GetNode(pt).bq;
+    }
+    BOOST_REQUIRE(!reducedBQs.empty());
+    // Must be the same as recalculating everything
+    world.InitAfterLoad();
+    BOOST_REQUIRE(checkBQs(world, world.GetPointsInRadiusWithCenter(objPos, 4), reducedBQs));
+
+    // Changing the terrain is respected too
+    const MapPoint waterPt(2, 2);
+    BOOST_REQUIRE_EQUAL(world.GetNode(waterPt).bq, BQ_CASTLE);
+    world.GetNodeWriteable(waterPt).t1 = TT_WATER;
+    world.RecalcBQ(waterPt);
+    BOOST_REQUIRE_NE(world.GetNode(waterPt).bq, BQ_CASTLE);
+}
+
 BOOST_AUTO_TEST_SUITE_END()
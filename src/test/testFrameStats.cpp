@@ -0,0 +1,46 @@
+// Copyright (c) 2016 Settlers Freaks (sf-team at siedler25.org)
+//
+// This file is part of Return To The Roots.
+//
+// Return To The Roots is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 2 of the License, or
+// (at your option) any later version.
+//
+// Return To The Roots is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Return To The Roots. If not, see <http://www.gnu.org/licenses/>.
+
+#include "defines.h" // IWYU pragma: keep
+#include "FrameStats.h"
+#include <boost/test/unit_test.hpp>
+
+BOOST_AUTO_TEST_SUITE(FrameStatsSuite)
+
+BOOST_AUTO_TEST_CASE(FrameStatsPercentiles)
+{
+    FrameStats stats(10);
+    BOOST_REQUIRE_EQUAL(stats.GetPercentile(50), 0u);
+    // 1..10 in random order
+    const unsigned frameTimes[] = {4, 9, 1, 7, 10, 2, 5, 8, 3, 6};
+    for(unsigned i = 0; i < 10; i++)
+        stats.AddFrame(frameTimes[i]);
+    BOOST_REQUIRE_EQUAL(stats.GetNumFrames(), 10u);
+    BOOST_REQUIRE_EQUAL(stats.GetPercentile(0), 1u);
+    BOOST_REQUIRE_EQUAL(stats.GetPercentile(50), 5u);
+    BOOST_REQUIRE_EQUAL(stats.GetPercentile(100), 10u);
+    // Only the last frames are used
+    for(unsigned i = 0; i < 9; i++)
+        stats.AddFrame(20);
+    BOOST_REQUIRE_EQUAL(stats.GetNumFrames(), 10u);
+    BOOST_REQUIRE_EQUAL(stats.GetPercentile(0), 6u);
+    BOOST_REQUIRE_EQUAL(stats.GetPercentile(50), 20u);
+    stats.Clear();
+    BOOST_REQUIRE_EQUAL(stats.GetNumFrames(), 0u);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
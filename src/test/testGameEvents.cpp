@@ -192,6 +192,42 @@ BOOST_AUTO_TEST_CASE(RemoveEvent)
     BOOST_CHECK(!evMgr.ObjectHasEvents(&obj));
 }
 
+BOOST_AUTO_TEST_CASE(LongEvents)
+{
+    EventManager evMgr(10);
+    TestRemoveEvent obj(evMgr);
+    // Events far in the future are stored differently. Make sure they keep the order in which they were added
+    // relative to events added later for the same GF
+    evMgr.AddEvent(&obj, 10000, 1);
+    evMgr.AddEvent(&obj, 20000, 2);
+    evMgr.AddEvent(&obj, 10000, 3);
+    GameEvent* evToRemove = evMgr.AddEvent(&obj, 30000, 4);
+    evMgr.AddEvent(&obj, 30000, 5);
+    BOOST_CHECK(evMgr.IsEventActive(&obj, 4));
+    evMgr.RemoveEvent(evToRemove);
+    BOOST_REQUIRE(!evToRemove);
+    BOOST_CHECK(!evMgr.IsEventActive(&obj, 4));
+    BOOST_CHECK(evMgr.IsEventActive(&obj, 5));
+    while(evMgr.GetCurrentGF() < 10000)
+        evMgr.ExecuteNextGF();
+    BOOST_REQUIRE_EQUAL(obj.handledEventIds.size(), 0u);
+    evMgr.AddEvent(&obj, 10, 6);
+    evMgr.AddEvent(&obj, 10010 - evMgr.GetCurrentGF(), 7);
+    for(unsigned i = 0; i < 10; i++)
+        evMgr.ExecuteNextGF();
+    BOOST_REQUIRE_EQUAL(obj.handledEventIds.size(), 4u);
+    BOOST_REQUIRE_EQUAL(obj.handledEventIds[0], 1u);
+    BOOST_REQUIRE_EQUAL(obj.handledEventIds[1], 3u);
+    BOOST_REQUIRE_EQUAL(obj.handledEventIds[2], 6u);
+    BOOST_REQUIRE_EQUAL(obj.handledEventIds[3], 7u);
+    while(evMgr.GetCurrentGF() < 30010)
+        evMgr.ExecuteNextGF();
+    BOOST_REQUIRE_EQUAL(obj.handledEventIds.size(), 6u);
+    BOOST_REQUIRE_EQUAL(obj.handledEventIds[4], 2u);
+    BOOST_REQUIRE_EQUAL(obj.handledEventIds[5], 5u);
+    BOOST_CHECK(!evMgr.ObjectHasEvents(&obj));
+}
+
 BOOST_AUTO_TEST_CASE(InvalidEvent)
 {
 #if RTTR_ENABLE_ASSERTS
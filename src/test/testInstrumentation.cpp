@@ -0,0 +1,112 @@
+// Copyright (c) 2016 Settlers Freaks (sf-team at siedler25.org)
+//
+// This file is part of Return To The Roots.
+//
+// Return To The Roots is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 2 of the License, or
+// (at your option) any later version.
+//
+// Return To The Roots is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Return To The Roots. If not, see <http://www.gnu.org/licenses/>.
+
+#include "defines.h" // IWYU pragma: keep
+#include "Instrumentation.h"
+#include <boost/filesystem/fstream.hpp>
+#include <boost/filesystem/operations.hpp>
+#include <boost/test/unit_test.hpp>
+#include <sstream>
+#include <string>
+
+BOOST_AUTO_TEST_SUITE(InstrumentationSuite)
+
+BOOST_AUTO_TEST_CASE(InstrumentationStats)
+{
+    Instrumentation& instr = INSTRUMENTATION;
+    instr.Clear();
+    // Nothing is measured while disabled
+    {
+        Instrumentation::ScopedTimer timer(INSTR_PATHFINDING);
+        timer.AddCount(5);
+    }
+    instr.EndGF(0);
+    BOOST_REQUIRE_EQUAL(instr.GetCurrentGF()[INSTR_PATHFINDING].count, 0u);
+    BOOST_REQUIRE_EQUAL(instr.GetNumGFs(), 0u);
+
+    const bfs::path tracePath = bfs::temp_directory_path() / bfs::unique_path("rttrTrace-%%%%-%%%%.json");
+    BOOST_REQUIRE(instr.StartTrace(tracePath.string()));
+    BOOST_REQUIRE(instr.IsEnabled());
+    for(unsigned gf = 1; gf <= 4; gf++)
+    {
+        {
+            Instrumentation::ScopedTimer timer(INSTR_EVENTS);
+            timer.AddCount(2);
+            // Nested scopes of the same subsystem are only 1 call
+            Instrumentation::ScopedTimer innerTimer(INSTR_EVENTS);
+            innerTimer.AddCount();
+            Instrumentation::ScopedTimer pathTimer(INSTR_PATHFINDING);
+            pathTimer.AddCount(gf);
+        }
+        instr.EndGF(gf);
+    }
+    BOOST_REQUIRE_EQUAL(instr.GetNumGFs(), 4u);
+    BOOST_REQUIRE_EQUAL(instr.GetAverage(INSTR_EVENTS).numCalls, 1u);
+    BOOST_REQUIRE_EQUAL(instr.GetAverage(INSTR_EVENTS).count, 3u);
+    BOOST_REQUIRE_EQUAL(instr.GetAverage(INSTR_PATHFINDING).numCalls, 1u);
+    BOOST_REQUIRE_EQUAL(instr.GetAverage(INSTR_PATHFINDING).count, 2u);
+    BOOST_REQUIRE_EQUAL(instr.GetMax(INSTR_PATHFINDING).count, 4u);
+    BOOST_REQUIRE_EQUAL(instr.GetAverage(INSTR_AI).numCalls, 0u);
+
+    // Drawing is measured per frame, independent of the GFs
+    for(unsigned frame = 1; frame <= 3; frame++)
+    {
+        Instrumentation::ScopedTimer timer(INSTR_TERRAIN);
+        timer.AddCount(frame * 10);
+    }
+    BOOST_REQUIRE_EQUAL(instr.GetCurrentGF()[INSTR_TERRAIN].numCalls, 0u);
+    BOOST_REQUIRE_EQUAL(instr.GetCurrentFrame()[INSTR_TERRAIN].numCalls, 3u);
+    instr.EndGF(5);
+    BOOST_REQUIRE_EQUAL(instr.GetNumFrames(), 0u);
+    BOOST_REQUIRE_EQUAL(instr.GetCurrentFrame()[INSTR_TERRAIN].count, 60u);
+    instr.EndFrame();
+    for(unsigned frame = 1; frame <= 3; frame++)
+    {
+        {
+            Instrumentation::ScopedTimer timer(INSTR_TERRAIN);
+            timer.AddCount(frame * 10);
+        }
+        instr.EndFrame();
+    }
+    BOOST_REQUIRE_EQUAL(instr.GetNumGFs(), 5u);
+    BOOST_REQUIRE_EQUAL(instr.GetNumFrames(), 4u);
+    BOOST_REQUIRE_EQUAL(instr.GetAverage(INSTR_TERRAIN).numCalls, 1u);
+    BOOST_REQUIRE_EQUAL(instr.GetAverage(INSTR_TERRAIN).count, 30u);
+    BOOST_REQUIRE_EQUAL(instr.GetMax(INSTR_TERRAIN).count, 60u);
+
+    // Disabling finishes the trace
+    instr.SetEnabled(false);
+    BOOST_REQUIRE(!instr.IsTracing());
+    std::string trace;
+    {
+        bfs::ifstream traceFile(tracePath);
+        std::stringstream content;
+        content << traceFile.rdbuf();
+        trace = content.str();
+    }
+    bfs::remove(tracePath);
+    BOOST_REQUIRE_EQUAL(trace.substr(0, 2), "[\n");
+    BOOST_REQUIRE_EQUAL(trace.substr(trace.size() - 3), "\n]\n");
+    BOOST_REQUIRE_NE(trace.find("{\"name\":\"Events\",\"ph\":\"X\""), std::string::npos);
+    BOOST_REQUIRE_NE(trace.find("{\"name\":\"Pathfinding\",\"ph\":\"X\""), std::string::npos);
+    BOOST_REQUIRE_NE(trace.find("\"args\":{\"count\":4}"), std::string::npos);
+    BOOST_REQUIRE_NE(trace.find("{\"name\":\"GF 4\",\"ph\":\"i\""), std::string::npos);
+    BOOST_REQUIRE_NE(trace.find("{\"name\":\"Time per frame (us)\",\"ph\":\"C\""), std::string::npos);
+    instr.Clear();
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,107 @@
+// Copyright (c) 2016 Settlers Freaks (sf-team at siedler25.org)
+//
+// This file is part of Return To The Roots.
+//
+// Return To The Roots is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 2 of the License, or
+// (at your option) any later version.
+//
+// Return To The Roots is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Return To The Roots. If not, see <http://www.gnu.org/licenses/>.
+
+#include "defines.h" // IWYU pragma: keep
+#include "helpers/LRUCache.h"
+#include <boost/test/unit_test.hpp>
+#include <string>
+
+BOOST_AUTO_TEST_SUITE(LRUCacheSuite)
+
+BOOST_AUTO_TEST_CASE(EvictsLeastRecentlyInserted)
+{
+    helpers::LRUCache<unsigned, std::string> cache(3);
+    BOOST_REQUIRE_EQUAL(cache.maxSize(), 3u);
+    BOOST_REQUIRE(!cache.find(1));
+    cache.insert(1, "a");
+    cache.insert(2, "b");
+    cache.insert(3, "c");
+    BOOST_REQUIRE_EQUAL(cache.size(), 3u);
+    // Full -> Oldest one (1) is removed
+    BOOST_REQUIRE_EQUAL(cache.insert(4, "d"), "d");
+    BOOST_REQUIRE_EQUAL(cache.size(), 3u);
+    BOOST_REQUIRE(!cache.find(1));
+    cache.insert(5, "e");
+    BOOST_REQUIRE(!cache.find(2));
+    BOOST_REQUIRE(cache.find(3));
+    BOOST_REQUIRE(cache.find(4));
+    BOOST_REQUIRE(cache.find(5));
+
+    cache.clear();
+    BOOST_REQUIRE_EQUAL(cache.size(), 0u);
+    BOOST_REQUIRE(!cache.find(3));
+}
+
+BOOST_AUTO_TEST_CASE(FindAndReplaceAreUses)
+{
+    helpers::LRUCache<unsigned, std::string> cache(3);
+    cache.insert(1, "a");
+    cache.insert(2, "b");
+    cache.insert(3, "c");
+    // Finding 1 makes 2 the oldest one
+    std::string* value = cache.find(1);
+    BOOST_REQUIRE(value);
+    BOOST_REQUIRE_EQUAL(*value, "a");
+    cache.insert(4, "d");
+    BOOST_REQUIRE(!cache.find(2));
+    BOOST_REQUIRE(cache.find(1));
+    // Replacing 3 makes it the newest one without changing the size
+    BOOST_REQUIRE_EQUAL(cache.insert(3, "c2"), "c2");
+    BOOST_REQUIRE_EQUAL(cache.size(), 3u);
+    cache.insert(5, "e");
+    BOOST_REQUIRE(!cache.find(4));
+    BOOST_REQUIRE_EQUAL(*cache.find(3), "c2");
+    BOOST_REQUIRE(cache.find(1));
+    BOOST_REQUIRE(cache.find(5));
+    // Values can be changed through the returned pointer
+    *cache.find(5) = "e2";
+    BOOST_REQUIRE_EQUAL(*cache.find(5), "e2");
+}
+
+BOOST_AUTO_TEST_CASE(CapacityOfOne)
+{
+    helpers::LRUCache<unsigned, std::string> cache(1);
+    cache.insert(1, "a");
+    BOOST_REQUIRE_EQUAL(*cache.find(1), "a");
+    cache.insert(1, "b");
+    BOOST_REQUIRE_EQUAL(cache.size(), 1u);
+    BOOST_REQUIRE_EQUAL(*cache.find(1), "b");
+    cache.insert(2, "c");
+    BOOST_REQUIRE_EQUAL(cache.size(), 1u);
+    BOOST_REQUIRE(!cache.find(1));
+    BOOST_REQUIRE_EQUAL(*cache.find(2), "c");
+}
+
+BOOST_AUTO_TEST_CASE(CopiesAreIndependent)
+{
+    helpers::LRUCache<unsigned, std::string> cache(2);
+    cache.insert(1, "a");
+    cache.insert(2, "b");
+    helpers::LRUCache<unsigned, std::string> copy(cache);
+    cache.insert(3, "c");
+    BOOST_REQUIRE(!cache.find(1));
+    BOOST_REQUIRE_EQUAL(*copy.find(1), "a");
+    // The copy has its own order: 1 was used last, so 2 is removed
+    copy.insert(4, "d");
+    BOOST_REQUIRE(!copy.find(2));
+    BOOST_REQUIRE(copy.find(1));
+    copy = cache;
+    BOOST_REQUIRE(copy.find(3));
+    BOOST_REQUIRE(!copy.find(4));
+}
+
+BOOST_AUTO_TEST_SUITE_END()
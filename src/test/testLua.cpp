@@ -676,4 +676,129 @@ BOOST_AUTO_TEST_CASE(WorldEvents)
     BOOST_REQUIRE_EQUAL(getLog(), (resFmt % 2 % pt3 % "Water" % 5).str());
 }
 
+BOOST_AUTO_TEST_CASE(BatchedWorldEvents)
+{
+    const MapPoint pt1(3, 4), pt2(5, 1), pt3(7, 6);
+    LuaInterfaceGame& lua = world.GetLua();
+    // Nothing to send
+    lua.SendEventBatches();
+    executeLua("function onExploredBatch(player_id, points)\n"
+               "  for i, pt in ipairs(points) do\n"
+               "    rttr:Log('explored: '..player_id..'('..pt.x..', '..pt.y..')'..tostring(pt.owner))\n"
+               "  end\n"
+               "end");
+    executeLua("function onOccupiedBatch(player_id, points)\n  rttr:Log('occupied: '..player_id..':'..#points)\nend");
+    clearLog();
+    lua.EventExplored(1, pt1, 0);
+    lua.EventExplored(0, pt2, 2);
+    lua.EventExplored(1, pt3, 1);
+    lua.EventOccupied(2, pt1);
+    lua.EventOccupied(2, pt2);
+    // Events are only sent at the end of the GF, grouped by player
+    BOOST_REQUIRE_EQUAL(getLog(), "");
+    lua.SendEventBatches();
+    boost::format exploredFmt("explored: %1%%2%%3%\n");
+    std::string expectedLog = (exploredFmt % 0 % pt2 % 1).str();
+    expectedLog += (exploredFmt % 1 % pt1 % "nil").str();
+    expectedLog += (exploredFmt % 1 % pt3 % 0).str();
+    expectedLog += "occupied: 2:2\n";
+    BOOST_REQUIRE_EQUAL(getLog(), expectedLog);
+    // ...and only once
+    lua.SendEventBatches();
+    BOOST_REQUIRE_EQUAL(getLog(), "");
+
+    // Per node callbacks are still called directly
+    executeLua("function onOccupied(player_id, x, y)\n  rttr:Log('occupied')\nend");
+    lua.EventOccupied(1, pt1);
+    BOOST_REQUIRE_EQUAL(getLog(), "occupied\n");
+    lua.SendEventBatches();
+    BOOST_REQUIRE_EQUAL(getLog(), "occupied: 1:1\n");
+
+    // Callbacks changed by other callbacks are used
+    executeLua("function onGameFrame(gameframe_number)\n"
+               "  onOccupied = function(player_id, x, y) rttr:Log('new occupied') end\n"
+               "  onOccupiedBatch = nil\n"
+               "end");
+    lua.EventGameFrame(1);
+    lua.EventOccupied(1, pt1);
+    BOOST_REQUIRE_EQUAL(getLog(), "new occupied\n");
+    lua.SendEventBatches();
+    BOOST_REQUIRE_EQUAL(getLog(), "");
+
+    // Also by the per node callbacks themselves
+    executeLua("function onOccupied(player_id, x, y)\n"
+               "  rttr:Log('first occupied')\n"
+               "  onOccupied = function(player_id, x, y) rttr:Log('second occupied') end\n"
+               "end");
+    lua.EventOccupied(1, pt1);
+    lua.EventOccupied(1, pt2);
+    BOOST_REQUIRE_EQUAL(getLog(), "first occupied\nsecond occupied\n");
+    executeLua("function onExplored(player_id, x, y, owner)\n"
+               "  rttr:Log('first explored')\n"
+               "  onExplored = function(player_id, x, y, owner) rttr:Log('second explored') end\n"
+               "end");
+    lua.EventExplored(1, pt1, 0);
+    lua.EventExplored(1, pt2, 0);
+    BOOST_REQUIRE_EQUAL(getLog(), "first explored\nsecond explored\n");
+
+    // Other callbacks defined by them are used from the end of the GF
+    executeLua("function onGameFrame(gameframe_number)\nend");
+    executeLua("function onOccupied(player_id, x, y)\n"
+               "  onGameFrame = function(gameframe_number) rttr:Log('gf: '..gameframe_number) end\n"
+               "end");
+    lua.EventOccupied(1, pt1);
+    lua.EventGameFrame(2);
+    BOOST_REQUIRE_EQUAL(getLog(), "gf: 2\n");
+}
+
+BOOST_AUTO_TEST_CASE(Profiler)
+{
+    LuaInterfaceGame& lua = world.GetLua();
+    LuaProfiler& profiler = lua.GetProfiler();
+    profiler.SetEnabled(true);
+    executeLua("function onGameFrame(gameframe_number)\n"
+               "  local sum = 0\n"
+               "  for i = 1, 100000 do\n"
+               "    sum = sum + i\n"
+               "  end\n"
+               "end");
+    clearLog();
+    // Budget not exceeded -> No warning
+    profiler.SetGFBudget(10000000);
+    lua.EventGameFrame(1);
+    BOOST_REQUIRE_EQUAL(getLog(), "");
+    // Counter is reset for the next GF
+    BOOST_REQUIRE_EQUAL(profiler.GetNumInstructionsInGF(), 0u);
+    std::string report = profiler.GetReport();
+    BOOST_REQUIRE_NE(report.find("onGameFrame: 1, "), std::string::npos);
+    // Samples of the function defined in line 1 and the lines of the loop
+    BOOST_REQUIRE_NE(report.find("\"]:1"), std::string::npos);
+    const std::string lines = report.substr(report.find("Lines:\n"));
+    BOOST_REQUIRE(lines.find("\"]:3: ") != std::string::npos || lines.find("\"]:4: ") != std::string::npos);
+
+    // Budget exceeded -> Warning with the offender
+    profiler.SetGFBudget(10000);
+    lua.EventGameFrame(2);
+    const std::string warning = getLog();
+    BOOST_REQUIRE_NE(warning.find("GF 2"), std::string::npos);
+    BOOST_REQUIRE_NE(warning.find("onGameFrame"), std::string::npos);
+    // Not repeated immediately
+    lua.EventGameFrame(3);
+    BOOST_REQUIRE_EQUAL(getLog(), "");
+    lua.EventGameFrame(2 + LuaProfiler::BUDGET_WARNING_INTERVAL);
+    BOOST_REQUIRE_NE(getLog(), "");
+
+    // Budget also works without profiling
+    profiler.SetEnabled(false);
+    profiler.Reset();
+    lua.EventGameFrame(2 + 2 * LuaProfiler::BUDGET_WARNING_INTERVAL);
+    BOOST_REQUIRE_NE(getLog(), "");
+    report = profiler.GetReport();
+    BOOST_REQUIRE_EQUAL(report.find("onGameFrame"), std::string::npos);
+    // No budget -> No warning
+    profiler.SetGFBudget(0);
+    lua.EventGameFrame(3 + 2 * LuaProfiler::BUDGET_WARNING_INTERVAL);
+    BOOST_REQUIRE_EQUAL(getLog(), "");
+}
+
 BOOST_AUTO_TEST_SUITE_END()
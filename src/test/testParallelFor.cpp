@@ -0,0 +1,50 @@
+// Copyright (c) 2016 Settlers Freaks (sf-team at siedler25.org)
+//
+// This file is part of Return To The Roots.
+//
+// Return To The Roots is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 2 of the License, or
+// (at your option) any later version.
+//
+// Return To The Roots is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Return To The Roots. If not, see <http://www.gnu.org/licenses/>.
+
+#include "defines.h" // IWYU pragma: keep
+#include "helpers/ParallelFor.h"
+#include <boost/test/unit_test.hpp>
+#include <vector>
+
+BOOST_AUTO_TEST_SUITE(ParallelForSuite)
+
+namespace {
+struct SquareValues
+{
+    std::vector<unsigned>& values;
+    SquareValues(std::vector<unsigned>& values) : values(values) {}
+    void operator()(unsigned idx) { values[idx] = idx * idx + values[idx]; }
+};
+} // namespace
+
+BOOST_AUTO_TEST_CASE(ParallelForProcessesEachItemOnce)
+{
+    for(unsigned numThreads = 1; numThreads <= 4; numThreads++)
+    {
+        std::vector<unsigned> values(1000, 1);
+        SquareValues func(values);
+        helpers::parallelFor(values.size(), func, numThreads);
+        for(unsigned i = 0; i < values.size(); i++)
+            BOOST_REQUIRE_EQUAL(values[i], i * i + 1);
+    }
+    // Nothing to do
+    std::vector<unsigned> values;
+    SquareValues func(values);
+    helpers::parallelFor(0, func);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
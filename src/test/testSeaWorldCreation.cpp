@@ -17,6 +17,7 @@
 
 #include "defines.h" // IWYU pragma: keep
 #include "SeaWorldWithGCExecution.h"
+#include "world/MapLoader.h"
 #include "commonSrc/RTTR_AssertError.h"
 #include <boost/test/unit_test.hpp>
 
@@ -199,4 +200,44 @@ BOOST_FIXTURE_TEST_CASE(HarborNeighbors, SeaWorldWithGCExecution<>)
     BOOST_REQUIRE_EQUAL(world.GetHarborNeighbors(7, ShipDirection::SOUTHWEST).size(), 0u);
 }
 
+namespace {
+/// Gives the tests access to the internal calculations of the loader
+class TestMapLoader : public MapLoader
+{
+public:
+    using MapLoader::CalcHarborPosNeighbors;
+};
+} // namespace
+
+BOOST_FIXTURE_TEST_CASE(HarborNeighborsIndependentOfThreads, SeaWorldWithGCExecution<>)
+{
+    TestMapLoader::CalcHarborPosNeighbors(world, 1);
+    std::vector<std::vector<HarborPos::Neighbor> > expectedNeighbors;
+    for(unsigned hbId = 1; hbId <= world.GetHarborPointCount(); hbId++)
+    {
+        for(int dir = 0; dir < ShipDirection::COUNT; dir++)
+            expectedNeighbors.push_back(world.GetHarborNeighbors(hbId, ShipDirection(static_cast<unsigned>(dir))));
+    }
+
+    TestMapLoader::CalcHarborPosNeighbors(world);
+
+    std::vector<std::vector<HarborPos::Neighbor> >::const_iterator itExpected = expectedNeighbors.begin();
+    for(unsigned hbId = 1; hbId <= world.GetHarborPointCount(); hbId++)
+    {
+        for(int dir = 0; dir < ShipDirection::COUNT; dir++, ++itExpected)
+        {
+            const std::vector<HarborPos::Neighbor>& nb = world.GetHarborNeighbors(hbId, ShipDirection(static_cast<unsigned>(dir)));
+            BOOST_REQUIRE_EQUAL(nb.size(), itExpected->size());
+            for(unsigned i = 0; i < nb.size(); i++)
+            {
+                BOOST_REQUIRE_EQUAL(nb[i].id, (*itExpected)[i].id);
+                BOOST_REQUIRE_EQUAL(nb[i].distance, (*itExpected)[i].distance);
+            }
+        }
+    }
+    // Still the expected neighbors
+    BOOST_REQUIRE_EQUAL(world.GetHarborNeighbors(1, ShipDirection::NORTH).size(), 1u);
+    BOOST_REQUIRE_EQUAL(world.GetHarborNeighbors(1, ShipDirection::NORTH)[0].id, 8u);
+}
+
 BOOST_AUTO_TEST_SUITE_END()
@@ -29,6 +29,7 @@
 #include "nodeObjs/noShip.h"
 #include "test/initTestHelpers.h"
 #include <boost/test/unit_test.hpp>
+#include <algorithm>
 #include <iostream>
 
 namespace {
@@ -509,4 +510,49 @@ BOOST_FIXTURE_TEST_CASE(LongDistanceTravel, ShipReadyFixtureBig)
     BOOST_REQUIRE_EQUAL(ship->GetTargetHarbor(), targetHbId);
 }
 
+BOOST_FIXTURE_TEST_CASE(ShipPathToHarborMatchesPathfinder, SeaWorldWithGCExecution<>)
+{
+    unsigned numRoutes = 0;
+    for(unsigned hbId = 1; hbId <= world.GetHarborPointCount(); hbId++)
+    {
+        for(unsigned iDir = 0; iDir < Direction::COUNT; iDir++)
+        {
+            const unsigned short seaId = world.GetSeaId(hbId, Direction::fromInt(iDir));
+            if(!seaId)
+                continue;
+            const MapPoint coastPt = world.GetCoastalPoint(hbId, seaId);
+            // Same limit as used by FindShipPathToHarbor
+            unsigned maxDistance = 0;
+            for(int dir = 0; dir < ShipDirection::COUNT; dir++)
+            {
+                const std::vector<HarborPos::Neighbor>& neighbors = world.GetHarborNeighbors(hbId, ShipDirection::fromInt(dir));
+                for(unsigned i = 0; i < neighbors.size(); i++)
+                {
+                    if(world.IsHarborAtSea(neighbors[i].id, seaId))
+                        maxDistance = std::max(maxDistance, neighbors[i].distance);
+                }
+            }
+            maxDistance += 6;
+            RTTR_FOREACH_PT(MapPoint, world.GetSize())
+            {
+                if(pt == coastPt || (pt.x + pt.y) % 3 != 0 || !world.IsSeaPoint(pt))
+                    continue;
+                std::vector<Direction> expectedRoute, route;
+                unsigned expectedLength, length;
+                const bool expectedFound = world.FindShipPath(pt, coastPt, maxDistance, &expectedRoute, &expectedLength);
+                BOOST_REQUIRE_EQUAL(world.FindShipPathToHarbor(pt, hbId, seaId, &route, &length), expectedFound);
+                if(!expectedFound)
+                    continue;
+                BOOST_REQUIRE_EQUAL(length, expectedLength);
+                BOOST_REQUIRE_EQUAL(route.size(), length);
+                MapPoint endPt;
+                BOOST_REQUIRE(world.CheckShipRoute(pt, route, 0, &endPt));
+                BOOST_REQUIRE_EQUAL(endPt, coastPt);
+                numRoutes++;
+            }
+        }
+    }
+    BOOST_REQUIRE_GT(numRoutes, 0u);
+}
+
 BOOST_AUTO_TEST_SUITE_END()
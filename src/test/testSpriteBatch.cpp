@@ -0,0 +1,123 @@
+// Copyright (c) 2016 Settlers Freaks (sf-team at siedler25.org)
+//
+// This file is part of Return To The Roots.
+//
+// Return To The Roots is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 2 of the License, or
+// (at your option) any later version.
+//
+// Return To The Roots is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Return To The Roots. If not, see <http://www.gnu.org/licenses/>.
+
+#include "defines.h" // IWYU pragma: keep
+#include "Loader.h"
+#include "ogl/glArchivItem_Font.h"
+#include "ogl/glSpriteBatch.h"
+#include "test/initTestHelpers.h"
+#include "libutil/src/colors.h"
+#include <boost/test/unit_test.hpp>
+
+BOOST_AUTO_TEST_SUITE(SpriteBatchSuite)
+
+namespace {
+struct SpriteBatchFixture
+{
+    Point<float> vertices[8], texCoords[8];
+    SpriteBatchFixture()
+    {
+        GetVideoDriver();
+        SPRITEBATCH.ResetCounters();
+        for(unsigned i = 0; i < 8; i++)
+        {
+            vertices[i] = Point<float>(static_cast<float>(i), static_cast<float>(i % 4));
+            texCoords[i] = Point<float>(0.f, 1.f);
+        }
+    }
+    ~SpriteBatchFixture() { SPRITEBATCH.ResetCounters(); }
+    void AddSprite(unsigned texture, unsigned numVertices = 4) { SPRITEBATCH.Add(texture, vertices, texCoords, COLOR_WHITE, numVertices); }
+};
+} // namespace
+
+BOOST_FIXTURE_TEST_CASE(UnbatchedSpritesAreDrawnImmediately, SpriteBatchFixture)
+{
+    BOOST_REQUIRE(!SPRITEBATCH.IsActive());
+    AddSprite(1);
+    AddSprite(1);
+    BOOST_REQUIRE_EQUAL(SPRITEBATCH.GetNumSprites(), 2u);
+    BOOST_REQUIRE_EQUAL(SPRITEBATCH.GetNumBatches(), 2u);
+    BOOST_REQUIRE_EQUAL(SPRITEBATCH.GetNumDrawCalls(), 2u);
+}
+
+BOOST_FIXTURE_TEST_CASE(SpritesAreBatchedByTexture, SpriteBatchFixture)
+{
+    SPRITEBATCH.Begin();
+    BOOST_REQUIRE(SPRITEBATCH.IsActive());
+    AddSprite(1);
+    AddSprite(1);
+    // Player bitmap with 2 quads
+    AddSprite(1, 8);
+    AddSprite(2);
+    AddSprite(2);
+    // Same texture again must not be merged with the first ones as the order matters
+    AddSprite(1);
+    BOOST_REQUIRE_EQUAL(SPRITEBATCH.GetNumSprites(), 7u);
+    // Nothing drawn yet
+    BOOST_REQUIRE_EQUAL(SPRITEBATCH.GetNumDrawCalls(), 0u);
+    SPRITEBATCH.End();
+    BOOST_REQUIRE(!SPRITEBATCH.IsActive());
+    BOOST_REQUIRE_EQUAL(SPRITEBATCH.GetNumBatches(), 1u);
+    BOOST_REQUIRE_EQUAL(SPRITEBATCH.GetNumDrawCalls(), 3u);
+
+    // Flushing in between (e.g. drawing text) splits the batch
+    SPRITEBATCH.ResetCounters();
+    SPRITEBATCH.Begin();
+    AddSprite(1);
+    SPRITEBATCH.Flush();
+    BOOST_REQUIRE_EQUAL(SPRITEBATCH.GetNumDrawCalls(), 1u);
+    AddSprite(1);
+    // Flushing without anything to draw does nothing
+    SPRITEBATCH.Flush();
+    SPRITEBATCH.Flush();
+    SPRITEBATCH.End();
+    BOOST_REQUIRE_EQUAL(SPRITEBATCH.GetNumSprites(), 2u);
+    BOOST_REQUIRE_EQUAL(SPRITEBATCH.GetNumBatches(), 2u);
+    BOOST_REQUIRE_EQUAL(SPRITEBATCH.GetNumDrawCalls(), 2u);
+}
+
+BOOST_FIXTURE_TEST_CASE(TextsAreBatched, SpriteBatchFixture)
+{
+    glArchivItem_Font& font = *NormalFont;
+    SPRITEBATCH.Begin();
+    font.Draw(DrawPoint(10, 10), "Hello", 0);
+    font.Draw(DrawPoint(10, 30), "World!", glArchivItem_Font::DF_CENTER, COLOR_RED);
+    // Cached glyphs are moved to the new position
+    font.Draw(DrawPoint(50, 30), "Hello", 0);
+    BOOST_REQUIRE_EQUAL(SPRITEBATCH.GetNumDrawCalls(), 0u);
+    SPRITEBATCH.End();
+    BOOST_REQUIRE_EQUAL(SPRITEBATCH.GetNumSprites(), 5u + 6u + 5u);
+    BOOST_REQUIRE_EQUAL(SPRITEBATCH.GetNumDrawCalls(), 1u);
+
+    // Different font texture (no outline) requires another draw call
+    SPRITEBATCH.ResetCounters();
+    SPRITEBATCH.Begin();
+    font.Draw(DrawPoint(10, 10), "Hello", 0);
+    font.Draw(DrawPoint(10, 10), "Hello", glArchivItem_Font::DF_NO_OUTLINE);
+    SPRITEBATCH.End();
+    BOOST_REQUIRE_EQUAL(SPRITEBATCH.GetNumSprites(), 10u);
+    BOOST_REQUIRE_EQUAL(SPRITEBATCH.GetNumDrawCalls(), 2u);
+
+    // Cached wrap infos are the same as new ones
+    const std::string text = "A longer text that needs to be wrapped into multiple lines";
+    const std::vector<unsigned> positions = font.GetWrapInfo(text, 100, 80).positions;
+    BOOST_REQUIRE_GT(positions.size(), 1u);
+    BOOST_REQUIRE(font.GetWrapInfo(text, 100, 80).positions == positions);
+    BOOST_REQUIRE(font.GetWrapInfo(text, 200, 200).positions.size() < positions.size());
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,167 @@
+// Copyright (c) 2016 Settlers Freaks (sf-team at siedler25.org)
+//
+// This file is part of Return To The Roots.
+//
+// Return To The Roots is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 2 of the License, or
+// (at your option) any later version.
+//
+// Return To The Roots is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Return To The Roots. If not, see <http://www.gnu.org/licenses/>.
+
+#include "defines.h" // IWYU pragma: keep
+#include "StatisticHistory.h"
+#include "libutil/src/Serializer.h"
+#include <boost/test/unit_test.hpp>
+#include <sstream>
+#include <string>
+
+BOOST_AUTO_TEST_SUITE(StatisticHistorySuite)
+
+namespace {
+/// Values of the step: Some slowly growing, one jumping between positive and negative and one large value
+void GetValues(unsigned step, StatisticHistory::Values& values, StatisticHistory::MerchandiseValues& merchandise)
+{
+    for(unsigned i = 0; i < values.size(); i++)
+        values[i] = static_cast<int>(step * i);
+    values[STAT_PRODUCTIVITY] = (step % 2) ? -static_cast<int>(step) : static_cast<int>(step);
+    values[STAT_COUNTRY] = 0x7FFFFFFF - static_cast<int>(step);
+    for(unsigned i = 0; i < merchandise.size(); i++)
+        merchandise[i] = static_cast<int>((step + i) % 5);
+}
+
+/// Check that the tier contains the expected values for the steps
+boost::test_tools::predicate_result checkTier(const StatisticHistory& history, unsigned tier)
+{
+    const unsigned stepsPerEntry = StatisticHistory::GetStepsPerEntry(tier);
+    const unsigned firstStep = history.GetFirstStep(tier);
+    for(unsigned c = 0; c < StatisticHistory::NUM_COLUMNS; c++)
+    {
+        const std::vector<int> column = history.GetColumn(tier, c);
+        if(column.size() != history.GetNumEntries(tier))
+            return false;
+        for(unsigned i = 0; i < column.size(); i++)
+        {
+            int expected = 0;
+            for(unsigned step = firstStep + i * stepsPerEntry; step < firstStep + (i + 1) * stepsPerEntry; step++)
+            {
+                StatisticHistory::Values values;
+                StatisticHistory::MerchandiseValues merchandise;
+                GetValues(step, values, merchandise);
+                // Last value of the statistics, sum of the merchandise
+                if(c < STAT_TYPE_COUNT)
+                    expected = values[c];
+                else
+                    expected += merchandise[c - STAT_TYPE_COUNT];
+            }
+            if(column[i] != expected)
+            {
+                boost::test_tools::predicate_result result(false);
+                result.message() << "Tier " << tier << ", column " << c << ", entry " << i << ": " << column[i] << "!=" << expected;
+                return result;
+            }
+        }
+    }
+    return true;
+}
+} // namespace
+
+BOOST_AUTO_TEST_CASE(AddAndReadSteps)
+{
+    StatisticHistory history;
+    for(unsigned t = 0; t < StatisticHistory::NUM_TIERS; t++)
+        BOOST_REQUIRE_EQUAL(history.GetNumEntries(t), 0u);
+
+    StatisticHistory::Values values;
+    StatisticHistory::MerchandiseValues merchandise;
+    for(unsigned step = 0; step < 10; step++)
+    {
+        GetValues(step, values, merchandise);
+        history.AddStep(values, merchandise);
+    }
+    BOOST_REQUIRE_EQUAL(history.GetNumSteps(), 10u);
+    BOOST_REQUIRE_EQUAL(history.GetNumEntries(0), 10u);
+    BOOST_REQUIRE_EQUAL(history.GetNumEntries(1), 10u / StatisticHistory::TIER_FACTOR);
+    BOOST_REQUIRE_EQUAL(history.GetNumEntries(2), 0u);
+    for(unsigned t = 0; t < StatisticHistory::NUM_TIERS; t++)
+        BOOST_REQUIRE(checkTier(history, t));
+
+    std::stringstream csv;
+    history.WriteCSV(csv, 1);
+    std::string line;
+    std::getline(csv, line);
+    BOOST_REQUIRE_EQUAL(line.substr(0, 21), "step,country,building");
+    // Entry of steps 0-3: The last merchandise is the sum of 3,4,0,1
+    std::getline(csv, line);
+    BOOST_REQUIRE_EQUAL(line.substr(0, 2), "3,");
+    BOOST_REQUIRE_EQUAL(line.substr(line.rfind(',')), ",8");
+}
+
+BOOST_AUTO_TEST_CASE(DropOldEntries)
+{
+    StatisticHistory history;
+    StatisticHistory::Values values;
+    StatisticHistory::MerchandiseValues merchandise;
+    const unsigned numSteps = StatisticHistory::TIER_CAPACITY * 10 + 3;
+    for(unsigned step = 0; step < numSteps; step++)
+    {
+        GetValues(step, values, merchandise);
+        history.AddStep(values, merchandise);
+    }
+    // Limited tiers hold the newest steps
+    BOOST_REQUIRE_GE(history.GetNumEntries(0), StatisticHistory::TIER_CAPACITY);
+    BOOST_REQUIRE_LT(history.GetNumEntries(0), StatisticHistory::TIER_CAPACITY * 3 / 2);
+    BOOST_REQUIRE_EQUAL(history.GetFirstStep(0) + history.GetNumEntries(0), numSteps);
+    // Last tier holds the whole game
+    BOOST_REQUIRE_EQUAL(history.GetFirstStep(StatisticHistory::NUM_TIERS - 1), 0u);
+    BOOST_REQUIRE_EQUAL(history.GetNumEntries(StatisticHistory::NUM_TIERS - 1),
+                        numSteps / StatisticHistory::GetStepsPerEntry(StatisticHistory::NUM_TIERS - 1));
+    for(unsigned t = 0; t < StatisticHistory::NUM_TIERS; t++)
+        BOOST_REQUIRE(checkTier(history, t));
+}
+
+BOOST_AUTO_TEST_CASE(SerializeHistory)
+{
+    StatisticHistory history;
+    StatisticHistory::Values values;
+    StatisticHistory::MerchandiseValues merchandise;
+    for(unsigned step = 0; step < 1000; step++)
+    {
+        GetValues(step, values, merchandise);
+        history.AddStep(values, merchandise);
+    }
+    Serializer ser;
+    history.Serialize(ser);
+    // Mostly 1-2 bytes per value
+    BOOST_REQUIRE_LT(ser.GetLength(), 1000u * StatisticHistory::NUM_COLUMNS * 3);
+
+    StatisticHistory history2;
+    history2.Deserialize(ser);
+    BOOST_REQUIRE_EQUAL(history2.GetNumSteps(), history.GetNumSteps());
+    for(unsigned t = 0; t < StatisticHistory::NUM_TIERS; t++)
+    {
+        BOOST_REQUIRE_EQUAL(history2.GetFirstStep(t), history.GetFirstStep(t));
+        BOOST_REQUIRE(checkTier(history2, t));
+    }
+    // Continuing works the same
+    for(unsigned step = 1000; step < 1100; step++)
+    {
+        GetValues(step, values, merchandise);
+        history.AddStep(values, merchandise);
+        history2.AddStep(values, merchandise);
+    }
+    std::stringstream csv, csv2;
+    history.WriteCSV(csv, 2);
+    history2.WriteCSV(csv2, 2);
+    BOOST_REQUIRE_EQUAL(csv.str(), csv2.str());
+    for(unsigned t = 0; t < StatisticHistory::NUM_TIERS; t++)
+        BOOST_REQUIRE(checkTier(history2, t));
+}
+
+BOOST_AUTO_TEST_SUITE_END()
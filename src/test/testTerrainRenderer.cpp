@@ -0,0 +1,132 @@
+// Copyright (c) 2016 Settlers Freaks (sf-team at siedler25.org)
+//
+// This file is part of Return To The Roots.
+//
+// Return To The Roots is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 2 of the License, or
+// (at your option) any later version.
+//
+// Return To The Roots is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Return To The Roots. If not, see <http://www.gnu.org/licenses/>.
+
+#include "defines.h" // IWYU pragma: keep
+#include "GamePlayer.h"
+#include "TerrainRenderer.h"
+#include "world/GameWorldViewer.h"
+#include "test/CreateEmptyWorld.h"
+#include "test/WorldFixture.h"
+#include "test/initTestHelpers.h"
+#include <boost/test/unit_test.hpp>
+#include <ctime>
+
+BOOST_AUTO_TEST_SUITE(TerrainRendererSuite)
+
+namespace {
+typedef WorldFixture<CreateEmptyWorld, 1, 64, 64> EmptyWorldFixture1P;
+typedef Point<int> PointI;
+
+struct TerrainFixture : public EmptyWorldFixture1P
+{
+    GameWorldViewer gwv;
+    TerrainFixture() : gwv(0, world)
+    {
+        // Texture coordinates depend on the video driver
+        GetVideoDriver();
+        gwv.InitTerrainRenderer();
+    }
+};
+} // namespace
+
+BOOST_FIXTURE_TEST_CASE(DrawBatchesAreCached, TerrainFixture)
+{
+    const TerrainRenderer& tr = gwv.GetTerrainRenderer();
+    const PointI hqPos(world.GetPlayer(0).GetHQPos());
+    const PointI firstPt = hqPos - PointI(10, 10);
+    const PointI lastPt = hqPos + PointI(10, 10);
+    tr.PrepareDraw(firstPt, lastPt, gwv);
+    const unsigned numBatches = tr.GetNumPreparedBatches();
+    BOOST_REQUIRE_GT(numBatches, 0u);
+    BOOST_REQUIRE_EQUAL(tr.GetNumPreparedRoads(), 0u);
+
+    // Road changes in the area are taken over
+    gwv.SetVisiblePointRoad(world.GetPlayer(0).GetHQPos(), Direction::EAST, 1);
+    tr.PrepareDraw(firstPt, lastPt, gwv);
+    BOOST_REQUIRE_EQUAL(tr.GetNumPreparedBatches(), numBatches);
+    BOOST_REQUIRE_EQUAL(tr.GetNumPreparedRoads(), 1u);
+    gwv.SetVisiblePointRoad(world.GetPlayer(0).GetHQPos(), Direction::EAST, 0);
+    tr.PrepareDraw(firstPt, lastPt, gwv);
+    BOOST_REQUIRE_EQUAL(tr.GetNumPreparedRoads(), 0u);
+
+    // Moving the view across the map border gives the same area of the map
+    const PointI shift(world.GetWidth(), world.GetHeight());
+    tr.PrepareDraw(firstPt + shift, lastPt + shift, gwv);
+    BOOST_REQUIRE_EQUAL(tr.GetNumPreparedBatches(), numBatches);
+}
+
+BOOST_FIXTURE_TEST_CASE(ChunksAreCulled, TerrainFixture)
+{
+    const TerrainRenderer& tr = gwv.GetTerrainRenderer();
+    // Whole map: 2x2 chunks with only meadow
+    tr.PrepareDraw(PointI(0, 0), PointI(world.GetWidth() - 1, world.GetHeight() - 1), gwv);
+    BOOST_REQUIRE_EQUAL(tr.GetNumPreparedBatches(), 4u);
+    // Area inside one chunk
+    tr.PrepareDraw(PointI(2, 2), PointI(10, 10), gwv);
+    BOOST_REQUIRE_EQUAL(tr.GetNumPreparedBatches(), 1u);
+    // Area around the map corner: The corner chunk of each of the 4 copies of the map
+    tr.PrepareDraw(PointI(-5, -5), PointI(5, 5), gwv);
+    BOOST_REQUIRE_EQUAL(tr.GetNumPreparedBatches(), 4u);
+
+    // Add some water: Chunks get a batch per texture and border type, independent of the number of rows
+    RTTR_FOREACH_PT(MapPoint, world.GetSize())
+    {
+        if(pt.x % 4 == 0)
+        {
+            MapNode& node = world.GetNodeWriteable(pt);
+            node.t1 = node.t2 = TT_WATER;
+        }
+    }
+    gwv.InitTerrainRenderer();
+    tr.PrepareDraw(PointI(0, 0), PointI(world.GetWidth() - 1, world.GetHeight() - 1), gwv);
+    const unsigned numBatches = tr.GetNumPreparedBatches();
+    BOOST_REQUIRE_GE(numBatches, 8u);
+    BOOST_REQUIRE_LE(numBatches, 4u * 7u);
+}
+
+// Only a timing, not a check. Define RTTR_BENCHMARKS to build it
+#ifdef RTTR_BENCHMARKS
+BOOST_FIXTURE_TEST_CASE(DrawBatchesBenchmark, TerrainFixture)
+{
+    const TerrainRenderer& tr = gwv.GetTerrainRenderer();
+    // About the size of a big screen
+    const PointI firstPt(-2, -2);
+    const PointI lastPt(60, 60);
+    const unsigned numFrames = 200;
+
+    // Moving view: Batches are rebuild every frame
+    std::clock_t start = std::clock();
+    for(unsigned i = 0; i < numFrames; i++)
+    {
+        const PointI offset(i % 2, 0);
+        tr.PrepareDraw(firstPt + offset, lastPt + offset, gwv);
+    }
+    const std::clock_t movingTime = std::clock() - start;
+
+    // Still view: Batches are reused
+    start = std::clock();
+    for(unsigned i = 0; i < numFrames; i++)
+        tr.PrepareDraw(firstPt, lastPt, gwv);
+    const std::clock_t stillTime = std::clock() - start;
+
+    BOOST_TEST_MESSAGE("Preparing " << numFrames << " frames: " << movingTime << " ticks with a moving view, " << stillTime
+                                    << " ticks with a still view");
+    BOOST_REQUIRE_GT(tr.GetNumPreparedBatches(), 0u);
+}
+#endif // RTTR_BENCHMARKS
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -16,9 +16,15 @@
 // along with Return To The Roots. If not, see <http://www.gnu.org/licenses/>.
 
 #include "defines.h" // IWYU pragma: keep
+#include "GamePlayer.h"
+#include "buildings/nobMilitary.h"
+#include "factories/BuildingFactory.h"
+#include "figures/nofPassiveSoldier.h"
 #include "world/TerritoryRegion.h"
 #include "test/CreateEmptyWorld.h"
 #include "test/WorldFixture.h"
+#include "test/WorldWithGCExecution.h"
+#include <boost/array.hpp>
 #include <boost/assign/std/set.hpp>
 #include <boost/assign/std/vector.hpp>
 #include <boost/bind.hpp>
@@ -30,6 +36,7 @@
 #include <vector>
 
 typedef WorldFixture<CreateEmptyWorld, 0, 32, 32> EmptyWorldFixture0P;
+typedef WorldFixture<CreateEmptyWorld, 1, 64, 64> EmptyWorldFixture1P;
 
 using namespace boost::assign;
 
@@ -225,4 +232,90 @@ BOOST_FIXTURE_TEST_CASE(IsPointValid, EmptyWorldFixture0P)
     }
 }
 
+namespace {
+/// Return the number of nodes whose stored boundary stones differ from the ones calculated from the ownership
+unsigned GetNumOutdatedBoundaryStones(const GameWorldGame& world)
+{
+    unsigned result = 0;
+    RTTR_FOREACH_PT(MapPoint, world.GetSize())
+    {
+        if(world.GetNode(pt).boundary_stones != world.CalcBoundaryStones(pt))
+            ++result;
+    }
+    return result;
+}
+} // namespace
+
+BOOST_FIXTURE_TEST_CASE(BatchedTerritoryChanges, WorldWithGCExecution2P)
+{
+    BOOST_REQUIRE_EQUAL(GetNumOutdatedBoundaryStones(world), 0u);
+
+    // Military buildings of both players facing each other with overlapping regions
+    boost::array<MapPoint, 2> bldPos;
+    bldPos[0] = world.GetPlayer(0).GetHQPos() + MapPoint(0, 6);
+    bldPos[1] = world.GetPlayer(1).GetHQPos() - MapPoint(0, 6);
+    boost::array<nobMilitary*, 2> blds;
+    for(unsigned i = 0; i < 2; i++)
+    {
+        BOOST_REQUIRE_EQUAL(world.GetBQ(bldPos[i], i), BQ_CASTLE);
+        blds[i] = dynamic_cast<nobMilitary*>(BuildingFactory::CreateBuilding(world, BLD_WATCHTOWER, bldPos[i], i, NAT_ROMANS));
+        BOOST_REQUIRE(blds[i]);
+    }
+
+    world.BeginTerritoryBatch();
+    for(unsigned i = 0; i < 2; i++)
+    {
+        // Occupying the building triggers the territory change
+        nofPassiveSoldier* soldier = new nofPassiveSoldier(bldPos[i], i, blds[i], blds[i], 0);
+        world.GetPlayer(i).IncreaseInventoryJob(soldier->GetJobType(), 1);
+        world.AddFigure(soldier, bldPos[i]);
+        soldier->WalkToGoal();
+        BOOST_REQUIRE(!blds[i]->IsNewBuilt());
+    }
+    // Ownership is already updated, border stones are not
+    BOOST_REQUIRE_GT(GetNumOutdatedBoundaryStones(world), 0u);
+    RTTR_FOREACH_PT(MapPoint, world.GetSize())
+    {
+        BOOST_REQUIRE_EQUAL(world.HasBorderStone(pt), world.CalcBoundaryStones(pt)[0] != 0);
+    }
+    world.EndTerritoryBatch();
+    // Now we have the same stones as if they were updated after each change
+    BOOST_REQUIRE_EQUAL(GetNumOutdatedBoundaryStones(world), 0u);
+}
+
+BOOST_FIXTURE_TEST_CASE(TerritoryOfBuilding, EmptyWorldFixture1P)
+{
+    // Biggest regions: HQ and fortress
+    const MapPoint hqPos = world.GetPlayer(0).GetHQPos();
+    const MapPoint fortressPos = hqPos + MapPoint(0, 6);
+    BOOST_REQUIRE_EQUAL(world.GetBQ(fortressPos, 0), BQ_CASTLE);
+    std::vector<const nobBaseMilitary*> blds;
+    blds.push_back(world.GetSpecObj<nobBaseMilitary>(hqPos));
+    blds.push_back(dynamic_cast<nobMilitary*>(BuildingFactory::CreateBuilding(world, BLD_FORTRESS, fortressPos, 0, NAT_ROMANS)));
+    BOOST_FOREACH(const nobBaseMilitary* bld, blds)
+    {
+        BOOST_REQUIRE(bld);
+        const Point<int> bldPos(bld->GetPos());
+        const int radius = bld->GetMilitaryRadius();
+        // Include some points outside the radius
+        const Point<int> startPt = bldPos - Point<int>::all(radius + 2);
+        const Point<int> endPt = bldPos + Point<int>::all(radius + 3);
+        TerritoryRegion region(startPt, endPt, world);
+        region.CalcTerritoryOfBuilding(*bld);
+        for(Point<int> pt(startPt); pt.y < endPt.y; ++pt.y)
+        {
+            for(pt.x = startPt.x; pt.x < endPt.x; ++pt.x)
+            {
+                const unsigned distance = world.CalcDistance(pt, bldPos);
+                if(distance <= static_cast<unsigned>(radius))
+                {
+                    BOOST_REQUIRE_EQUAL(region.GetOwner(pt), 1u);
+                    BOOST_REQUIRE_EQUAL(region.GetRadius(pt), distance);
+                } else
+                    BOOST_REQUIRE_EQUAL(region.GetOwner(pt), 0u);
+            }
+        }
+    }
+}
+
 BOOST_AUTO_TEST_SUITE_END()
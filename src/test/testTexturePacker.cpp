@@ -0,0 +1,246 @@
+// Copyright (c) 2016 Settlers Freaks (sf-team at siedler25.org)
+//
+// This file is part of Return To The Roots.
+//
+// Return To The Roots is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 2 of the License, or
+// (at your option) any later version.
+//
+// Return To The Roots is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Return To The Roots. If not, see <http://www.gnu.org/licenses/>.
+
+#include "defines.h" // IWYU pragma: keep
+#include "Loader.h"
+#include "Rect.h"
+#include "drivers/VideoDriverWrapper.h"
+#include "ogl/glArchivItem_Bitmap_Player.h"
+#include "ogl/glArchivItem_Bitmap_Raw.h"
+#include "ogl/glTexturePacker.h"
+#include "test/PointOutput.h"
+#include "test/initTestHelpers.h"
+#include "libutil/src/colors.h"
+#include <boost/filesystem.hpp>
+#include <boost/ptr_container/ptr_vector.hpp>
+#include <boost/test/unit_test.hpp>
+
+BOOST_AUTO_TEST_SUITE(TexturePackerSuite)
+
+namespace {
+struct BitmapsFixture
+{
+    boost::ptr_vector<glArchivItem_BitmapBase> bmps;
+    BitmapsFixture() { GetVideoDriver(); }
+
+    glArchivItem_BitmapBase& AddBitmap(const Extent& size, bool isPlayer = false)
+    {
+        const std::vector<uint32_t> buffer(size.x * size.y, SetAlpha(0, 255));
+        const unsigned char* data = reinterpret_cast<const unsigned char*>(&buffer.front());
+        if(isPlayer)
+        {
+            glArchivItem_Bitmap_Player* bmp = new glArchivItem_Bitmap_Player();
+            bmp->create(size.x, size.y, data, size.x, size.y, libsiedler2::FORMAT_BGRA, LOADER.GetPaletteN("colors"), 128);
+            bmps.push_back(bmp);
+        } else
+        {
+            glArchivItem_Bitmap_Raw* bmp = new glArchivItem_Bitmap_Raw();
+            bmp->create(size.x, size.y, data, size.x, size.y, libsiedler2::FORMAT_BGRA, LOADER.GetPaletteN("pal5"));
+            bmps.push_back(bmp);
+        }
+        return bmps.back();
+    }
+
+    /// Check that the packed bitmaps are inside their textures and do not overlap
+    boost::test_tools::predicate_result CheckPacked(unsigned maxTexSize)
+    {
+        for(unsigned i = 0; i < bmps.size(); i++)
+        {
+            const Rect rect(Position(bmps[i].GetTexOrigin()), bmps[i].GetPackedSize());
+            const Extent texSize = bmps[i].GetTexSize();
+            if(texSize.x > maxTexSize || texSize.y > maxTexSize || static_cast<unsigned>(rect.right) > texSize.x
+               || static_cast<unsigned>(rect.bottom) > texSize.y)
+            {
+                boost::test_tools::predicate_result result(false);
+                result.message() << "Bitmap " << i << " is outside of its texture";
+                return result;
+            }
+            for(unsigned j = 0; j < i; j++)
+            {
+                if(bmps[i].GetTexture() != bmps[j].GetTexture())
+                    continue;
+                const Rect otherRect(Position(bmps[j].GetTexOrigin()), bmps[j].GetPackedSize());
+                if(rect.left < otherRect.right && otherRect.left < rect.right && rect.top < otherRect.bottom && otherRect.top < rect.bottom)
+                {
+                    boost::test_tools::predicate_result result(false);
+                    result.message() << "Bitmaps " << j << " and " << i << " overlap";
+                    return result;
+                }
+            }
+        }
+        return true;
+    }
+};
+} // namespace
+
+BOOST_FIXTURE_TEST_CASE(BitmapsArePacked, BitmapsFixture)
+{
+    for(unsigned i = 1; i <= 20; i++)
+        AddBitmap(Extent(i * 3, 50 - i * 2));
+    AddBitmap(Extent(10, 12), true);
+    AddBitmap(Extent(7, 30), true);
+
+    {
+        glTexturePacker packer;
+        packer.setMaxTextureSize(1024);
+        for(unsigned i = 0; i < bmps.size(); i++)
+            packer.add(bmps[i]);
+        // Too big for packing
+        glArchivItem_BitmapBase& bigBmp = AddBitmap(Extent(600, 10));
+        packer.add(bigBmp);
+
+        BOOST_REQUIRE(packer.pack());
+        BOOST_REQUIRE_EQUAL(packer.getNumPacked(), bmps.size() - 1u);
+        BOOST_REQUIRE_EQUAL(packer.getNumTextures(), 1u);
+        BOOST_REQUIRE_GT(packer.getEfficiency(), 0.25f);
+        BOOST_REQUIRE_LE(packer.getEfficiency(), 1.f);
+        const unsigned sharedTexture = bmps[0].GetTexture();
+        BOOST_REQUIRE_NE(sharedTexture, 0u);
+        for(unsigned i = 0; i + 1 < bmps.size(); i++)
+            BOOST_REQUIRE_EQUAL(bmps[i].GetTexture(), sharedTexture);
+        // The big bitmap uses its own texture
+        BOOST_REQUIRE_NE(bigBmp.GetTexture(), sharedTexture);
+        BOOST_REQUIRE_EQUAL(bigBmp.GetTexOrigin(), Extent(0, 0));
+        bmps.pop_back();
+        BOOST_REQUIRE(CheckPacked(1024));
+
+        // Resetting makes the bitmaps create their own textures again
+        bmps[0].SetSharedTexture(0, Extent(0, 0), Extent(0, 0));
+        BOOST_REQUIRE_NE(bmps[0].GetTexture(), sharedTexture);
+        BOOST_REQUIRE_EQUAL(bmps[0].GetTexOrigin(), Extent(0, 0));
+        BOOST_REQUIRE_EQUAL(bmps[0].GetTexSize(), VIDEODRIVER.calcPreferredTextureSize(bmps[0].GetSize()));
+    }
+}
+
+BOOST_FIXTURE_TEST_CASE(SmallMaxTextureSize, BitmapsFixture)
+{
+    for(unsigned i = 1; i <= 30; i++)
+        AddBitmap(Extent(i % 7 + 10, i % 5 + 12));
+    glTexturePacker packer;
+    packer.setMaxTextureSize(64);
+    for(unsigned i = 0; i < bmps.size(); i++)
+        packer.add(bmps[i]);
+    BOOST_REQUIRE(packer.pack());
+    BOOST_REQUIRE_EQUAL(packer.getNumPacked(), bmps.size());
+    // Does not fit into 1 texture
+    BOOST_REQUIRE_GT(packer.getNumTextures(), 1u);
+    BOOST_REQUIRE(CheckPacked(64));
+}
+
+BOOST_FIXTURE_TEST_CASE(PackedTexturesAreCached, BitmapsFixture)
+{
+    for(unsigned i = 1; i <= 20; i++)
+        AddBitmap(Extent(i % 6 + 5, i % 4 + 20), i % 3 == 0);
+    const std::string cacheFile = (bfs::temp_directory_path() / bfs::unique_path("rttrTexCache-%%%%-%%%%.cache")).string();
+    std::vector<Extent> origins;
+    unsigned numTextures;
+    {
+        glTexturePacker packer;
+        packer.setMaxTextureSize(64);
+        packer.setCacheFile(cacheFile, 42);
+        for(unsigned i = 0; i < bmps.size(); i++)
+            packer.add(bmps[i]);
+        BOOST_REQUIRE(packer.pack());
+        BOOST_REQUIRE(!packer.loadedFromCache());
+        BOOST_REQUIRE(bfs::exists(cacheFile));
+        numTextures = packer.getNumTextures();
+        for(unsigned i = 0; i < bmps.size(); i++)
+        {
+            origins.push_back(bmps[i].GetTexOrigin());
+            bmps[i].SetSharedTexture(0, Extent(0, 0), Extent(0, 0));
+        }
+    }
+    // Same key and images -> Use the cache
+    {
+        glTexturePacker packer;
+        packer.setMaxTextureSize(64);
+        packer.setCacheFile(cacheFile, 42);
+        for(unsigned i = 0; i < bmps.size(); i++)
+            packer.add(bmps[i]);
+        BOOST_REQUIRE(packer.pack());
+        BOOST_REQUIRE(packer.loadedFromCache());
+        BOOST_REQUIRE_EQUAL(packer.getNumTextures(), numTextures);
+        BOOST_REQUIRE_EQUAL(packer.getNumPacked(), bmps.size());
+        for(unsigned i = 0; i < bmps.size(); i++)
+            BOOST_REQUIRE_EQUAL(bmps[i].GetTexOrigin(), origins[i]);
+        BOOST_REQUIRE(CheckPacked(64));
+        for(unsigned i = 0; i < bmps.size(); i++)
+            bmps[i].SetSharedTexture(0, Extent(0, 0), Extent(0, 0));
+    }
+    // Changed key -> Pack again
+    {
+        glTexturePacker packer;
+        packer.setMaxTextureSize(64);
+        packer.setCacheFile(cacheFile, 43);
+        for(unsigned i = 0; i < bmps.size(); i++)
+            packer.add(bmps[i]);
+        BOOST_REQUIRE(packer.pack());
+        BOOST_REQUIRE(!packer.loadedFromCache());
+        BOOST_REQUIRE(CheckPacked(64));
+        for(unsigned i = 0; i < bmps.size(); i++)
+            bmps[i].SetSharedTexture(0, Extent(0, 0), Extent(0, 0));
+    }
+    // Changed images -> Pack again
+    AddBitmap(Extent(8, 9));
+    {
+        glTexturePacker packer;
+        packer.setMaxTextureSize(64);
+        packer.setCacheFile(cacheFile, 43);
+        for(unsigned i = 0; i < bmps.size(); i++)
+            packer.add(bmps[i]);
+        BOOST_REQUIRE(packer.pack());
+        BOOST_REQUIRE(!packer.loadedFromCache());
+        BOOST_REQUIRE_EQUAL(packer.getNumPacked(), bmps.size());
+        BOOST_REQUIRE(CheckPacked(64));
+        for(unsigned i = 0; i < bmps.size(); i++)
+            bmps[i].SetSharedTexture(0, Extent(0, 0), Extent(0, 0));
+    }
+    // Corrupt counts (numTextures of the header) -> Pack again
+    {
+        {
+            bfs::fstream file(cacheFile, std::ios::binary | std::ios::in | std::ios::out);
+            file.seekp(28);
+            const uint32_t numTextures = 0xFFFFFFFF;
+            file.write(reinterpret_cast<const char*>(&numTextures), sizeof(numTextures));
+        }
+        glTexturePacker packer;
+        packer.setMaxTextureSize(64);
+        packer.setCacheFile(cacheFile, 43);
+        for(unsigned i = 0; i < bmps.size(); i++)
+            packer.add(bmps[i]);
+        BOOST_REQUIRE(packer.pack());
+        BOOST_REQUIRE(!packer.loadedFromCache());
+        BOOST_REQUIRE(CheckPacked(64));
+        for(unsigned i = 0; i < bmps.size(); i++)
+            bmps[i].SetSharedTexture(0, Extent(0, 0), Extent(0, 0));
+    }
+    // Truncated texture data -> Pack again
+    {
+        bfs::resize_file(cacheFile, bfs::file_size(cacheFile) - 4);
+        glTexturePacker packer;
+        packer.setMaxTextureSize(64);
+        packer.setCacheFile(cacheFile, 43);
+        for(unsigned i = 0; i < bmps.size(); i++)
+            packer.add(bmps[i]);
+        BOOST_REQUIRE(packer.pack());
+        BOOST_REQUIRE(!packer.loadedFromCache());
+        BOOST_REQUIRE(CheckPacked(64));
+    }
+    bfs::remove(cacheFile);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
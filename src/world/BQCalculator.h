@@ -17,33 +17,32 @@
 
 #include "World.h"
 #include "gameData/TerrainData.h"
+#include <vector>
 
 #ifndef BQCalculator_h__
 #define BQCalculator_h__
 
 struct BQCalculator
 {
-    BQCalculator(const World& world) : world(world) {}
+    BQCalculator(const World& world) : world(world), terrainBQs(NULL) {}
+    /// Use the precomputed terrain BQs (see CalcTerrainBQ) of all nodes instead of checking the terrain around each point
+    BQCalculator(const World& world, const std::vector<BuildingQuality>& terrainBQs) : world(world), terrainBQs(&terrainBQs) {}
 
     typedef BuildingQuality result_type;
 
     template<typename T_IsOnRoad>
     inline BuildingQuality operator()(const MapPoint pt, T_IsOnRoad isOnRoad, bool flagOnly = false) const;
 
+    /// Return the maximum BQ allowed by the terrain around the point (BQ_NOTHING, BQ_FLAG, BQ_MINE or BQ_CASTLE)
+    static inline BuildingQuality CalcTerrainBQ(const World& world, const MapPoint pt);
+
 private:
     const World& world;
+    const std::vector<BuildingQuality>* terrainBQs;
 };
 
-template<typename T_IsOnRoad>
-BuildingQuality BQCalculator::operator()(const MapPoint pt, T_IsOnRoad isOnRoad, bool flagOnly /*= false*/) const
+BuildingQuality BQCalculator::CalcTerrainBQ(const World& world, const MapPoint pt)
 {
-    // Cannot build on blocking objects
-    if(world.GetNO(pt)->GetBM() != BlockingManner::None)
-        return BQ_NOTHING;
-
-    //////////////////////////////////////////////////////////////////////////
-    // 1. Check maximum allowed BQ on terrain
-
     unsigned building_hits = 0;
     unsigned mine_hits = 0;
     unsigned flag_hits = 0;
@@ -61,19 +60,33 @@ BuildingQuality BQCalculator::operator()(const MapPoint pt, T_IsOnRoad isOnRoad,
             return BQ_NOTHING;
     }
 
-    BuildingQuality curBQ;
     if(flag_hits)
-        curBQ = BQ_FLAG;
+        return BQ_FLAG;
     else if(mine_hits == 6)
-        curBQ = BQ_MINE;
+        return BQ_MINE;
     else if(mine_hits)
-        curBQ = BQ_FLAG;
+        return BQ_FLAG;
     else if(building_hits == 6)
-        curBQ = BQ_CASTLE;
+        return BQ_CASTLE;
     else if(building_hits)
-        curBQ = BQ_FLAG;
+        return BQ_FLAG;
     else
         return BQ_NOTHING;
+}
+
+template<typename T_IsOnRoad>
+BuildingQuality BQCalculator::operator()(const MapPoint pt, T_IsOnRoad isOnRoad, bool flagOnly /*= false*/) const
+{
+    // Cannot build on blocking objects
+    if(world.GetNO(pt)->GetBM() != BlockingManner::None)
+        return BQ_NOTHING;
+
+    //////////////////////////////////////////////////////////////////////////
+    // 1. Check maximum allowed BQ on terrain
+
+    BuildingQuality curBQ = terrainBQs ? (*terrainBQs)[world.GetIdx(pt)] : CalcTerrainBQ(world, pt);
+    if(curBQ == BQ_NOTHING)
+        return BQ_NOTHING;
 
     RTTR_Assert(curBQ == BQ_FLAG || curBQ == BQ_MINE || curBQ == BQ_CASTLE);
 
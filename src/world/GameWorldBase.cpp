@@ -37,10 +37,28 @@
 #include <boost/foreach.hpp>
 #include <boost/lambda/bind.hpp>
 #include <boost/lambda/lambda.hpp>
+#include <algorithm>
+
+namespace {
+/// Memory to use for the cached ship distance fields and number of fields to cache at least
+BOOST_CONSTEXPR_OR_CONST unsigned SHIP_DISTANCE_FIELDS_MEMORY = 32 * 1024 * 1024;
+BOOST_CONSTEXPR_OR_CONST unsigned MIN_SHIP_DISTANCE_FIELDS = 4;
+/// Memory that may be used to keep the fields of all coastal points
+BOOST_CONSTEXPR_OR_CONST unsigned MAX_SHIP_DISTANCE_FIELDS_MEMORY = 256 * 1024 * 1024;
+
+/// Number of ship distance fields to cache for a map of the given size.
+/// Tries to keep one for each of the numCoastalPoints, so ships don't rebuild them for each route on maps with many harbors
+unsigned GetNumShipDistanceFields(const MapExtent& mapSize, unsigned numCoastalPoints)
+{
+    const unsigned fieldSize = std::max(1u, static_cast<unsigned>(mapSize.x * mapSize.y * sizeof(unsigned short)));
+    const unsigned numWanted = std::min(numCoastalPoints, MAX_SHIP_DISTANCE_FIELDS_MEMORY / fieldSize);
+    return std::max(MIN_SHIP_DISTANCE_FIELDS, std::max(SHIP_DISTANCE_FIELDS_MEMORY / fieldSize, numWanted));
+}
+} // namespace
 
 GameWorldBase::GameWorldBase(const std::vector<GamePlayer>& players, const GlobalGameSettings& gameSettings, EventManager& em)
     : roadPathFinder(new RoadPathFinder(*this)), freePathFinder(new FreePathFinder(*this)), players(players), gameSettings(gameSettings),
-      em(em), gi(NULL)
+      em(em), gi(NULL), shipDistanceFields(MIN_SHIP_DISTANCE_FIELDS)
 {
 }
 
@@ -52,10 +70,27 @@ void GameWorldBase::Init(const MapExtent& mapSize, LandscapeType lt)
 {
     World::Init(mapSize, lt);
     freePathFinder->Init(mapSize);
+    terrainBQs.clear();
+    shipDistanceFields = helpers::LRUCache<unsigned, std::vector<unsigned short> >(GetNumShipDistanceFields(mapSize, 0));
+    isBQDirty.assign(GetWidth() * GetHeight(), false);
+    isBQRowDirty.assign(GetHeight(), false);
 }
 
 void GameWorldBase::InitAfterLoad()
 {
+    // Ship routes go to the coastal point of a harbor at the ships sea, so there is one field per harbor and adjacent sea
+    unsigned numCoastalPoints = 0;
+    for(unsigned harborId = 1; harborId <= GetHarborPointCount(); ++harborId)
+    {
+        for(unsigned dir = 0; dir < Direction::COUNT; ++dir)
+        {
+            const unsigned short seaId = GetSeaId(harborId, Direction::fromInt(dir));
+            if(seaId && GetCoastalPoint(harborId, seaId) == GetNeighbour(GetHarborPoint(harborId), Direction::fromInt(dir)))
+                ++numCoastalPoints;
+        }
+    }
+    shipDistanceFields = helpers::LRUCache<unsigned, std::vector<unsigned short> >(GetNumShipDistanceFields(GetSize(), numCoastalPoints));
+    CalcTerrainBQs();
     for(unsigned y = 0; y < GetHeight(); ++y)
     {
         for(unsigned x = 0; x < GetWidth(); ++x)
@@ -109,7 +144,7 @@ bool GameWorldBase::IsRoadAvailable(const bool boat_road, const MapPoint pt) con
     }
 
     // dont build on the border
-    if(GetNode(pt).boundary_stones[0])
+    if(HasBorderStone(pt))
         return false;
 
     for(unsigned z = 0; z < 6; ++z)
@@ -282,6 +317,16 @@ void GameWorldBase::AltitudeChanged(const MapPoint pt)
     GetNotifications().publish(NodeNote(NodeNote::Altitude, pt));
 }
 
+void GameWorldBase::ResourceChanged(const MapPoint pt)
+{
+    GetNotifications().publish(NodeNote(NodeNote::Resource, pt));
+}
+
+void GameWorldBase::ObjectChanged(const MapPoint pt)
+{
+    GetNotifications().publish(NodeNote(NodeNote::Object, pt));
+}
+
 void GameWorldBase::RecalcBQAroundPoint(const MapPoint pt)
 {
     RecalcBQ(pt);
@@ -463,6 +508,7 @@ unsigned GameWorldBase::CalcHarborDistance(const unsigned habor_id1, const unsig
 }
 
 /// Bestimmt für einen beliebigen Punkt auf der Karte die Entfernung zum nächsten Hafenpunkt
+/// This is the direct distance (not a ship route), so it does not use the ship distance fields
 unsigned GameWorldBase::CalcDistanceToNearestHarbor(const MapPoint pos) const
 {
     unsigned min_distance = 0xffffffff;
@@ -773,9 +819,45 @@ std::vector<GameWorldBase::PotentialSeaAttacker> GameWorldBase::GetSoldiersForSe
     return attackers;
 }
 
+void GameWorldBase::CalcTerrainBQs()
+{
+    terrainBQs.resize(GetWidth() * GetHeight());
+    RTTR_FOREACH_PT(MapPoint, GetSize())
+    {
+        terrainBQs[GetIdx(pt)] = BQCalculator::CalcTerrainBQ(*this, pt);
+    }
+}
+
 void GameWorldBase::RecalcBQ(const MapPoint pt)
 {
-    BQCalculator calcBQ(*this);
+    if(terrainBQs.empty())
+        CalcTerrainBQs();
+    BQCalculator calcBQ(*this, terrainBQs);
     if(SetBQ(pt, calcBQ(pt, boost::lambda::bind(&GameWorldBase::IsOnRoad, this, boost::lambda::_1))))
         GetNotifications().publish(NodeNote(NodeNote::BQ, pt));
 }
+
+void GameWorldBase::InvalidateBQ(const MapPoint pt)
+{
+    isBQDirty[GetIdx(pt)] = true;
+    isBQRowDirty[pt.y] = true;
+}
+
+void GameWorldBase::RecalcDirtyBQs()
+{
+    MapPoint pt;
+    for(pt.y = 0; pt.y < GetHeight(); ++pt.y)
+    {
+        if(!isBQRowDirty[pt.y])
+            continue;
+        isBQRowDirty[pt.y] = false;
+        for(pt.x = 0; pt.x < GetWidth(); ++pt.x)
+        {
+            const unsigned idx = GetIdx(pt);
+            if(!isBQDirty[idx])
+                continue;
+            isBQDirty[idx] = false;
+            RecalcBQ(pt);
+        }
+    }
+}
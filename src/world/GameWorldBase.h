@@ -20,6 +20,7 @@
 
 #include "buildings/nobBaseMilitary.h"
 #include "helpers/Deleter.h"
+#include "helpers/LRUCache.h"
 #include "notifications/NotificationManager.h"
 #include "postSystem/PostManager.h"
 #include "world/World.h"
@@ -97,7 +98,11 @@ public:
     /// Finds a path for figures. Returns 0xFF if none found
     unsigned char FindHumanPath(const MapPoint start, const MapPoint dest, unsigned max_route = 0xFFFFFFFF, bool random_route = false,
                                 unsigned* length = NULL, std::vector<Direction>* route = NULL) const;
-    /// Find path for ships to a specific harbor and see. Return true on success
+    /// Check for each goal if it can be reached by figures from start with at most max_route steps (same as FindHumanPath != 0xFF).
+    /// Uses only one search for all goals
+    std::vector<bool> CheckHumanPaths(const MapPoint start, const std::vector<MapPoint>& goals, unsigned max_route) const;
+    /// Find path for ships to a specific harbor and see. Return true on success.
+    /// Uses the cached distance field of the coastal point so only the route itself has to be traced
     bool FindShipPathToHarbor(const MapPoint start, unsigned harborId, unsigned seaId, std::vector<Direction>* route, unsigned* length);
     /// Find path for ships with a limited distance. Return true on success
     bool FindShipPath(const MapPoint start, const MapPoint dest, unsigned maxDistance, std::vector<Direction>* route, unsigned* length);
@@ -196,6 +201,10 @@ public:
 
     /// Recalculates the BQ for the given point
     void RecalcBQ(const MapPoint pt);
+    /// Marks the BQ of the given point as outdated. It will be recalculated by the next call to RecalcDirtyBQs
+    void InvalidateBQ(const MapPoint pt);
+    /// Recalculates the BQ of all points marked by InvalidateBQ (row by row)
+    void RecalcDirtyBQs();
 
     bool HasLua() const { return lua.get() != NULL; }
     LuaInterfaceGame& GetLua() const { return *lua.get(); }
@@ -205,8 +214,29 @@ protected:
     void VisibilityChanged(const MapPoint pt, unsigned player) override;
     /// Called, when the altitude of a point was changed
     void AltitudeChanged(const MapPoint pt) override;
+    /// Called, when the resources of a point were changed
+    void ResourceChanged(const MapPoint pt) override;
+    /// Called, when the object of a point was changed
+    void ObjectChanged(const MapPoint pt) override;
+    /// Has to be called when the terrain of a node was changed
+    void InvalidateTerrainBQs() { terrainBQs.clear(); }
+    /// Has to be called when the terrain of a node was changed
+    void InvalidateShipDistanceFields() { shipDistanceFields.clear(); }
 
 private:
+    /// Maximum BQ allowed by the terrain around each node (empty if not calculated yet)
+    std::vector<BuildingQuality> terrainBQs;
+    /// Nodes and rows whose BQ has to be recalculated
+    std::vector<bool> isBQDirty, isBQRowDirty;
+
+    /// Distance for ships from each node to a coastal point indexed by the node index of the coastal point.
+    /// Only depends on the terrain, so they stay valid till the terrain changes. Unreachable nodes have SHIP_DISTANCE_UNREACHABLE
+    helpers::LRUCache<unsigned, std::vector<unsigned short> > shipDistanceFields;
+
+    void CalcTerrainBQs();
+    /// Return the distance field for ships to the given coastal point (calculated on first use).
+    /// The reference is only valid till the next call
+    const std::vector<unsigned short>& GetShipDistanceField(const MapPoint dest);
     /// Returns the harbor ID of the next matching harbor in the given direction (0 = None)
     /// T_IsHarborOk must be a predicate taking a harbor Id and returning a bool if the harbor is valid to return
     template<typename T_IsHarborOk>
@@ -22,6 +22,7 @@
 #include "GameClient.h"
 #include "GameInterface.h"
 #include "GamePlayer.h"
+#include "Instrumentation.h"
 #include "TradePathCache.h"
 #include "addons/const_addons.h"
 #include "buildings/noBuildingSite.h"
@@ -34,6 +35,7 @@
 #include "lua/LuaInterfaceGame.h"
 #include "notifications/BuildingNote.h"
 #include "notifications/ExpeditionNote.h"
+#include "notifications/NodeNote.h"
 #include "notifications/RoadNote.h"
 #include "pathfinding/PathConditionHuman.h"
 #include "pathfinding/PathConditionRoad.h"
@@ -48,6 +50,7 @@
 #include "gameData/MilitaryConsts.h"
 #include "gameData/SettingTypeConv.h"
 #include "gameData/TerrainData.h"
+#include <algorithm>
 #include <stdexcept>
 
 inline std::vector<GamePlayer> CreatePlayers(const std::vector<PlayerInfo>& playerInfos, GameWorldGame& gwg)
@@ -59,8 +62,32 @@ inline std::vector<GamePlayer> CreatePlayers(const std::vector<PlayerInfo>& play
     return players;
 }
 
+namespace {
+/// Visitor for the military squares: Is the point in the visual range of an occupied military building of the player?
+struct IsInVisualRangeOfMilBld
+{
+    const GameWorldBase& world;
+    const MapPoint pt;
+    const unsigned char player;
+    const noBaseBuilding* const exception;
+
+    IsInVisualRangeOfMilBld(const GameWorldBase& world, const MapPoint pt, const unsigned char player, const noBaseBuilding* const exception)
+        : world(world), pt(pt), player(player), exception(exception)
+    {}
+    bool operator()(const MilitarySquares::Entry& entry) const
+    {
+        if(entry.player != player || entry.bld == exception)
+            return false;
+        if(world.CalcDistance(pt, entry.pos) > unsigned(entry.radius + VISUALRANGE_MILITARY))
+            return false;
+        // Prüfen, obs auch unbesetzt ist
+        return !entry.IsMilitary() || !static_cast<const nobMilitary*>(entry.bld)->IsNewBuilt();
+    }
+};
+} // namespace
+
 GameWorldGame::GameWorldGame(const std::vector<PlayerInfo>& players, const GlobalGameSettings& gameSettings, EventManager& em)
-    : GameWorldBase(CreatePlayers(players, *this), gameSettings, em)
+    : GameWorldBase(CreatePlayers(players, *this), gameSettings, em), isTerritoryBatchActive(false), isMilitaryBatchActive(false)
 {
     TradePathCache::inst().Clear();
 }
@@ -131,6 +158,7 @@ void GameWorldGame::SetPointRoad(MapPoint pt, Direction dir, unsigned char type)
         pt = GetNeighbour(pt, dir);
 
     SetRoad(pt, dir.toUInt(), type);
+    GetNotifications().publish(NodeNote(NodeNote::Road, pt));
 
     if(gi)
         gi->GI_UpdateMinimap(pt);
@@ -359,6 +387,7 @@ bool GameWorldGame::IsObjectionableForRoad(const MapPoint pt)
 void GameWorldGame::RecalcTerritory(const noBaseBuilding& building, const bool destroyed, const bool newBuilt)
 {
     RTTR_Assert(!destroyed || !newBuilt); // Both set is pointless
+    Instrumentation::ScopedTimer timer(INSTR_TERRITORY);
 
     // Radius der noch draufaddiert wird auf den eigentlich ausreichenden Bereich, für das Eliminieren von
     // herausragenden Landesteilen und damit Grenzsteinen
@@ -371,6 +400,7 @@ void GameWorldGame::RecalcTerritory(const noBaseBuilding& building, const bool d
                                       static_cast<const nobBaseMilitary&>(building).GetMilitaryRadius();
 
     TerritoryRegion region = CreateTerritoryRegion(building, militaryRadius + ADD_RADIUS, destroyed);
+    timer.AddCount(static_cast<unsigned>(region.size.x * region.size.y));
 
     // Set to true, where owner has changed (initially all false)
     std::vector<bool> ownerChanged(region.size.x * region.size.y, false);
@@ -456,7 +486,10 @@ void GameWorldGame::RecalcTerritory(const noBaseBuilding& building, const bool d
 
                 // Wenn kein Land angrenzt, dann nicht nehmen
                 if(!isPlayerTerritoryNear)
+                {
                     SetOwner(curMapPt, 0);
+                    GetNotifications().publish(NodeNote(NodeNote::Owner, curMapPt));
+                }
             }
 
             // Drumherum (da ja Grenzen mit einberechnet werden ins Gebiet, da darf trotzdem nichts stehen) alles vom Spieler zerstören
@@ -469,20 +502,25 @@ void GameWorldGame::RecalcTerritory(const noBaseBuilding& building, const bool d
 
                     DestroyPlayerRests(neighbourPt, GetNode(curMapPt).owner, &building, false);
 
-                    // BQ neu berechnen
-                    RecalcBQ(neighbourPt);
-                    // ggf den noch darüber, falls es eine Flagge war (kann ja ein Gebäude entstehen)
-                    if(GetNeighbourNode(neighbourPt, Direction::NORTHWEST).bq != BQ_NOTHING)
-                        RecalcBQ(GetNeighbour(neighbourPt, 1));
+                    // BQ neu berechnen (gesammelt nach der Schleife)
+                    InvalidateBQ(neighbourPt);
+                    // und den darüber, falls es eine Flagge war (kann ja ein Gebäude entstehen)
+                    InvalidateBQ(GetNeighbour(neighbourPt, Direction::NORTHWEST));
                 }
 
+                GetNotifications().publish(NodeNote(NodeNote::Owner, curMapPt));
                 if(gi)
                     gi->GI_UpdateMinimap(curMapPt);
             }
         }
     }
 
-    RecalcBorderStones(region.startPt, region.endPt);
+    RecalcDirtyBQs();
+
+    if(isTerritoryBatchActive)
+        pendingBorderStoneRegions.push_back(Rect(region.startPt, Extent(region.size)));
+    else
+        RecalcBorderStones(region.startPt, region.endPt);
 
     // Sichtbarkeiten berechnen
 
@@ -495,6 +533,116 @@ void GameWorldGame::RecalcTerritory(const noBaseBuilding& building, const bool d
         SetVisibilitiesAroundPoint(building.GetPos(), visualRadius, building.GetPlayer());
 }
 
+namespace {
+/// Return true if the regions overlap or touch each other
+bool AreRegionsConnected(const Rect& lhs, const Rect& rhs)
+{
+    return lhs.left <= rhs.right && rhs.left <= lhs.right && lhs.top <= rhs.bottom && rhs.top <= lhs.bottom;
+}
+} // namespace
+
+void GameWorldGame::BeginTerritoryBatch()
+{
+    RTTR_Assert(!isTerritoryBatchActive);
+    isTerritoryBatchActive = true;
+}
+
+void GameWorldGame::EndTerritoryBatch()
+{
+    RTTR_Assert(isTerritoryBatchActive);
+    isTerritoryBatchActive = false;
+
+    // Merge connected regions, so every node gets its border stones calculated only once
+    // As border stones only depend on the final ownership, this gives the same result as updating them after each change
+    std::vector<Rect> mergedRegions;
+    for(std::vector<Rect>::const_iterator it = pendingBorderStoneRegions.begin(); it != pendingBorderStoneRegions.end(); ++it)
+    {
+        Rect curRegion = *it;
+        for(unsigned i = 0; i < mergedRegions.size();)
+        {
+            if(!AreRegionsConnected(curRegion, mergedRegions[i]))
+            {
+                ++i;
+                continue;
+            }
+            const Rect& other = mergedRegions[i];
+            curRegion.left = std::min(curRegion.left, other.left);
+            curRegion.top = std::min(curRegion.top, other.top);
+            curRegion.right = std::max(curRegion.right, other.right);
+            curRegion.bottom = std::max(curRegion.bottom, other.bottom);
+            mergedRegions.erase(mergedRegions.begin() + i);
+            // The bigger region might now connect to regions already checked
+            i = 0;
+        }
+        mergedRegions.push_back(curRegion);
+    }
+    pendingBorderStoneRegions.clear();
+
+    for(std::vector<Rect>::const_iterator it = mergedRegions.begin(); it != mergedRegions.end(); ++it)
+    {
+        Instrumentation::ScopedTimer timer(INSTR_TERRITORY);
+        // Never span more than the map
+        const Point<int> endPt(std::min(it->right, it->left + GetWidth()), std::min(it->bottom, it->top + GetHeight()));
+        timer.AddCount(static_cast<unsigned>((endPt.x - it->left) * (endPt.y - it->top)));
+        RecalcBorderStones(it->getOrigin(), endPt);
+    }
+}
+
+void GameWorldGame::BeginMilitaryBatch()
+{
+    RTTR_Assert(!isMilitaryBatchActive);
+    isMilitaryBatchActive = true;
+}
+
+void GameWorldGame::EndMilitaryBatch()
+{
+    RTTR_Assert(isMilitaryBatchActive);
+    // Frontier checks can request troop regulations, so do them first while still collecting.
+    // Buildings destroyed meanwhile are already removed from the military squares, so no exception is required
+    for(unsigned i = 0; i < pendingFrontierChecks.size(); ++i)
+    {
+        if(pendingFrontierChecks[i])
+            pendingFrontierChecks[i]->LookForEnemyBuildings(NULL);
+    }
+    pendingFrontierChecks.clear();
+    pendingFrontierCheckSet.clear();
+    isMilitaryBatchActive = false;
+
+    // Buildings might get canceled (set to NULL) while regulating others, so use indices
+    for(unsigned i = 0; i < pendingTroopRegulations.size(); ++i)
+    {
+        if(pendingTroopRegulations[i])
+            pendingTroopRegulations[i]->RegulateTroops();
+    }
+    pendingTroopRegulations.clear();
+    pendingTroopRegulationSet.clear();
+}
+
+void GameWorldGame::RequestFrontierCheck(nobMilitary& bld, const nobBaseMilitary* const exception)
+{
+    if(!isMilitaryBatchActive)
+        bld.LookForEnemyBuildings(exception);
+    else if(pendingFrontierCheckSet.insert(&bld).second)
+        pendingFrontierChecks.push_back(&bld);
+}
+
+void GameWorldGame::RequestTroopRegulation(nobMilitary& bld)
+{
+    if(!isMilitaryBatchActive)
+        bld.RegulateTroops();
+    else if(pendingTroopRegulationSet.insert(&bld).second)
+        pendingTroopRegulations.push_back(&bld);
+}
+
+void GameWorldGame::CancelMilitaryRequests(nobMilitary& bld)
+{
+    // Also remove it from the sets, as a new building might get the same address
+    if(pendingFrontierCheckSet.erase(&bld))
+        std::replace(pendingFrontierChecks.begin(), pendingFrontierChecks.end(), &bld, static_cast<nobMilitary*>(NULL));
+    if(pendingTroopRegulationSet.erase(&bld))
+        std::replace(pendingTroopRegulations.begin(), pendingTroopRegulations.end(), &bld, static_cast<nobMilitary*>(NULL));
+}
+
 // When defined the game tries to remove "blocks" of border stones that look ugly (TODO: Example?)
 // DISABLED: This currently leads to bugs. If you enable/fix this, please add tests and document the conditions this tries to fix
 //#define PREVENT_BORDER_STONE_BLOCKING
@@ -526,24 +674,17 @@ void GameWorldGame::RecalcBorderStones(Point<int> startPt, Point<int> endPt)
         {
             // Make map point
             const MapPoint curMapPt = MakeMapPoint(pt);
-            const unsigned char owner = GetNode(curMapPt).owner;
+            // Stones on border nodes and the half-way stones to neighboring border nodes, nothing otherwise
             BoundaryStones& boundaryStones = GetBoundaryStones(curMapPt);
-
-            // Is this a border node?
-            if(owner && IsBorderNode(curMapPt, owner))
-            {
-                boundaryStones[0] = owner;
-
-                // Check which neighbors are also border nodes and place the half-way stones to them
-                for(unsigned i = 0; i < 3; ++i)
-                {
-                    if(IsBorderNode(GetNeighbour(curMapPt, 3 + i), owner))
-                        boundaryStones[i + 1] = owner;
-                    else
-                        boundaryStones[i + 1] = 0;
-                }
+            const unsigned char oldOwner = boundaryStones[0];
+            boundaryStones = CalcBoundaryStones(curMapPt);
+            if(boundaryStones[0] != oldOwner)
+                GetNotifications().publish(NodeNote(NodeNote::Border, curMapPt));
 
 #ifdef PREVENT_BORDER_STONE_BLOCKING
+            const unsigned char owner = boundaryStones[0];
+            if(owner)
+            {
                 // Count number of border nodes with same owner
                 Point<int> offset(pt - startPt);
                 int idx = offset.y * width + offset.x;
@@ -552,12 +693,8 @@ void GameWorldGame::RecalcBorderStones(Point<int> startPt, Point<int> endPt)
                     if(GetNeighbourNode(curMapPt, i).boundary_stones[0] == owner)
                         ++neighbors[idx];
                 }
-#endif
-            } else
-            {
-                // Not a border node -> Delete all border stones
-                std::fill(boundaryStones.begin(), boundaryStones.end(), 0);
             }
+#endif
         }
     }
 
@@ -771,6 +908,7 @@ void GameWorldGame::RoadNodeAvailable(const MapPoint pt)
     }
 }
 
+namespace {
 /// Kleine Klasse für Angriffsfunktion für einen potentielle angreifenden Soldaten
 struct PotentialAttacker
 {
@@ -779,6 +917,30 @@ struct PotentialAttacker
     unsigned distance;
 };
 
+/// Orders attackers by rank (strongest or weakest first) and then by distance
+struct CmpPotentialAttacker
+{
+    const bool strongFirst;
+    explicit CmpPotentialAttacker(bool strongFirst) : strongFirst(strongFirst) {}
+    bool operator()(const PotentialAttacker& lhs, const PotentialAttacker& rhs) const
+    {
+        const unsigned lhsRank = lhs.soldier->GetRank();
+        const unsigned rhsRank = rhs.soldier->GetRank();
+        if(lhsRank != rhsRank)
+            return strongFirst ? lhsRank > rhsRank : lhsRank < rhsRank;
+        return lhs.distance < rhs.distance;
+    }
+};
+
+/// Military building that can send soldiers for an attack
+struct AttackerBuilding
+{
+    nobMilitary* bld;
+    unsigned numSoldiers;
+    unsigned distance;
+};
+} // namespace
+
 void GameWorldGame::Attack(const unsigned char player_attacker, const MapPoint pt, const unsigned short soldiers_count,
                            const bool strong_soldiers)
 {
@@ -793,9 +955,8 @@ void GameWorldGame::Attack(const unsigned char player_attacker, const MapPoint p
     // Militärgebäude in der Nähe finden
     sortedMilitaryBlds buildings = LookForMilitaryBuildings(pt, 3);
 
-    // Liste von verfügbaren Soldaten, geordnet einfügen, damit man dann starke oder schwache Soldaten nehmen kann
-    std::list<PotentialAttacker> soldiers;
-
+    std::vector<AttackerBuilding> attackerBlds;
+    std::vector<MapPoint> attackerBldPositions;
     for(sortedMilitaryBlds::iterator it = buildings.begin(); it != buildings.end(); ++it)
     {
         // Muss ein Gebäude von uns sein und darf nur ein "normales Militärgebäude" sein (kein HQ etc.)
@@ -826,74 +987,47 @@ void GameWorldGame::Attack(const unsigned char player_attacker, const MapPoint p
         if(!soldiers_count)
             continue;
 
-        // The path should not be to far. If it is skip this
-        // Also use a bit of tolerance for the path
-        if(FindHumanPath(pt, (*it)->GetPos(), MAX_ATTACKING_RUN_DISTANCE)
-           == 0xFF) // TODO check: hier wird ne random-route berechnet? soll das so?
-            continue;
+        AttackerBuilding attackerBld = {static_cast<nobMilitary*>(*it), soldiers_count, distance};
+        attackerBlds.push_back(attackerBld);
+        attackerBldPositions.push_back((*it)->GetPos());
+    }
 
-        // Take soldier(s)
+    // The path should not be to far. If it is skip the building. Check all buildings at once
+    // Also use a bit of tolerance for the path
+    const std::vector<bool> isReachable = CheckHumanPaths(pt, attackerBldPositions, MAX_ATTACKING_RUN_DISTANCE);
+
+    // Take soldier(s): The strongest (or weakest) ones of each building
+    std::vector<PotentialAttacker> soldiers;
+    for(unsigned bldIdx = 0; bldIdx < attackerBlds.size(); ++bldIdx)
+    {
+        if(!isReachable[bldIdx])
+            continue;
+        const AttackerBuilding& attackerBld = attackerBlds[bldIdx];
+        const SortedTroops& troops = attackerBld.bld->GetTroops();
         unsigned i = 0;
-        const SortedTroops& troops = static_cast<nobMilitary*>(*it)->GetTroops();
         if(strong_soldiers)
         {
-            // Strong soldiers first
-            for(SortedTroops::const_reverse_iterator it2 = troops.rbegin(); it2 != troops.rend() && i < soldiers_count; ++it2, ++i)
+            for(SortedTroops::const_reverse_iterator it = troops.rbegin(); it != troops.rend() && i < attackerBld.numSoldiers; ++it, ++i)
             {
-                bool inserted = false;
-                for(std::list<PotentialAttacker>::iterator it3 = soldiers.begin(); it3 != soldiers.end(); ++it3)
-                {
-                    /* Insert new soldier before current one if:
-                            new soldiers rank is greater
-                            OR new soldiers rank is equal AND new soldiers distance is smaller */
-                    if(it3->soldier->GetRank() < (*it2)->GetRank()
-                       || (it3->soldier->GetRank() == (*it2)->GetRank() && it3->distance > distance))
-                    {
-                        PotentialAttacker pa = {*it2, distance};
-                        soldiers.insert(it3, pa);
-                        inserted = true;
-                        break;
-                    }
-                }
-                if(!inserted)
-                {
-                    PotentialAttacker pa = {*it2, distance};
-                    soldiers.push_back(pa);
-                }
+                PotentialAttacker pa = {*it, attackerBld.distance};
+                soldiers.push_back(pa);
             }
         } else
         {
-            // Weak soldiers first
-            for(SortedTroops::const_iterator it2 = troops.begin(); it2 != troops.end() && i < soldiers_count; ++it2, ++i)
+            for(SortedTroops::const_iterator it = troops.begin(); it != troops.end() && i < attackerBld.numSoldiers; ++it, ++i)
             {
-                bool inserted = false;
-                for(std::list<PotentialAttacker>::iterator it3 = soldiers.begin(); it3 != soldiers.end(); ++it3)
-                {
-                    /* Insert new soldier before current one if:
-                            new soldiers rank is less
-                            OR new soldiers rank is equal AND new soldiers distance is smaller */
-                    if(it3->soldier->GetRank() > (*it2)->GetRank()
-                       || (it3->soldier->GetRank() == (*it2)->GetRank() && it3->distance > distance))
-                    {
-                        PotentialAttacker pa = {*it2, distance};
-                        soldiers.insert(it3, pa);
-                        inserted = true;
-                        break;
-                    }
-                }
-                if(!inserted)
-                {
-                    PotentialAttacker pa = {*it2, distance};
-                    soldiers.push_back(pa);
-                }
+                PotentialAttacker pa = {*it, attackerBld.distance};
+                soldiers.push_back(pa);
             }
-        } // End weak/strong check
+        }
     }
+    // Stable, so soldiers of the same rank and distance keep the order of the buildings and troops
+    std::stable_sort(soldiers.begin(), soldiers.end(), CmpPotentialAttacker(strong_soldiers));
 
     // Send the soldiers to attack
     unsigned short i = 0;
 
-    for(std::list<PotentialAttacker>::iterator it = soldiers.begin(); it != soldiers.end() && i < soldiers_count; ++i, ++it)
+    for(std::vector<PotentialAttacker>::iterator it = soldiers.begin(); it != soldiers.end() && i < soldiers_count; ++i, ++it)
     {
         // neuen Angreifer-Soldaten erzeugen
         new nofAttacker(it->soldier, attacked_building);
@@ -1124,24 +1258,10 @@ bool GameWorldGame::ValidPointForFighting(const MapPoint pt, const bool avoid_mi
 
 bool GameWorldGame::IsPointCompletelyVisible(const MapPoint pt, const unsigned char player, const noBaseBuilding* const exception) const
 {
-    sortedMilitaryBlds buildings = LookForMilitaryBuildings(pt, 3);
-
     // Sichtbereich von Militärgebäuden
-    for(sortedMilitaryBlds::iterator it = buildings.begin(); it != buildings.end(); ++it)
-    {
-        if((*it)->GetPlayer() == player && *it != exception)
-        {
-            // Prüfen, obs auch unbesetzt ist
-            if((*it)->GetGOT() == GOT_NOB_MILITARY)
-            {
-                if(static_cast<nobMilitary*>(*it)->IsNewBuilt())
-                    continue;
-            }
-
-            if(CalcDistance(pt, (*it)->GetPos()) <= unsigned((*it)->GetMilitaryRadius() + VISUALRANGE_MILITARY))
-                return true;
-        }
-    }
+    IsInVisualRangeOfMilBld isInVisualRange(*this, pt, player, exception);
+    if(militarySquares.VisitBuildingsInRange(pt, 3, isInVisualRange))
+        return true;
 
     // Sichtbereich von Hafenbaustellen
     for(std::list<noBuildingSite*>::const_iterator it = harbor_building_sites_from_sea.begin(); it != harbor_building_sites_from_sea.end();
@@ -1510,6 +1630,9 @@ bool GameWorldGame::IsResourcesOnNode(const MapPoint pt, const unsigned char typ
 
 MapNode& GameWorldGame::GetNodeWriteable(const MapPoint pt)
 {
+    // Terrain might be changed
+    InvalidateTerrainBQs();
+    InvalidateShipDistanceFields();
     return GetNodeInt(pt);
 }
 
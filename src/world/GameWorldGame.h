@@ -18,15 +18,19 @@
 #ifndef GameWorldGame_h__
 #define GameWorldGame_h__
 
+#include "Rect.h"
 #include "world/GameWorldBase.h"
 #include "gameTypes/MapCoordinates.h"
+#include <set>
 #include <vector>
 
 class CatapultStone;
 class GameInterface;
 class MilitarySquares;
 class noBaseBuilding;
+class nobBaseMilitary;
 class noBuildingSite;
+class nobMilitary;
 class noRoadNode;
 class nofActiveSoldier;
 class nofAttacker;
@@ -57,6 +61,17 @@ class GameWorldGame : public GameWorldBase
     /// Creates a region with territories marked around a building with the given radius
     TerritoryRegion CreateTerritoryRegion(const noBaseBuilding& building, unsigned radius, const bool destroyed) const;
 
+    /// True while the border stone updates of territory changes are collected instead of applied
+    bool isTerritoryBatchActive;
+    /// Regions changed by RecalcTerritory whose border stones still need to be recalculated
+    std::vector<Rect> pendingBorderStoneRegions;
+    /// True while frontier distance checks and troop regulations of military buildings are collected instead of done
+    bool isMilitaryBatchActive;
+    /// Military buildings that still need to check their frontier distance or regulate their troops (no duplicates, NULL = canceled)
+    std::vector<nobMilitary*> pendingFrontierChecks, pendingTroopRegulations;
+    /// Buildings contained in the lists above, to find duplicates without searching the lists
+    std::set<nobMilitary*> pendingFrontierCheckSet, pendingTroopRegulationSet;
+
 protected:
     /// Create Trade graphs
     void CreateTradeGraphs();
@@ -112,6 +127,25 @@ public:
     /// Militärgebäude rum) neu, destroyed gibt an, ob building abgerissen wurde und somit nicht einberechnet werden soll
     void RecalcTerritory(const noBaseBuilding& building, const bool destroyed, const bool newBuilt);
 
+    /// Start collecting the border stone updates of all following territory changes (e.g. of one GF).
+    /// Ownership, BQ and visibility are still updated immediately as they are used by the game logic
+    void BeginTerritoryBatch();
+    /// Recalculate the border stones once over the merged regions of all territory changes since BeginTerritoryBatch
+    void EndTerritoryBatch();
+
+    /// Start collecting the frontier distance checks and troop regulations of military buildings (e.g. of one GF).
+    /// Building, capturing or destroying a building triggers those for all buildings around it, so each building does them only once
+    void BeginMilitaryBatch();
+    /// Do all frontier checks and then all troop regulations requested since BeginMilitaryBatch in the order they were requested
+    void EndMilitaryBatch();
+    /// Let the building check its frontier distance (LookForEnemyBuildings) now or at the end of the current batch.
+    /// exception is a building being destroyed and is only required when done immediately
+    void RequestFrontierCheck(nobMilitary& bld, const nobBaseMilitary* const exception = NULL);
+    /// Let the building regulate its troops now or at the end of the current batch
+    void RequestTroopRegulation(nobMilitary& bld);
+    /// Has to be called when a military building is destroyed to discard its pending requests
+    void CancelMilitaryRequests(nobMilitary& bld);
+
     /// Berechnet das Land in einem bestimmten Bereich um ein aktuelles Militärgebäude rum neu und gibt zurück ob sich etwas verändern würde
     /// (auf für ki wichtigem untergrund) wenn das Gebäude zerstört werden würde
     bool DoesTerritoryChange(const noBaseBuilding& building, const bool destroyed, const bool newBuilt) const;
@@ -32,6 +32,7 @@
 #include "helpers/converters.h"
 #include "ogl/glArchivItem_Font.h"
 #include "ogl/glSmartBitmap.h"
+#include "ogl/glSpriteBatch.h"
 #include "world/GameWorldViewer.h"
 #include "gameTypes/RoadBuildState.h"
 #include "gameData/GuiConsts.h"
@@ -122,6 +123,8 @@ void GameWorldView::Draw(const RoadBuildState& rb, const bool draw_selected, con
     Point<int> mousePos(VIDEODRIVER.GetMouseX(), VIDEODRIVER.GetMouseY());
     mousePos -= Point<int>(pos);
 
+    // Draw everything from before with the old clipping and transformation
+    SPRITEBATCH.Flush();
     glScissor(pos.x, VIDEODRIVER.GetScreenHeight() - pos.y - size_.y, size_.x, size_.y);
     if(zoomFactor_ != 1.f)
     {
@@ -144,6 +147,8 @@ void GameWorldView::Draw(const RoadBuildState& rb, const bool draw_selected, con
     terrainRenderer.Draw(GetFirstPt(), GetLastPt(), gwv, water);
     glTranslatef(static_cast<GLfloat>(offset.x), static_cast<GLfloat>(offset.y), 0.0f);
 
+    // Objects and figures are collected and drawn with as few draw calls as possible (in the same order)
+    SPRITEBATCH.Begin();
     for(int y = firstPt.y; y <= lastPt.y; ++y)
     {
         // Figuren speichern, die in dieser Zeile gemalt werden müssen
@@ -207,6 +212,7 @@ void GameWorldView::Draw(const RoadBuildState& rb, const bool draw_selected, con
         if(gwv.GetVisibility((*it)->dest_building) == VIS_VISIBLE || gwv.GetVisibility((*it)->dest_map) == VIS_VISIBLE)
             (*it)->Draw(offset);
     }
+    SPRITEBATCH.End();
 
     if(zoomFactor_ != 1.f)
     {
@@ -32,6 +32,25 @@
 #include <boost/lambda/if.hpp>
 #include <boost/lambda/lambda.hpp>
 
+namespace {
+/// Visitor for the military squares: Sums up the soldiers of the players military buildings available for attacking a point
+struct CountSoldiersForAttack
+{
+    const MapPoint pt;
+    const unsigned char player;
+    unsigned count;
+
+    CountSoldiersForAttack(const MapPoint pt, const unsigned char player) : pt(pt), player(player), count(0) {}
+    bool operator()(const MilitarySquares::Entry& entry)
+    {
+        // Muss ein Gebäude von uns sein und darf nur ein "normales Militärgebäude" sein (kein HQ etc.)
+        if(entry.player == player && entry.IsMilitary())
+            count += static_cast<const nobMilitary*>(entry.bld)->GetNumSoldiersForAttack(pt);
+        return false;
+    }
+};
+} // namespace
+
 GameWorldViewer::GameWorldViewer(unsigned playerId, GameWorldBase& gwb) : playerId_(playerId), gwb(gwb)
 {
     InitVisualData();
@@ -40,6 +59,7 @@ GameWorldViewer::GameWorldViewer(unsigned playerId, GameWorldBase& gwb) : player
 void GameWorldViewer::InitVisualData()
 {
     visualNodes.resize(gwb.GetWidth() * gwb.GetHeight());
+    numVisualRoads = 0;
     for(MapPoint pt(0, 0); pt.y < gwb.GetHeight(); ++pt.y)
     {
         for(pt.x = 0; pt.x < gwb.GetWidth(); ++pt.x)
@@ -67,6 +87,9 @@ void GameWorldViewer::InitTerrainRenderer()
     evAltitudeChanged = gwb.GetNotifications().subscribe<NodeNote>(
       bl::if_(bl::bind(&NodeNote::type, _1)
               == NodeNote::Altitude)[bl::bind(&TerrainRenderer::AltitudeChanged, &tr, bl::bind(&NodeNote::pt, _1), boost::cref(*this))]);
+    // And road changes
+    evRoadChanged = gwb.GetNotifications().subscribe<NodeNote>(
+      bl::if_(bl::bind(&NodeNote::type, _1) == NodeNote::Road)[bl::bind(&TerrainRenderer::RoadChanged, &tr, bl::bind(&NodeNote::pt, _1))]);
     // And visibility changes
     evVisibilityChanged =
       gwb.GetNotifications().subscribe<PlayerNodeNote>(bl::if_(bl::bind(&PlayerNodeNote::type, _1) == PlayerNodeNote::Visibility)[bl::bind(
@@ -91,17 +114,9 @@ unsigned GameWorldViewer::GetNumSoldiersForAttack(const MapPoint pt) const
         return 0;
 
     // Militärgebäude in der Nähe finden
-    unsigned total_count = 0;
-
-    sortedMilitaryBlds buildings = GetWorld().LookForMilitaryBuildings(pt, 3);
-    for(sortedMilitaryBlds::iterator it = buildings.begin(); it != buildings.end(); ++it)
-    {
-        // Muss ein Gebäude von uns sein und darf nur ein "normales Militärgebäude" sein (kein HQ etc.)
-        if((*it)->GetPlayer() == playerId_ && (*it)->GetBuildingType() >= BLD_BARRACKS && (*it)->GetBuildingType() <= BLD_FORTRESS)
-            total_count += static_cast<nobMilitary*>(*it)->GetNumSoldiersForAttack(pt);
-    }
-
-    return total_count;
+    CountSoldiersForAttack countSoldiers(pt, static_cast<unsigned char>(playerId_));
+    GetWorld().militarySquares.VisitBuildingsInRange(pt, 3, countSoldiers);
+    return countSoldiers.count;
 }
 
 BuildingQuality GameWorldViewer::GetBQ(const MapPoint& pt) const
@@ -184,7 +199,13 @@ void GameWorldViewer::SetVisiblePointRoad(const MapPoint& pt, Direction dir, uns
         dir = Direction::fromInt(dir.toUInt() - 3);
     } else
         nodePt = GetNeighbour(pt, dir);
-    visualNodes[GetWorld().GetIdx(nodePt)].roads[dir.toUInt()] = type;
+    unsigned char& road = visualNodes[GetWorld().GetIdx(nodePt)].roads[dir.toUInt()];
+    if(road && !type)
+        --numVisualRoads;
+    else if(!road && type)
+        ++numVisualRoads;
+    road = type;
+    tr.RoadChanged(nodePt);
 }
 
 bool GameWorldViewer::IsOnRoad(const MapPoint& pt) const
@@ -266,6 +287,12 @@ void GameWorldViewer::RoadConstructionEnded(const RoadNote& note)
 
 void GameWorldViewer::RecalcBQ(const MapPoint& pt)
 {
+    // Without road overlays the BQ is the same as the (already calculated) one of the world
+    if(!numVisualRoads)
+    {
+        visualNodes[GetWorld().GetIdx(pt)].bq = GetWorld().GetNode(pt).bq;
+        return;
+    }
     BQCalculator calcBQ(GetWorld());
     visualNodes[GetWorld().GetIdx(pt)].bq = calcBQ(pt, boost::lambda::bind(&GameWorldViewer::IsOnRoad, this, boost::lambda::_1));
 }
@@ -111,8 +111,10 @@ private:
     unsigned playerId_;
     GameWorldBase& gwb;
     TerrainRenderer tr;
-    Subscribtion evVisibilityChanged, evAltitudeChanged, evRoadConstruction, evBQChanged;
+    Subscribtion evVisibilityChanged, evAltitudeChanged, evRoadChanged, evRoadConstruction, evBQChanged;
     std::vector<VisualMapNode> visualNodes;
+    /// Number of road overlays currently set. If zero the visual BQ equals the BQ of the world
+    unsigned numVisualRoads;
 
     void InitVisualData();
     inline void VisibilityChanged(const MapPoint& pt, unsigned player);
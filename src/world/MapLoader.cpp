@@ -19,6 +19,7 @@
 #include "world/MapLoader.h"
 #include "Random.h"
 #include "buildings/nobHQ.h"
+#include "helpers/ParallelFor.h"
 #include "ogl/glArchivItem_Map.h"
 #include "pathfinding/PathConditionShip.h"
 #include "world/World.h"
@@ -32,6 +33,7 @@
 #include "gameData/TerrainData.h"
 #include "libsiedler2/src/ArchivItem_Map_Header.h"
 #include "libutil/src/Log.h"
+#include <boost/foreach.hpp>
 #include <algorithm>
 #include <queue>
 
@@ -447,6 +449,7 @@ void MapLoader::InitSeasAndHarbors(World& world, const std::vector<MapPoint>& ad
     CalcHarborPosNeighbors(world);
 }
 
+namespace {
 // class for finding harbor neighbors
 class CalcHarborPosNeighborsNode
 {
@@ -458,98 +461,167 @@ public:
     unsigned distance;
 };
 
-/// Calculate the distance from each harbor to the others
-void MapLoader::CalcHarborPosNeighbors(World& world)
+/// Calculates the neighbors of the harbors with one BFS per harbor.
+/// The harbors are independent of each other and are distributed over numTasks tasks which can run in parallel.
+class HarborNeighborsCalculator
 {
-    PathConditionShip shipPathChecker(world);
+public:
+    HarborNeighborsCalculator(const World& world, std::vector<HarborPos>& harborPos, unsigned numTasks);
+    /// Calculate the neighbors of harbors taskIdx + 1, taskIdx + 1 + numTasks, ...
+    void operator()(unsigned taskIdx);
 
-    // pre-calculate sea-points, as IsSeaPoint is rather expensive
-    std::vector<unsigned> ptIsSeaPt(world.nodes.size()); //-V656
+private:
+    /// Buffers reused for all harbors of a task
+    struct Scratch
+    {
+        /// Points with the current start harbor id are visited
+        std::vector<unsigned> visitedBy;
+        /// Harbor ids (+ 1) already found
+        std::vector<bool> hbFound;
+        /// FIFO queue used for the BFS
+        std::queue<CalcHarborPosNeighborsNode> todo_list;
+    };
+
+    void CalcNeighbors(unsigned startHbId, Scratch& scratch);
+
+    const World& world;
+    std::vector<HarborPos>& harborPos;
+    const unsigned numTasks;
+    const PathConditionShip shipPathChecker;
+    /// Pre-calculated sea points, as IsSeaPoint is rather expensive
+    std::vector<bool> ptIsSeaPt;
+    /// For each coastal point of a harbor its id + 1 (0 for other points). If there are multiple harbors with the same coastal point
+    /// this is the highest id and coastPtHb2 the 2nd highest
+    std::vector<unsigned> coastPtHb, coastPtHb2;
+    /// Coastal points of each harbor (one per sea)
+    std::vector<std::vector<MapPoint> > coastPts;
+};
 
+HarborNeighborsCalculator::HarborNeighborsCalculator(const World& world, std::vector<HarborPos>& harborPos, unsigned numTasks)
+    : world(world), harborPos(harborPos), numTasks(numTasks), shipPathChecker(world)
+{
+    const unsigned numNodes = world.GetWidth() * world.GetHeight();
+    ptIsSeaPt.resize(numNodes);
     RTTR_FOREACH_PT(MapPoint, world.GetSize())
+        ptIsSeaPt[world.GetIdx(pt)] = shipPathChecker.IsNodeOk(pt);
+
+    coastPtHb.resize(numNodes);
+    coastPtHb2.resize(numNodes);
+    coastPts.resize(harborPos.size());
+    for(unsigned hbId = 1; hbId < harborPos.size(); ++hbId)
     {
-        if(shipPathChecker.IsNodeOk(pt))
-            ptIsSeaPt[world.GetIdx(pt)] = 1;
+        std::vector<bool> seaIsMarked(world.GetNumSeas(), false);
+        for(unsigned d = 0; d < Direction::COUNT; d++)
+        {
+            // In every direction there can be a coastal point to a sea
+            // So find the sea first and then the dedicated coastal point
+            unsigned seaId = world.GetSeaId(hbId, Direction::fromInt(d));
+            // No sea? -> Next
+            if(!seaId)
+                continue;
+            // Skip marked seas
+            if(seaIsMarked[seaId - 1])
+                continue;
+            seaIsMarked[seaId - 1] = true;
+            // Get designated coastal point
+            const MapPoint coastPt = world.GetCoastalPoint(hbId, seaId);
+            const unsigned idx = world.GetIdx(coastPt);
+            // This should not be marked for visit
+            RTTR_Assert(!ptIsSeaPt[idx]);
+            coastPts[hbId].push_back(coastPt);
+            // Ids are ascending, so the current one is the highest
+            if(coastPtHb[idx] != hbId + 1)
+            {
+                coastPtHb2[idx] = coastPtHb[idx];
+                coastPtHb[idx] = hbId + 1;
+            }
+        }
     }
+}
 
-    // FIFO queue used for a BFS
-    std::queue<CalcHarborPosNeighborsNode> todo_list;
+void HarborNeighborsCalculator::operator()(unsigned taskIdx)
+{
+    Scratch scratch;
+    // Harbor ids start at 1, so no point is visited
+    scratch.visitedBy.resize(ptIsSeaPt.size(), 0);
+    for(unsigned startHbId = taskIdx + 1; startHbId < harborPos.size(); startHbId += numTasks)
+        CalcNeighbors(startHbId, scratch);
+}
 
-    for(unsigned startHbId = 1; startHbId < world.harbor_pos.size(); ++startHbId)
-    {
-        RTTR_Assert(todo_list.empty());
+void HarborNeighborsCalculator::CalcNeighbors(unsigned startHbId, Scratch& scratch)
+{
+    std::vector<unsigned>& visitedBy = scratch.visitedBy;
+    std::queue<CalcHarborPosNeighborsNode>& todo_list = scratch.todo_list;
+    RTTR_Assert(todo_list.empty());
 
-        // Copy sea points to working flags. Possible values are
-        // 0 - visited or no sea point
-        // 1 - sea point, not already visited
-        // n - harbor_pos[n - 1]
-        std::vector<unsigned> ptToVisitOrHb(ptIsSeaPt);
+    // add another entry, so that we can use the harbor id + 1 directly.
+    scratch.hbFound.assign(harborPos.size() + 1, false);
+    std::vector<bool>& hbFound = scratch.hbFound;
 
-        // add another entry, so that we can use the value from 'ptToVisitOrHb' directly.
-        std::vector<bool> hbFound(world.harbor_pos.size() + 1, false);
+    // Add the sea points around the start harbor to our todo list.
+    BOOST_FOREACH(const MapPoint& coastPt, coastPts[startHbId])
+        todo_list.push(CalcHarborPosNeighborsNode(coastPt, 0));
 
-        // mark coastal points around harbors
-        for(unsigned otherHbId = 1; otherHbId < world.harbor_pos.size(); ++otherHbId)
-        {
-            std::vector<bool> seaIsMarked(world.GetNumSeas(), false);
-            for(unsigned d = 0; d < Direction::COUNT; d++)
-            {
-                // In every direction there can be a coastal point to a sea
-                // So find the sea first and then the dedicated coastal point
-                unsigned seaId = world.GetSeaId(otherHbId, Direction::fromInt(d));
-                // No sea? -> Next
-                if(!seaId)
-                    continue;
-                // Skip marked seas
-                if(seaIsMarked[seaId - 1])
-                    continue;
-                seaIsMarked[seaId - 1] = true;
-                // Get designated coastal point
-                const MapPoint coastPt = world.GetCoastalPoint(otherHbId, seaId);
-                // This should not be marked for visit
-                RTTR_Assert(ptToVisitOrHb[world.GetIdx(coastPt)] != 1);
-                if(otherHbId == startHbId)
-                {
-                    // This is our start harbor. Add the sea points around it to our todo list.
-                    todo_list.push(CalcHarborPosNeighborsNode(coastPt, 0));
-                } else
-                    ptToVisitOrHb[world.GetIdx(coastPt)] = otherHbId + 1;
-            }
-        }
+    while(!todo_list.empty()) // as long as there are sea points on our todo list...
+    {
+        CalcHarborPosNeighborsNode curNode = todo_list.front();
+        todo_list.pop();
 
-        while(!todo_list.empty()) // as long as there are sea points on our todo list...
+        for(unsigned dir = 0; dir < Direction::COUNT; ++dir)
         {
-            CalcHarborPosNeighborsNode curNode = todo_list.front();
-            todo_list.pop();
+            if(!shipPathChecker.IsEdgeOk(curNode.pos, Direction::fromInt(dir)))
+                continue;
+            MapPoint curPt = world.GetNeighbour(curNode.pos, dir);
+            unsigned idx = world.GetIdx(curPt);
+            if(visitedBy[idx] == startHbId)
+                continue;
 
-            for(unsigned dir = 0; dir < Direction::COUNT; ++dir)
-            {
-                if(!shipPathChecker.IsEdgeOk(curNode.pos, Direction::fromInt(dir)))
-                    continue;
-                MapPoint curPt = world.GetNeighbour(curNode.pos, dir);
-                unsigned idx = world.GetIdx(curPt);
+            // Possible values are
+            // 0 - no sea point
+            // 1 - sea point
+            // n - harbor_pos[n - 1] (except the start harbor)
+            unsigned ptValue = (coastPtHb[idx] == startHbId + 1) ? coastPtHb2[idx] : coastPtHb[idx];
+            if(!ptValue)
+                ptValue = ptIsSeaPt[idx] ? 1 : 0;
 
-                if((ptToVisitOrHb[idx] > 1) && !hbFound[ptToVisitOrHb[idx]]) // found harbor we haven't already found
-                {
-                    ShipDirection shipDir = world.GetShipDir(world.harbor_pos[startHbId].pos, curPt);
-                    world.harbor_pos[startHbId].neighbors[shipDir.toUInt()].push_back(
-                      HarborPos::Neighbor(ptToVisitOrHb[idx] - 1, curNode.distance + 1));
+            if((ptValue > 1) && !hbFound[ptValue]) // found harbor we haven't already found
+            {
+                ShipDirection shipDir = world.GetShipDir(harborPos[startHbId].pos, curPt);
+                harborPos[startHbId].neighbors[shipDir.toUInt()].push_back(HarborPos::Neighbor(ptValue - 1, curNode.distance + 1));
 
-                    todo_list.push(CalcHarborPosNeighborsNode(curPt, curNode.distance + 1));
+                todo_list.push(CalcHarborPosNeighborsNode(curPt, curNode.distance + 1));
 
-                    hbFound[ptToVisitOrHb[idx]] = true;
+                hbFound[ptValue] = true;
 
-                    ptToVisitOrHb[idx] = 0;   // mark as visited, so we do not go here again
-                } else if(ptToVisitOrHb[idx]) // this detects any sea point plus harbors we already visited
-                {
-                    todo_list.push(CalcHarborPosNeighborsNode(curPt, curNode.distance + 1));
+                visitedBy[idx] = startHbId; // mark as visited, so we do not go here again
+            } else if(ptValue)              // this detects any sea point plus harbors we already visited
+            {
+                todo_list.push(CalcHarborPosNeighborsNode(curPt, curNode.distance + 1));
 
-                    ptToVisitOrHb[idx] = 0; // mark as visited, so we do not go here again
-                }
+                visitedBy[idx] = startHbId; // mark as visited, so we do not go here again
             }
         }
     }
 }
+} // namespace
+
+/// Calculate the distance from each harbor to the others
+void MapLoader::CalcHarborPosNeighbors(World& world, unsigned maxThreads)
+{
+    for(std::vector<HarborPos>::iterator it = world.harbor_pos.begin(); it != world.harbor_pos.end(); ++it)
+    {
+        for(unsigned dir = 0; dir < it->neighbors.size(); dir++)
+            it->neighbors[dir].clear();
+    }
+    if(world.harbor_pos.size() <= 1)
+        return;
+
+    const unsigned numHarbors = static_cast<unsigned>(world.harbor_pos.size()) - 1;
+    const unsigned numTasks = std::min(maxThreads ? maxThreads : helpers::getNumWorkerThreads(), numHarbors);
+    HarborNeighborsCalculator calculator(world, world.harbor_pos, numTasks);
+    // Each harbor only writes its own neighbors, so the result does not depend on the number of threads
+    helpers::parallelFor(numTasks, calculator, numTasks);
+}
 
 /// Vermisst ein neues Weltmeer von einem Punkt aus, indem es alle mit diesem Punkt verbundenen
 /// Wasserpunkte mit der gleichen ID belegt und die Anzahl zur�ckgibt
@@ -41,7 +41,10 @@ class MapLoader
     /// Vermisst ein neues Weltmeer von einem Punkt aus, indem es alle mit diesem Punkt verbundenen
     /// Wasserpunkte mit der gleichen seaId belegt und die Anzahl zurückgibt
     static unsigned MeasureSea(World& world, const MapPoint pt, unsigned short seaId);
-    static void CalcHarborPosNeighbors(World& world);
+
+protected:
+    /// Calculate the neighbors of all harbors (replacing existing ones) using up to maxThreads threads (0 = all cores)
+    static void CalcHarborPosNeighbors(World& world, unsigned maxThreads = 0);
 
 public:
     /// Construct a loader for the given world.
@@ -18,8 +18,34 @@
 #include "defines.h" // IWYU pragma: keep
 #include "world/MilitarySquares.h"
 #include "buildings/nobBaseMilitary.h"
-#include "helpers/containerUtils.h"
 #include "gameData/MilitaryConsts.h"
+#include <algorithm>
+
+MilitarySquares::Entry::Entry(nobBaseMilitary* bld)
+    : bld(bld), pos(bld->GetPos()), type(bld->GetBuildingType()), player(bld->GetPlayer()),
+      radius(static_cast<unsigned short>(bld->GetMilitaryRadius()))
+{
+}
+
+namespace {
+struct IsEntryOf
+{
+    const nobBaseMilitary* bld;
+    IsEntryOf(const nobBaseMilitary* bld) : bld(bld) {}
+    bool operator()(const MilitarySquares::Entry& entry) const { return entry.bld == bld; }
+};
+
+struct AddToSortedBlds
+{
+    sortedMilitaryBlds& buildings;
+    AddToSortedBlds(sortedMilitaryBlds& buildings) : buildings(buildings) {}
+    bool operator()(const MilitarySquares::Entry& entry)
+    {
+        buildings.insert(entry.bld);
+        return false;
+    }
+};
+} // namespace
 
 MilitarySquares::MilitarySquares() : size_(MapExtent::all(0))
 {
@@ -40,7 +66,7 @@ void MilitarySquares::Clear()
     size_ = MapExtent::all(0);
 }
 
-std::list<nobBaseMilitary*>& MilitarySquares::GetSquare(const MapPoint pt)
+std::vector<MilitarySquares::Entry>& MilitarySquares::GetSquare(const MapPoint pt)
 {
     MapPoint milPt = pt / MILITARY_SQUARE_SIZE;
     return squares[milPt.y * size_.x + milPt.x];
@@ -48,16 +74,30 @@ std::list<nobBaseMilitary*>& MilitarySquares::GetSquare(const MapPoint pt)
 
 void MilitarySquares::Add(nobBaseMilitary* const bld)
 {
-    GetSquare(bld->GetPos()).push_back(bld);
+    std::vector<Entry>& square = GetSquare(bld->GetPos());
+    RTTR_Assert(std::find_if(square.begin(), square.end(), IsEntryOf(bld)) == square.end());
+    square.push_back(Entry(bld));
 }
 
 void MilitarySquares::Remove(nobBaseMilitary* const bld)
 {
-    RTTR_Assert(helpers::contains(GetSquare(bld->GetPos()), bld));
-    GetSquare(bld->GetPos()).remove(bld);
+    std::vector<Entry>& square = GetSquare(bld->GetPos());
+    std::vector<Entry>::iterator it = std::find_if(square.begin(), square.end(), IsEntryOf(bld));
+    RTTR_Assert(it != square.end());
+    if(it != square.end())
+        square.erase(it);
 }
 
-sortedMilitaryBlds MilitarySquares::GetBuildingsInRange(const MapPoint pt, unsigned short radius) const
+void MilitarySquares::UpdateOwner(nobBaseMilitary* const bld)
+{
+    std::vector<Entry>& square = GetSquare(bld->GetPos());
+    std::vector<Entry>::iterator it = std::find_if(square.begin(), square.end(), IsEntryOf(bld));
+    RTTR_Assert(it != square.end());
+    if(it != square.end())
+        it->player = bld->GetPlayer();
+}
+
+void MilitarySquares::GetSquareRange(const MapPoint pt, unsigned short radius, Point<int>& firstPt, Point<int>& lastPt) const
 {
     // maximum radius is half the size (rounded up) to avoid overlapping
     const Point<int> offsets = elMin((size_ + Point<int>::all(1)) / 2, Point<int>::all(radius));
@@ -65,35 +105,26 @@ sortedMilitaryBlds MilitarySquares::GetBuildingsInRange(const MapPoint pt, unsig
     // Convert to military coords
     const Point<int> milPos(pt / MILITARY_SQUARE_SIZE);
 
-    const Point<int> firstPt = milPos - offsets;
-    const Point<int> lastPt = milPos + offsets;
-
-    // List with unique(!) military buildings
-    sortedMilitaryBlds buildings;
-
-    // Create list
-    for(int cy = firstPt.y; cy <= lastPt.y; ++cy)
+    firstPt = milPos - offsets;
+    lastPt = milPos + offsets;
+    // With an odd size the range might still cover a square twice -> Use the whole row/column
+    if(lastPt.x - firstPt.x >= static_cast<int>(size_.x))
+    {
+        firstPt.x = 0;
+        lastPt.x = size_.x - 1;
+    }
+    if(lastPt.y - firstPt.y >= static_cast<int>(size_.y))
     {
-        // Handle wrap-around
-        int realY = cy;
-        if(realY < 0)
-            realY += size_.y;
-        else if(realY >= static_cast<int>(size_.y))
-            realY -= size_.y;
-        RTTR_Assert(realY >= 0 && realY < static_cast<int>(size_.y));
-        for(int cx = firstPt.x; cx <= lastPt.x; ++cx)
-        {
-            int realX = cx;
-            if(realX < 0)
-                realX += size_.x;
-            else if(realX >= static_cast<int>(size_.x))
-                realX -= size_.x;
-            RTTR_Assert(realX >= 0 && realX < static_cast<int>(size_.x));
-            const std::list<nobBaseMilitary*>& milBuildings = squares[realY * size_.x + realX];
-            for(std::list<nobBaseMilitary*>::const_iterator it = milBuildings.begin(); it != milBuildings.end(); ++it)
-                buildings.insert(*it);
-        }
+        firstPt.y = 0;
+        lastPt.y = size_.y - 1;
     }
+}
 
+sortedMilitaryBlds MilitarySquares::GetBuildingsInRange(const MapPoint pt, unsigned short radius) const
+{
+    // List with unique(!) military buildings
+    sortedMilitaryBlds buildings;
+    AddToSortedBlds addToBuildings(buildings);
+    VisitBuildingsInRange(pt, radius, addToBuildings);
     return buildings;
 }
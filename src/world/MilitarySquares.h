@@ -18,20 +18,39 @@
 #ifndef MilitarySquares_h__
 #define MilitarySquares_h__
 
+#include "gameTypes/BuildingTypes.h"
 #include "gameTypes/MapCoordinates.h"
-#include <list>
 #include <vector>
 
 class nobBaseMilitary;
 class sortedMilitaryBlds;
 
+/// Spatial index of the military buildings (including HQs and harbors) in a grid of military squares.
+/// Each square stores the data most queries filter by, so the buildings themselves only need to be accessed for matching entries
 class MilitarySquares
 {
-    /// military buildings (including HQs and harbors) per military square
-    std::vector<std::list<nobBaseMilitary*> > squares;
+public:
+    struct Entry
+    {
+        nobBaseMilitary* bld;
+        MapPoint pos;
+        BuildingType type;
+        unsigned char player;
+        unsigned short radius;
+
+        explicit Entry(nobBaseMilitary* bld);
+        /// Real military building (no HQ, harbor...)
+        bool IsMilitary() const { return type >= BLD_BARRACKS && type <= BLD_FORTRESS; }
+    };
+
+private:
+    std::vector<std::vector<Entry> > squares;
     MapExtent size_;
     // Liefert das entsprechende Militärquadrat für einen bestimmten Punkt auf der Karte zurück (normale Koordinaten)
-    std::list<nobBaseMilitary*>& GetSquare(const MapPoint pt);
+    std::vector<Entry>& GetSquare(const MapPoint pt);
+    /// Get the first and last (inclusive, may be outside the map for wrap-around) square covered by the radius.
+    /// Each square is covered at most once
+    void GetSquareRange(const MapPoint pt, unsigned short radius, Point<int>& firstPt, Point<int>& lastPt) const;
 
 public:
     MilitarySquares();
@@ -39,7 +58,36 @@ public:
     void Clear();
     void Add(nobBaseMilitary* const bld);
     void Remove(nobBaseMilitary* const bld);
+    /// Has to be called when the owner of the building changed
+    void UpdateOwner(nobBaseMilitary* const bld);
     sortedMilitaryBlds GetBuildingsInRange(const MapPoint pt, unsigned short radius) const;
+    /// Call visitor(const Entry&) for each building in the squares around pt (radius in military squares) till it returns true.
+    /// The order is unspecified, so use GetBuildingsInRange if the order matters. Return true if the visitor returned true
+    template<class T_Visitor>
+    bool VisitBuildingsInRange(const MapPoint pt, unsigned short radius, T_Visitor& visitor) const;
 };
 
+template<class T_Visitor>
+bool MilitarySquares::VisitBuildingsInRange(const MapPoint pt, unsigned short radius, T_Visitor& visitor) const
+{
+    Point<int> firstPt, lastPt;
+    GetSquareRange(pt, radius, firstPt, lastPt);
+    for(int cy = firstPt.y; cy <= lastPt.y; ++cy)
+    {
+        // Handle wrap-around
+        const int realY = (cy + size_.y) % size_.y;
+        for(int cx = firstPt.x; cx <= lastPt.x; ++cx)
+        {
+            const int realX = (cx + size_.x) % size_.x;
+            const std::vector<Entry>& square = squares[realY * size_.x + realX];
+            for(std::vector<Entry>::const_iterator it = square.begin(); it != square.end(); ++it)
+            {
+                if(visitor(*it))
+                    return true;
+            }
+        }
+    }
+    return false;
+}
+
 #endif // MilitarySquares_h__
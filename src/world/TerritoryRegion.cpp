@@ -23,6 +23,8 @@
 #include "buildings/nobMilitary.h"
 #include "world/GameWorldBase.h"
 #include "gameData/MilitaryConsts.h"
+#include <algorithm>
+#include <cstdlib>
 
 TerritoryRegion::TerritoryRegion(const PointI& startPt, const PointI& endPt, const GameWorldBase& gwb)
     : startPt(startPt), endPt(endPt), size(endPt - startPt), world(gwb)
@@ -126,8 +128,97 @@ struct GetMapPointWithRadius
 
     result_type operator()(const MapPoint pt, unsigned r) { return std::make_pair(pt, r); }
 };
+
+/// All points with a distance <= radius around a center point stored as one span per row.
+/// As the rows are shifted alternately, the offsets depend on whether the center is in an odd or even row
+struct RadiusStencil
+{
+    struct Row
+    {
+        /// Y offset of the row and x offset of its first point relative to the center
+        int dy, firstDx;
+        /// Distance to the center for all points of the row
+        std::vector<unsigned char> radii;
+    };
+    std::vector<Row> rows;
+
+    RadiusStencil(const unsigned radius, const bool isCenterRowOdd);
+};
+
+RadiusStencil::RadiusStencil(const unsigned radius, const bool isCenterRowOdd)
+{
+    const int r = static_cast<int>(radius);
+    const int centerRowParity = isCenterRowOdd ? 1 : 0;
+    rows.reserve(2 * r + 1);
+    for(int dy = -r; dy <= r; ++dy)
+    {
+        const int rowParity = centerRowParity ^ (dy & 1);
+        Row row;
+        row.dy = dy;
+        row.firstDx = 0;
+        // Same distance formula as World::CalcDistance (without wrapping)
+        for(int dx = -r - 1; dx <= r + 1; ++dx)
+        {
+            const int dx2 = std::abs(2 * dx + rowParity - centerRowParity) - std::abs(dy);
+            const int distance = (2 * std::abs(dy) + std::max(dx2, 0)) / 2;
+            if(distance > r)
+                continue;
+            if(row.radii.empty())
+                row.firstDx = dx;
+            row.radii.push_back(static_cast<unsigned char>(distance));
+        }
+        rows.push_back(row);
+    }
+}
+
+/// Return the (cached) stencil for the given radius
+const RadiusStencil& GetRadiusStencil(const unsigned radius, const bool isCenterRowOdd)
+{
+    // Military radii come from a small fixed set, so the cache stays small
+    static std::vector<RadiusStencil> stencils[2];
+    std::vector<RadiusStencil>& curStencils = stencils[isCenterRowOdd ? 1 : 0];
+    while(curStencils.size() <= radius)
+        curStencils.push_back(RadiusStencil(curStencils.size(), isCenterRowOdd));
+    return curStencils[radius];
+}
 } // namespace
 
+void TerritoryRegion::AdjustNodesInRadius(const MapPoint center, const unsigned char player, const unsigned radius)
+{
+    const RadiusStencil& stencil = GetRadiusStencil(radius, (center.y & 1) != 0);
+    const int width = world.GetWidth();
+    const int height = world.GetHeight();
+    const unsigned char owner = player + 1;
+
+    for(std::vector<RadiusStencil::Row>::const_iterator row = stencil.rows.begin(); row != stencil.rows.end(); ++row)
+    {
+        // The region is at most as big as the map, so each map row/column is found at most once with one of the wrap-around offsets
+        for(int yOffset = -height; yOffset <= height; yOffset += height)
+        {
+            const int y = center.y + row->dy + yOffset;
+            if(y < startPt.y || y >= endPt.y)
+                continue;
+            for(int xOffset = -width; xOffset <= width; xOffset += width)
+            {
+                const int rowStartX = center.x + row->firstDx + xOffset;
+                const int firstX = std::max(rowStartX, startPt.x);
+                const int endX = std::min<int>(rowStartX + row->radii.size(), endPt.x);
+                if(firstX >= endX)
+                    continue;
+                TRNode* curNode = &nodes[GetIdx(PointI(firstX, y))];
+                const unsigned char* curRadius = &row->radii[firstX - rowStartX];
+                // Same rule as in AdjustNode: Closer military buildings (or unowned points) are taken
+                for(int x = firstX; x < endX; ++x, ++curNode, ++curRadius)
+                {
+                    const bool takeNode = *curRadius < curNode->radius || !curNode->owner;
+                    curNode->owner = takeNode ? owner : curNode->owner;
+                    curNode->radius = takeNode ? *curRadius : curNode->radius;
+                }
+            }
+        }
+    }
+}
+
 void TerritoryRegion::CalcTerritoryOfBuilding(const noBaseBuilding& building)
 {
     bool check_barriers = true;
@@ -146,6 +237,14 @@ void TerritoryRegion::CalcTerritoryOfBuilding(const noBaseBuilding& building)
 
     // Punkt, auf dem das Militärgebäude steht
     MapPoint pt = building.GetPos();
+
+    // Without barriers every point in the radius is affected, so we can handle them row by row
+    if(!check_barriers || world.GetPlayer(building.GetPlayer()).GetRestrictedArea().empty())
+    {
+        AdjustNodesInRadius(pt, building.GetPlayer(), radius);
+        return;
+    }
+
     AdjustNode(pt, building.GetPlayer(), 0, false); // no need to check barriers here. this point is on our territory.
 
     std::vector<GetMapPointWithRadius::result_type> pts = world.GetPointsInRadius(pt, radius, GetMapPointWithRadius());
@@ -57,6 +57,8 @@ private:
     static bool IsPointInPolygon(const std::vector<Point<int> >& polygon, const Point<int> pt);
     /// Testet einen Punkt, ob der neue Spieler ihn übernehmen kann und übernimmt ihn ggf.
     void AdjustNode(MapPoint pt, const unsigned char player, const unsigned char radius, const bool check_barriers);
+    /// Does the same as calling AdjustNode (without barriers) for all points in the radius around center, but row by row
+    void AdjustNodesInRadius(const MapPoint center, const unsigned char player, const unsigned radius);
     TRNode& GetNode(const PointI& pt) { return nodes[GetIdx(pt)]; }
     const TRNode& GetNode(const PointI& pt) const { return nodes[GetIdx(pt)]; }
 
@@ -29,6 +29,7 @@
 #include "helpers/containerUtils.h"
 #include "gameTypes/ShipDirection.h"
 #include "gameData/TerrainData.h"
+#include <algorithm>
 #include <set>
 
 World::World() : size_(MapExtent::all(0)), lt(LT_GREENLAND), noNodeObj(NULL)
@@ -289,6 +290,7 @@ void World::SetNO(const MapPoint pt, noBase* obj, const bool replace /* = false*
     RTTR_Assert(!dynamic_cast<noMovable*>(obj)); // It should be a static, non-movable object
 #endif
     GetNodeInt(pt).obj = obj;
+    ObjectChanged(pt);
 }
 
 void World::DestroyNO(const MapPoint pt, const bool checkExists /* = true*/)
@@ -301,6 +303,7 @@ void World::DestroyNO(const MapPoint pt, const bool checkExists /* = true*/)
         GetNodeInt(pt).obj = NULL;
         obj->Destroy();
         deletePtr(obj);
+        ObjectChanged(pt);
     } else
         RTTR_Assert(!checkExists);
 }
@@ -319,6 +322,13 @@ void World::ReduceResource(const MapPoint pt)
 {
     RTTR_Assert(GetNodeInt(pt).resources > 0);
     GetNodeInt(pt).resources--;
+    ResourceChanged(pt);
+}
+
+void World::SetResource(const MapPoint pt, const unsigned char newResource)
+{
+    GetNodeInt(pt).resources = newResource;
+    ResourceChanged(pt);
 }
 
 void World::SetReserved(const MapPoint pt, const bool reserved)
@@ -368,6 +378,32 @@ bool World::IsPlayerTerritory(const MapPoint pt) const
     return true;
 }
 
+bool World::HasBorderStone(const MapPoint pt) const
+{
+    return GetNode(pt).owner != 0 && !IsPlayerTerritory(pt);
+}
+
+BoundaryStones World::CalcBoundaryStones(const MapPoint pt) const
+{
+    BoundaryStones stones;
+    std::fill(stones.begin(), stones.end(), 0);
+
+    const unsigned char owner = GetNode(pt).owner;
+    // Only border nodes get stones
+    if(!owner || IsPlayerTerritory(pt))
+        return stones;
+    stones[0] = owner;
+
+    // Place the half-way stones to neighbors (E, SE, SW) that are border nodes of the same owner too
+    for(unsigned i = 0; i < 3; ++i)
+    {
+        const MapPoint nb = GetNeighbour(pt, 3 + i);
+        if(GetNode(nb).owner == owner && !IsPlayerTerritory(nb))
+            stones[i + 1] = owner;
+    }
+    return stones;
+}
+
 BuildingQuality World::GetBQ(const MapPoint pt, const unsigned char player) const
 {
     return AdjustBQ(pt, player, GetNode(pt).bq);
@@ -427,8 +463,8 @@ void World::SaveFOWNode(const MapPoint pt, const unsigned player, unsigned curTi
 
     // Store ownership so FoW boundary stones can be drawn
     fow.owner = GetNode(pt).owner;
-    // Grenzsteine merken
-    fow.boundary_stones = GetNode(pt).boundary_stones;
+    // Grenzsteine merken (calculated as the stored ones might not be updated yet during a territory batch)
+    fow.boundary_stones = CalcBoundaryStones(pt);
 }
 
 bool World::IsSeaPoint(const MapPoint pt) const
@@ -168,7 +168,7 @@ public:
     /// Return the game object type of the object at that point or GOT_NONE of there is none
     GO_Type GetGOT(const MapPoint pt) const;
     void ReduceResource(const MapPoint pt);
-    void SetResource(const MapPoint pt, const unsigned char newResource) { GetNodeInt(pt).resources = newResource; }
+    void SetResource(const MapPoint pt, const unsigned char newResource);
     void SetOwner(const MapPoint pt, const unsigned char newOwner) { GetNodeInt(pt).owner = newOwner; }
     void SetReserved(const MapPoint pt, const bool reserved);
     void SetVisibility(const MapPoint pt, const unsigned char player, const Visibility vis, const unsigned curTime);
@@ -177,6 +177,11 @@ public:
 
     /// Check if the point completely belongs to a player (if false but point itself belongs to player then it is a border)
     bool IsPlayerTerritory(const MapPoint pt) const;
+    /// Return whether there is a border stone on that point according to the current ownership
+    /// (same as boundary_stones[0] != 0 but also valid while border stone updates are pending)
+    bool HasBorderStone(const MapPoint pt) const;
+    /// Calculate the boundary stones of a point from the current ownership of the point and its surroundings
+    BoundaryStones CalcBoundaryStones(const MapPoint pt) const;
     /// Return the BQ for the given player at the point (including ownership constraints)
     BuildingQuality GetBQ(const MapPoint pt, const unsigned char player) const;
     /// Incorporates node ownership into the given BQ
@@ -243,6 +248,10 @@ protected:
     virtual void AltitudeChanged(const MapPoint pt) = 0;
     /// Notify derived classes of changed visibility
     virtual void VisibilityChanged(const MapPoint pt, unsigned player) = 0;
+    /// Notify derived classes of changed resources
+    virtual void ResourceChanged(const MapPoint pt) = 0;
+    /// Notify derived classes of a changed object
+    virtual void ObjectChanged(const MapPoint pt) = 0;
     /// Sets the road for the given (road) direction
     void SetRoad(const MapPoint pt, unsigned char roadDir, unsigned char type);
     BoundaryStones& GetBoundaryStones(const MapPoint pt) { return GetNodeInt(pt).boundary_stones; }
@@ -212,3 +212,13 @@ end
 function onOccupied(pIdx, x, y)
 	assert(pIdx >= 0 and pIdx < rttr:GetPlayerCount())
 end
+
+function onExploredBatch(pIdx, points)
+	assert(pIdx >= 0 and pIdx < rttr:GetPlayerCount())
+	assert(#points > 0)
+end
+
+function onOccupiedBatch(pIdx, points)
+	assert(pIdx >= 0 and pIdx < rttr:GetPlayerCount())
+	assert(#points > 0)
+end